@@ -0,0 +1,80 @@
+/* 
+small helpers shared by the benchmark executables 
+- percentile / median of a list of samples
+- parsing comma separated lists from the command line
+- a tiny CSV reader (just enough to read back our own output files)
+- timing uses steady_now_ms() from the core (timing.hpp), same as the batch runner
+*/
+
+
+#pragma once
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "timing.hpp"
+
+
+// p in [0, 100], nearest-rank percentile (samples are copied so the caller's order is kept)
+inline double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>((p / 100.0) * (samples.size() - 1) + 0.5);
+    return samples[std::min(rank, samples.size() - 1)];
+}
+
+inline double median(const std::vector<double>& samples) {
+    return percentile(samples, 50.0);
+}
+
+inline double mean(const std::vector<double>& samples) {
+    if (samples.empty()) return 0.0;
+    double total = 0.0;
+    for (double s : samples) total += s;
+    return total / samples.size();
+}
+
+// "1,2,4" -> {"1", "2", "4"}
+inline std::vector<std::string> split(const std::string& text, char delimiter = ',') {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, delimiter)) {
+        if (!part.empty() && part.back() == '\r') part.pop_back();
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+inline std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    for (const std::string& part : split(text)) {
+        if (!part.empty()) values.push_back(std::stoi(part));
+    }
+    return values;
+}
+
+// reads a CSV file with a header row. each row is returned as a list of cells, the header is written to header
+inline bool read_csv(const std::string& path, std::vector<std::string>& header, std::vector<std::vector<std::string>>& rows) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    if (!std::getline(file, line)) return false;
+    header = split(line);
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        rows.push_back(split(line));
+    }
+    return true;
+}
+
+// index of a column in a CSV header (or -1 if the column does not exist)
+inline int column_index(const std::vector<std::string>& header, const std::string& name) {
+    for (size_t i = 0; i < header.size(); i++) {
+        if (header[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
@@ -0,0 +1,323 @@
+/*
+NeighborSearch microbenchmark
+- times NeighborSearch::build() and one full pass of get_neighbors() (every boid queried once)
+  on its own, without any steering or rendering cost
+- inputs are synthetic boid distributions:
+    uniform   - evenly spread over the world
+    clusters  - a handful of gaussian clusters
+    ball      - a single dense ball in the middle of the world
+    edges     - a thin band along the world edges (the worst case for screen-wrap)
+- reports ns/query, candidates/query, neighbors/query and an estimate of the bytes touched per query
+- new NeighborSearch implementations only need to be added to make_searches()
+- --crossover: instead of the table above, times build + one query pass for the tiled all-pairs search
+  and the grid over a sweep of small boid counts (same density as the default config) and reports
+  the largest N at which all-pairs is still faster
+
+usage:
+    BoidsNeighborBench [--boids 1000,10000,100000] [--dist uniform,clusters,ball,edges]
+                       [--search naiive,naiive_stream,grid,topological] [--radius 40] [--cell-sizes 30,60,120]
+                       [--repeats 5] [--naiive-max-boids 20000] [--out neighbor_search.csv]
+    BoidsNeighborBench --crossover [--dist uniform] [--radius 40] [--repeats 5] [--out crossover.csv]
+*/
+
+
+#include "bench_utils.hpp"
+#include "simulation_config.hpp"
+#include "simulation_params.hpp"
+#include "naiive_neighbor_search.hpp"
+#include "grid_neighbor_search.hpp"
+#include "topological_neighbor_search.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+struct SearchFactory {
+    std::string name;
+    std::function<std::unique_ptr<NeighborSearch>()> create;
+    // rough per-candidate memory cost, used for the "bytes touched" estimate
+    // (naiive streams boids, grid also reads the boid index out of the cell list)
+    size_t bytes_per_candidate;
+    bool uses_cell_size;
+};
+
+static std::vector<SearchFactory> make_searches() {
+    return {
+        {"naiive", [] { return std::unique_ptr<NeighborSearch>(new NaiiveNeighborSearch()); }, 2 * sizeof(float), false},
+        {"naiive_stream", [] { return std::unique_ptr<NeighborSearch>(new NaiiveNeighborSearch(false)); }, sizeof(Boid), false},
+        {"grid",   [] { return std::unique_ptr<NeighborSearch>(new GridNeighborSearch()); },   sizeof(Boid) + sizeof(int), true},
+        {"topological", [] { return std::unique_ptr<NeighborSearch>(new TopologicalNeighborSearch()); }, sizeof(Boid) + sizeof(int), true},
+    };
+}
+
+
+struct MicroOptions {
+    std::vector<int> boid_counts = {1000, 10000, 100000};
+    std::vector<std::string> distributions = {"uniform", "clusters", "ball", "edges"};
+    std::vector<std::string> searches = {"naiive", "grid", "topological"};
+    std::vector<int> cell_sizes = {60};
+    float perception_radius = 40.0f;
+    int repeats = 5;
+    int naiive_max_boids = 20000;
+    std::string out_path = "neighbor_search.csv";
+    bool crossover = false;
+};
+
+
+// ================= SYNTHETIC DISTRIBUTIONS =================
+// the world is sized so that the *average* density matches the default config (1000 boids in 800x600),
+// the distributions then decide how that population is spread out
+static void generate_boids(std::vector<Boid>& boids, const std::string& distribution, int count,
+                           float width, float height, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> velocity(-0.5f, 0.5f);
+
+    // keep every position inside [0, width) x [0, height) like the simulation does
+    auto wrap = [](float value, float limit) {
+        value = std::fmod(value, limit);
+        return (value < 0.0f) ? value + limit : value;
+    };
+
+    boids.clear();
+    boids.reserve(count);
+
+    if (distribution == "clusters") {
+        const int num_clusters = 8;
+        std::vector<float> centers_x, centers_y;
+        for (int c = 0; c < num_clusters; c++) {
+            centers_x.push_back(unit(rng) * width);
+            centers_y.push_back(unit(rng) * height);
+        }
+        std::normal_distribution<float> spread(0.0f, std::min(width, height) * 0.04f);
+        for (int i = 0; i < count; i++) {
+            int c = i % num_clusters;
+            boids.push_back({wrap(centers_x[c] + spread(rng), width), wrap(centers_y[c] + spread(rng), height),
+                             velocity(rng), velocity(rng)});
+        }
+    }
+    else if (distribution == "ball") {
+        // everything inside one disk with 10% of the world's smaller side as radius
+        float radius = std::min(width, height) * 0.10f;
+        for (int i = 0; i < count; i++) {
+            float r = radius * std::sqrt(unit(rng));
+            float angle = unit(rng) * 6.2831853f;
+            boids.push_back({width * 0.5f + r * std::cos(angle), height * 0.5f + r * std::sin(angle),
+                             velocity(rng), velocity(rng)});
+        }
+    }
+    else if (distribution == "edges") {
+        // band of 5% of the world size along all four edges
+        float band = std::min(width, height) * 0.05f;
+        for (int i = 0; i < count; i++) {
+            float x, y;
+            switch (i % 4) {
+                case 0:  x = unit(rng) * width; y = unit(rng) * band; break;                      // top
+                case 1:  x = unit(rng) * width; y = height - band + unit(rng) * band; break;      // bottom
+                case 2:  x = unit(rng) * band;  y = unit(rng) * height; break;                    // left
+                default: x = width - band + unit(rng) * band; y = unit(rng) * height; break;      // right
+            }
+            boids.push_back({wrap(x, width), wrap(y, height), velocity(rng), velocity(rng)});
+        }
+    }
+    else {
+        // uniform
+        for (int i = 0; i < count; i++) {
+            boids.push_back({unit(rng) * width, unit(rng) * height, velocity(rng), velocity(rng)});
+        }
+    }
+}
+
+
+static bool parse_args(int argc, char** argv, MicroOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--boids" && has_value)                 options.boid_counts = parse_int_list(argv[++i]);
+        else if (arg == "--dist" && has_value)             options.distributions = split(argv[++i]);
+        else if (arg == "--search" && has_value)           options.searches = split(argv[++i]);
+        else if (arg == "--cell-sizes" && has_value)       options.cell_sizes = parse_int_list(argv[++i]);
+        else if (arg == "--radius" && has_value)           options.perception_radius = std::stof(argv[++i]);
+        else if (arg == "--repeats" && has_value)          options.repeats = std::stoi(argv[++i]);
+        else if (arg == "--naiive-max-boids" && has_value) options.naiive_max_boids = std::stoi(argv[++i]);
+        else if (arg == "--out" && has_value)              options.out_path = argv[++i];
+        else if (arg == "--crossover")                     options.crossover = true;
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// median time (ms) of one build() plus one query for every boid
+static double time_full_pass(NeighborSearch& search, const std::vector<Boid>& boids, const SimulationParams& params, int repeats) {
+    std::vector<double> times;
+    long long sink = 0;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        double start = steady_now_ms();
+        search.build(boids, params);
+        for (int i = 0; i < static_cast<int>(boids.size()); i++) {
+            sink += std::get<0>(search.get_neighbors(boids, i, params)).size();
+        }
+        times.push_back(steady_now_ms() - start);
+    }
+    if (sink < 0) std::printf(" ");  // keeps the queries from being optimized away
+    return median(times);
+}
+
+
+// ================= ALL-PAIRS VS GRID CROSSOVER =================
+static int run_crossover(const MicroOptions& options) {
+    FILE* csv = std::fopen(options.out_path.c_str(), "w");
+    if (!csv) {
+        std::cerr << "could not open " << options.out_path << " for writing\n";
+        return 1;
+    }
+    std::fprintf(csv, "distribution,boids,radius,naiive_ms,grid_ms,naiive_over_grid\n");
+
+    SimulationConfig defaults;
+    const float default_density = defaults.NUM_BOIDS / static_cast<float>(defaults.WINDOW_WIDTH * defaults.WINDOW_HEIGHT);
+    // geometric sweep, dense enough to place the crossover within ~20%
+    std::vector<int> boid_counts;
+    for (float count = 32.0f; count <= 16384.0f; count *= 1.2f) boid_counts.push_back(static_cast<int>(count));
+
+    for (const std::string& distribution : options.distributions) {
+        int crossover = 0;
+        int repeats = std::max(3, options.repeats);
+        for (int boids_count : boid_counts) {
+            float area_scale = std::sqrt(boids_count / (default_density * defaults.WINDOW_WIDTH * defaults.WINDOW_HEIGHT));
+            SimulationConfig config = defaults;
+            config.PERCEPTION_RADIUS = options.perception_radius;
+            config.WINDOW_WIDTH = std::max(1, static_cast<int>(std::ceil(defaults.WINDOW_WIDTH * area_scale)));
+            config.WINDOW_HEIGHT = std::max(1, static_cast<int>(std::ceil(defaults.WINDOW_HEIGHT * area_scale)));
+            const SimulationParams params = SimulationParams::from_config(config);
+
+            std::vector<Boid> boids;
+            generate_boids(boids, distribution, boids_count, static_cast<float>(config.WINDOW_WIDTH), static_cast<float>(config.WINDOW_HEIGHT), 4242u);
+
+            NaiiveNeighborSearch naiive;
+            GridNeighborSearch grid;
+            // tiny inputs finish in microseconds, repeat them more so the medians are stable
+            int scaled_repeats = repeats * std::max(1, 2048 / boids_count);
+            double naiive_ms = time_full_pass(naiive, boids, params, scaled_repeats);
+            double grid_ms = time_full_pass(grid, boids, params, scaled_repeats);
+            if (naiive_ms <= grid_ms) crossover = boids_count;
+
+            std::printf("%-9s boids=%-6d naiive=%9.4f ms  grid=%9.4f ms  ratio=%5.2f\n",
+                        distribution.c_str(), boids_count, naiive_ms, grid_ms, naiive_ms / grid_ms);
+            std::fflush(stdout);
+            std::fprintf(csv, "%s,%d,%.1f,%.5f,%.5f,%.3f\n", distribution.c_str(), boids_count, options.perception_radius,
+                         naiive_ms, grid_ms, naiive_ms / grid_ms);
+            // all-pairs only gets worse from here on
+            if (naiive_ms > 4.0 * grid_ms) break;
+        }
+        std::printf("%s: tiled all-pairs beats the grid up to N = %d (radius %.0f)\n", distribution.c_str(), crossover, options.perception_radius);
+    }
+
+    std::fclose(csv);
+    std::printf("wrote results to %s\n", options.out_path.c_str());
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    MicroOptions options;
+    if (!parse_args(argc, argv, options)) {
+        return 1;
+    }
+    if (options.crossover) {
+        if (options.out_path == "neighbor_search.csv") options.out_path = "crossover.csv";
+        return run_crossover(options);
+    }
+
+    FILE* csv = std::fopen(options.out_path.c_str(), "w");
+    if (!csv) {
+        std::cerr << "could not open " << options.out_path << " for writing\n";
+        return 1;
+    }
+    std::fprintf(csv, "search,distribution,boids,cell_size,radius,median_build_ms,median_query_pass_ms,"
+                      "ns_per_query,candidates_per_query,neighbors_per_query,bytes_per_query\n");
+
+    std::vector<SearchFactory> factories = make_searches();
+    SimulationConfig defaults;
+    const float default_density = defaults.NUM_BOIDS / static_cast<float>(defaults.WINDOW_WIDTH * defaults.WINDOW_HEIGHT);
+
+    for (const std::string& distribution : options.distributions) {
+        for (int boids_count : options.boid_counts) {
+            // world sized so the average density is the same as the default config
+            float area_scale = std::sqrt(boids_count / (default_density * defaults.WINDOW_WIDTH * defaults.WINDOW_HEIGHT));
+            float width = defaults.WINDOW_WIDTH * area_scale;
+            float height = defaults.WINDOW_HEIGHT * area_scale;
+
+            std::vector<Boid> boids;
+            generate_boids(boids, distribution, boids_count, width, height, 4242u);
+
+            for (const SearchFactory& factory : factories) {
+                bool selected = false;
+                for (const std::string& name : options.searches) selected |= (name == factory.name);
+                if (!selected) continue;
+                if (factory.name.compare(0, 6, "naiive") == 0 && boids_count > options.naiive_max_boids) continue;
+
+                // searches that don't use a grid only need to run once
+                std::vector<int> cell_sizes = factory.uses_cell_size ? options.cell_sizes : std::vector<int>{0};
+                for (int cell_size : cell_sizes) {
+                    SimulationConfig config = defaults;
+                    config.PERCEPTION_RADIUS = options.perception_radius;
+                    config.GRID_CELL_SIZE = (cell_size > 0) ? static_cast<float>(cell_size) : defaults.GRID_CELL_SIZE;
+                    config.WINDOW_WIDTH = static_cast<int>(std::ceil(width));
+                    config.WINDOW_HEIGHT = static_cast<int>(std::ceil(height));
+                    const SimulationParams params = SimulationParams::from_config(config);
+
+                    std::unique_ptr<NeighborSearch> search = factory.create();
+                    std::vector<double> build_ms, query_ms;
+                    long long candidates = 0;
+                    long long neighbors = 0;
+
+                    for (int repeat = 0; repeat < options.repeats; repeat++) {
+                        double build_start = steady_now_ms();
+                        search->build(boids, params);
+                        build_ms.push_back(steady_now_ms() - build_start);
+
+                        candidates = 0;
+                        neighbors = 0;
+                        double query_start = steady_now_ms();
+                        for (int i = 0; i < boids_count; i++) {
+                            std::tuple<std::vector<int>, long long> answers = search->get_neighbors(boids, i, params);
+                            neighbors += std::get<0>(answers).size();
+                            candidates += std::get<1>(answers);
+                        }
+                        query_ms.push_back(steady_now_ms() - query_start);
+                    }
+
+                    double median_query_ms = median(query_ms);
+                    double ns_per_query = median_query_ms * 1.0e6 / boids_count;
+                    double candidates_per_query = static_cast<double>(candidates) / boids_count;
+                    double neighbors_per_query = static_cast<double>(neighbors) / boids_count;
+                    // estimate: every candidate is read once, every neighbor index is written once
+                    double bytes_per_query = candidates_per_query * factory.bytes_per_candidate + neighbors_per_query * sizeof(int);
+
+                    std::printf("%-11s %-9s boids=%-8d cell=%-4d build=%9.3f ms  query=%7.1f ns  cand=%9.1f  neigh=%7.1f  bytes=%10.0f\n",
+                                factory.name.c_str(), distribution.c_str(), boids_count, cell_size,
+                                median(build_ms), ns_per_query, candidates_per_query, neighbors_per_query, bytes_per_query);
+                    std::fflush(stdout);
+                    std::fprintf(csv, "%s,%s,%d,%d,%.1f,%.4f,%.4f,%.2f,%.2f,%.2f,%.0f\n",
+                                 factory.name.c_str(), distribution.c_str(), boids_count, cell_size, options.perception_radius,
+                                 median(build_ms), median_query_ms, ns_per_query, candidates_per_query, neighbors_per_query, bytes_per_query);
+                }
+            }
+        }
+    }
+
+    std::fclose(csv);
+    std::printf("wrote results to %s\n", options.out_path.c_str());
+    return 0;
+}
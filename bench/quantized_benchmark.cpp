@@ -0,0 +1,222 @@
+/*
+Quantized storage benchmark (float vs 16-bit fixed point boids)
+- runs FlockSimulation<2> twice from the same start, once with FloatStorage and once with
+  PackedStorage, and reports step times side by side
+- accuracy against the float run:
+    step 1  - position / velocity error after one step from the exact same state (only the
+              quantization of the result, nothing has had time to diverge yet)
+    final   - position error after all steps (flocking is chaotic, so this grows with time) and the
+              flock level numbers that should still agree: order parameter and neighbors per boid
+- the world grows with the boid count so the density stays the same as the preset
+
+usage:
+    BoidsQuantizedBench [--boids 10000,100000,1000000] [--preset 4] [--steps 100] [--warmup 5]
+                        [--threads 8] [--out quantized.csv]
+*/
+
+
+#include <omp.h>
+#include "bench_utils.hpp"
+#include "flock_simulation.hpp"
+#include "simulation_config.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+struct QuantizedOptions {
+    std::vector<int> boid_counts = {10000, 100000, 1000000};
+    int preset = 4;
+    int steps = 100;
+    int warmup_steps = 5;
+    int threads = 0;                    // 0 = OpenMP default
+    std::string out_path = "quantized.csv";
+};
+
+struct QuantizedResult {
+    int boids = 0;
+    int world_width = 0;
+    int world_height = 0;
+
+    double float_step_ms = 0.0;         // median
+    double fixed_step_ms = 0.0;
+    int float_bytes = sizeof(Boid);
+    int fixed_bytes = sizeof(PackedBoid<2>);
+
+    double step1_rms_position = 0.0;    // world units
+    double step1_max_position = 0.0;
+    double step1_rms_velocity = 0.0;
+    double final_rms_position = 0.0;
+
+    double float_order = 0.0, fixed_order = 0.0;
+    double float_neighbors = 0.0, fixed_neighbors = 0.0;
+};
+
+
+// polarization: length of the average unit velocity
+static double order_parameter(const std::vector<Boid>& boids) {
+    double sum_x = 0.0, sum_y = 0.0;
+    for (const Boid& boid : boids) {
+        float speed = std::sqrt(boid.vx * boid.vx + boid.vy * boid.vy);
+        if (speed > 0.0f) {
+            sum_x += boid.vx / speed;
+            sum_y += boid.vy / speed;
+        }
+    }
+    return boids.empty() ? 0.0 : std::sqrt(sum_x * sum_x + sum_y * sum_y) / boids.size();
+}
+
+// rms / max of the (wrapped) position difference and rms velocity difference between two runs
+static void compare(const std::vector<Boid>& a, const std::vector<Boid>& b, const SimulationParams& params,
+                    double& rms_position, double& max_position, double& rms_velocity) {
+    double position_sq = 0.0, velocity_sq = 0.0;
+    max_position = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        float dx = minimum_image(a[i].x - b[i].x, params.world_width);
+        float dy = minimum_image(a[i].y - b[i].y, params.world_height);
+        float dvx = a[i].vx - b[i].vx;
+        float dvy = a[i].vy - b[i].vy;
+        double distance_sq = dx * dx + dy * dy;
+        position_sq += distance_sq;
+        velocity_sq += dvx * dvx + dvy * dvy;
+        max_position = std::max(max_position, std::sqrt(distance_sq));
+    }
+    rms_position = a.empty() ? 0.0 : std::sqrt(position_sq / a.size());
+    rms_velocity = a.empty() ? 0.0 : std::sqrt(velocity_sq / a.size());
+}
+
+
+static QuantizedResult run_configuration(const QuantizedOptions& options, int boids) {
+    // ================= CONFIG SETUP =================
+    SimulationConfig config;
+    apply_preset(config, options.preset);
+    float area_scale = std::sqrt(static_cast<float>(boids) / static_cast<float>(config.NUM_BOIDS));
+    config.NUM_BOIDS = boids;
+    config.WINDOW_WIDTH = std::max(1, static_cast<int>(config.WINDOW_WIDTH * area_scale));
+    config.WINDOW_HEIGHT = std::max(1, static_cast<int>(config.WINDOW_HEIGHT * area_scale));
+    config.PARALLELISM_ENABLED = true;
+    SimulationParams params = SimulationParams::from_config(config);
+    float dt = (1.0f / 60.0f) * config.SPEED;
+
+    // both runs start from the packed start positions, so the start itself is not part of the error
+    FlockSimulation<2, PackedStorage<2>> fixed;
+    FlockSimulation<2> floats;
+    std::mt19937 rng(12345u);
+    std::uniform_real_distribution<float> x_dist(0.0f, params.world_width);
+    std::uniform_real_distribution<float> y_dist(0.0f, params.world_height);
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+    for (int i = 0; i < boids; i++) {
+        fixed.add_boid({x_dist(rng), y_dist(rng), v_dist(rng), v_dist(rng)}, params);
+    }
+    SimulationStats stats;
+    for (int step = 0; step < options.warmup_steps; step++) fixed.step(dt, params, stats);
+    floats.boids = fixed.float_boids(params);
+
+    QuantizedResult result;
+    result.boids = boids;
+    result.world_width = config.WINDOW_WIDTH;
+    result.world_height = config.WINDOW_HEIGHT;
+
+    // ================= TIMED STEPS =================
+    std::vector<double> float_ms, fixed_ms;
+    double float_neighbors = 0.0, fixed_neighbors = 0.0;
+    for (int step = 0; step < options.steps; step++) {
+        double start = steady_now_ms();
+        floats.step(dt, params, stats);
+        float_ms.push_back(steady_now_ms() - start);
+        float_neighbors += stats.avg_neighbors;
+
+        start = steady_now_ms();
+        fixed.step(dt, params, stats);
+        fixed_ms.push_back(steady_now_ms() - start);
+        fixed_neighbors += stats.avg_neighbors;
+
+        if (step == 0) {
+            compare(floats.boids, fixed.float_boids(params), params,
+                    result.step1_rms_position, result.step1_max_position, result.step1_rms_velocity);
+        }
+    }
+
+    // ================= ACCURACY =================
+    double max_position = 0.0, rms_velocity = 0.0;
+    compare(floats.boids, fixed.float_boids(params), params, result.final_rms_position, max_position, rms_velocity);
+    result.float_step_ms = median(float_ms);
+    result.fixed_step_ms = median(fixed_ms);
+    result.float_order = order_parameter(floats.boids);
+    result.fixed_order = order_parameter(fixed.float_boids(params));
+    result.float_neighbors = float_neighbors / std::max(1, options.steps);
+    result.fixed_neighbors = fixed_neighbors / std::max(1, options.steps);
+    return result;
+}
+
+
+static void write_csv(const std::string& path, const std::vector<QuantizedResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "could not open " << path << " for writing\n";
+        return;
+    }
+    std::fprintf(file, "boids,world_width,world_height,float_bytes,fixed16_bytes,float_step_ms,fixed16_step_ms,speedup,"
+                       "step1_rms_position,step1_max_position,step1_rms_velocity,final_rms_position,"
+                       "float_order,fixed16_order,float_neighbors,fixed16_neighbors\n");
+    for (const QuantizedResult& r : results) {
+        std::fprintf(file, "%d,%d,%d,%d,%d,%.4f,%.4f,%.3f,%.6f,%.6f,%.6f,%.4f,%.4f,%.4f,%.3f,%.3f\n",
+                     r.boids, r.world_width, r.world_height, r.float_bytes, r.fixed_bytes, r.float_step_ms, r.fixed_step_ms,
+                     r.fixed_step_ms > 0.0 ? r.float_step_ms / r.fixed_step_ms : 0.0,
+                     r.step1_rms_position, r.step1_max_position, r.step1_rms_velocity, r.final_rms_position,
+                     r.float_order, r.fixed_order, r.float_neighbors, r.fixed_neighbors);
+    }
+    std::fclose(file);
+}
+
+
+static bool parse_args(int argc, char** argv, QuantizedOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--boids" && has_value)         options.boid_counts = parse_int_list(argv[++i]);
+        else if (arg == "--preset" && has_value)   options.preset = std::stoi(argv[++i]);
+        else if (arg == "--steps" && has_value)    options.steps = std::stoi(argv[++i]);
+        else if (arg == "--warmup" && has_value)   options.warmup_steps = std::stoi(argv[++i]);
+        else if (arg == "--threads" && has_value)  options.threads = std::stoi(argv[++i]);
+        else if (arg == "--out" && has_value)      options.out_path = argv[++i];
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    QuantizedOptions options;
+    if (!parse_args(argc, argv, options)) {
+        return 1;
+    }
+    if (options.threads > 0) {
+        omp_set_num_threads(options.threads);
+    }
+
+    std::vector<QuantizedResult> results;
+    for (int boids : options.boid_counts) {
+        QuantizedResult r = run_configuration(options, boids);
+        std::printf("boids=%-8d  float=%9.3f ms  fixed16=%9.3f ms (%.2fx)  step1 pos rms=%.5f max=%.5f vel rms=%.5f  "
+                    "final pos rms=%.2f  order %.4f / %.4f  neighbors %.2f / %.2f\n",
+                    r.boids, r.float_step_ms, r.fixed_step_ms, r.fixed_step_ms > 0.0 ? r.float_step_ms / r.fixed_step_ms : 0.0,
+                    r.step1_rms_position, r.step1_max_position, r.step1_rms_velocity, r.final_rms_position,
+                    r.float_order, r.fixed_order, r.float_neighbors, r.fixed_neighbors);
+        results.push_back(r);
+    }
+
+    write_csv(options.out_path, results);
+    std::printf("wrote %zu rows to %s\n", results.size(), options.out_path.c_str());
+    return 0;
+}
@@ -0,0 +1,364 @@
+/*
+Thread and problem-size scaling benchmark
+- runs the simulation headless (no window, no renderer) for every combination of
+  presets x neighbor search types x boid counts x thread counts
+- strong scaling: fixed number of boids, increasing thread count
+- weak scaling: boids per thread is fixed (boids = base boids * threads)
+- records median / p95 step time, phase breakdown and candidate counts, writes them as CSV
+- can compare against a stored baseline CSV and fail when a configuration got slower
+
+usage:
+    BoidsScalingBench [--threads 1,2,4] [--boids 1000,10000,100000,1000000]
+                      [--search naiive,grid,topological] [--presets 1,2,3,4] [--mode strong|weak|both]
+                      [--steps 50] [--warmup 5] [--naiive-max-boids 20000] [--fixed-world]
+                      [--out scaling.csv] [--baseline baseline.csv] [--threshold 0.10] [--quick]
+*/
+
+
+#include <omp.h>
+#include "bench_utils.hpp"
+#include "simulation.hpp"
+#include "simulation_config.hpp"
+#include "simulation_stats.hpp"
+#include "naiive_neighbor_search.hpp"
+#include "grid_neighbor_search.hpp"
+#include "topological_neighbor_search.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+using namespace std;
+
+
+struct BenchOptions {
+    std::vector<int> threads;
+    std::vector<int> boid_counts = {1000, 10000, 100000, 1000000};
+    std::vector<std::string> searches = {"naiive", "grid"};
+    std::vector<int> presets = {1, 2, 3, 4};
+    bool strong = true;
+    bool weak = false;
+
+    int steps = 50;                     // timed steps per configuration
+    int warmup_steps = 5;               // untimed steps before measuring (lets the flock settle a bit)
+    int naiive_max_boids = 20000;       // O(N^2) gets skipped above this
+    bool fixed_world = false;           // false = grow the world with the boid count so density stays the same as the preset
+
+    std::string out_path = "scaling.csv";
+    std::string baseline_path;          // empty = no regression check
+    double threshold = 0.10;            // allowed slowdown vs baseline (0.10 = 10%)
+};
+
+struct BenchResult {
+    std::string mode;
+    int preset = 0;
+    std::string search;
+    int boids = 0;
+    int threads = 0;
+    int world_width = 0;
+    int world_height = 0;
+    int steps = 0;
+
+    double median_step_ms = 0.0;
+    double p95_step_ms = 0.0;
+    double mean_step_ms = 0.0;
+    double median_build_ms = 0.0;       // grid build (NeighborSearch::build)
+    double median_query_cpu_ms = 0.0;   // get_neighbors time summed over all threads
+    double median_steer_ms = 0.0;       // everything in the step that isn't build or (per-thread) query time
+    double avg_candidates = 0.0;        // candidates checked per boid
+    double avg_neighbors = 0.0;         // neighbors found per boid
+
+    double speedup = 1.0;
+    double efficiency = 1.0;
+};
+
+
+// hardware thread sweep: 1, 2, 4, ... up to the number of processors (always including the max)
+static std::vector<int> default_thread_counts() {
+    std::vector<int> counts;
+    int max_threads = omp_get_num_procs();
+    for (int t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+
+// deterministic boid placement so every run of the benchmark sees the same flock
+static void seed_boids(std::vector<Boid>& boids, int count, int width, int height, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> x_dist(0.0f, static_cast<float>(width));
+    std::uniform_real_distribution<float> y_dist(0.0f, static_cast<float>(height));
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+
+    boids.clear();
+    boids.reserve(count);
+    for (int i = 0; i < count; i++) {
+        boids.push_back({x_dist(rng), y_dist(rng), v_dist(rng), v_dist(rng)});
+    }
+}
+
+
+static BenchResult run_configuration(const BenchOptions& options, const std::string& mode, int preset,
+                                     const std::string& search, int boids, int threads) {
+    // ================= CONFIG SETUP =================
+    SimulationConfig config;
+    apply_preset(config, preset);
+    int preset_boids = config.NUM_BOIDS;
+    config.NUM_BOIDS = boids;
+    config.SIMULATION_TYPE_GRID = (search == "grid" || search == "topological");
+    config.TOPOLOGICAL_ENABLED = (search == "topological");
+    config.PARALLELISM_ENABLED = true;  // always go through the OpenMP path so 1 thread is a fair baseline
+
+    if (!options.fixed_world) {
+        // scale the world area with the boid count so the density matches the preset
+        float area_scale = std::sqrt(static_cast<float>(boids) / static_cast<float>(preset_boids));
+        config.WINDOW_WIDTH = std::max(1, static_cast<int>(config.WINDOW_WIDTH * area_scale));
+        config.WINDOW_HEIGHT = std::max(1, static_cast<int>(config.WINDOW_HEIGHT * area_scale));
+    }
+    simulation_config = config;
+    omp_set_num_threads(threads);
+
+    SimulationState state;
+    seed_boids(state.boids, boids, config.WINDOW_WIDTH, config.WINDOW_HEIGHT, 12345u);
+
+    NaiiveNeighborSearch naiive_neighbor_search;
+    GridNeighborSearch grid_neighbor_search;
+    TopologicalNeighborSearch topological_neighbor_search;
+    NeighborSearch* neighbor_search = &naiive_neighbor_search;
+    if (config.TOPOLOGICAL_ENABLED) {
+        neighbor_search = &topological_neighbor_search;
+    } else if (config.SIMULATION_TYPE_GRID) {
+        neighbor_search = &grid_neighbor_search;
+    }
+    Simulation sim(neighbor_search);
+
+    // fixed timestep (60 fps worth of time) so runs are comparable
+    float dt = (1.0f / 60.0f) * config.SPEED;
+
+    // ================= WARMUP =================
+    for (int step = 0; step < options.warmup_steps; step++) {
+        sim.update(state, dt);
+    }
+
+    // ================= TIMED STEPS =================
+    std::vector<double> step_ms, build_ms, query_ms, steer_ms;
+    double total_candidates = 0.0;
+    double total_neighbors = 0.0;
+    for (int step = 0; step < options.steps; step++) {
+        double start = steady_now_ms();
+        sim.update(state, dt);
+        double elapsed = steady_now_ms() - start;
+
+        step_ms.push_back(elapsed);
+        build_ms.push_back(simulation_stats.grid_map_hash_time_ms);
+        query_ms.push_back(simulation_stats.get_neighbors_calc_time_ms);
+        double query_wall_ms = simulation_stats.get_neighbors_calc_time_ms / std::max(1, simulation_stats.num_threads);
+        steer_ms.push_back(std::max(0.0, elapsed - simulation_stats.grid_map_hash_time_ms - query_wall_ms));
+        total_candidates += simulation_stats.avg_checked_neighbors;
+        total_neighbors += simulation_stats.avg_neighbors;
+    }
+
+    BenchResult result;
+    result.mode = mode;
+    result.preset = preset;
+    result.search = search;
+    result.boids = boids;
+    result.threads = threads;
+    result.world_width = config.WINDOW_WIDTH;
+    result.world_height = config.WINDOW_HEIGHT;
+    result.steps = options.steps;
+    result.median_step_ms = median(step_ms);
+    result.p95_step_ms = percentile(step_ms, 95.0);
+    result.mean_step_ms = mean(step_ms);
+    result.median_build_ms = median(build_ms);
+    result.median_query_cpu_ms = median(query_ms);
+    result.median_steer_ms = median(steer_ms);
+    result.avg_candidates = total_candidates / std::max(1, options.steps);
+    result.avg_neighbors = total_neighbors / std::max(1, options.steps);
+    return result;
+}
+
+
+static void write_csv(const std::string& path, const std::vector<BenchResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "could not open " << path << " for writing\n";
+        return;
+    }
+    std::fprintf(file, "mode,preset,search,boids,threads,world_width,world_height,steps,"
+                       "median_step_ms,p95_step_ms,mean_step_ms,median_build_ms,median_query_cpu_ms,median_steer_ms,"
+                       "avg_candidates,avg_neighbors,speedup,efficiency\n");
+    for (const BenchResult& r : results) {
+        std::fprintf(file, "%s,%d,%s,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%.3f,%.3f\n",
+                     r.mode.c_str(), r.preset, r.search.c_str(), r.boids, r.threads, r.world_width, r.world_height, r.steps,
+                     r.median_step_ms, r.p95_step_ms, r.mean_step_ms, r.median_build_ms, r.median_query_cpu_ms, r.median_steer_ms,
+                     r.avg_candidates, r.avg_neighbors, r.speedup, r.efficiency);
+    }
+    std::fclose(file);
+}
+
+
+static std::string result_key(const std::string& mode, const std::string& preset, const std::string& search,
+                              const std::string& boids, const std::string& threads) {
+    return mode + "/" + preset + "/" + search + "/" + boids + "/" + threads;
+}
+
+// returns the number of tracked configurations that got slower than the baseline by more than the threshold
+static int check_regressions(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::vector<std::string> header;
+    std::vector<std::vector<std::string>> rows;
+    if (!read_csv(options.baseline_path, header, rows)) {
+        std::cerr << "could not read baseline " << options.baseline_path << "\n";
+        return -1;
+    }
+
+    int mode_col = column_index(header, "mode");
+    int preset_col = column_index(header, "preset");
+    int search_col = column_index(header, "search");
+    int boids_col = column_index(header, "boids");
+    int threads_col = column_index(header, "threads");
+    int median_col = column_index(header, "median_step_ms");
+    if (mode_col < 0 || preset_col < 0 || search_col < 0 || boids_col < 0 || threads_col < 0 || median_col < 0) {
+        std::cerr << "baseline " << options.baseline_path << " is missing required columns\n";
+        return -1;
+    }
+
+    // every row in the baseline is a tracked configuration
+    std::map<std::string, double> baseline;
+    for (const auto& row : rows) {
+        if (static_cast<int>(row.size()) < static_cast<int>(header.size())) continue;
+        baseline[result_key(row[mode_col], row[preset_col], row[search_col], row[boids_col], row[threads_col])] = std::stod(row[median_col]);
+    }
+
+    int regressions = 0;
+    for (const BenchResult& r : results) {
+        auto it = baseline.find(result_key(r.mode, std::to_string(r.preset), r.search, std::to_string(r.boids), std::to_string(r.threads)));
+        if (it == baseline.end() || it->second <= 0.0) continue;
+
+        double change = (r.median_step_ms - it->second) / it->second;
+        if (change > options.threshold) {
+            regressions++;
+            std::printf("REGRESSION  %-6s preset=%d %-6s boids=%-8d threads=%-3d  %.3f ms -> %.3f ms (+%.1f%%)\n",
+                        r.mode.c_str(), r.preset, r.search.c_str(), r.boids, r.threads,
+                        it->second, r.median_step_ms, change * 100.0);
+        }
+    }
+    return regressions;
+}
+
+
+static bool parse_args(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--threads" && has_value)               options.threads = parse_int_list(argv[++i]);
+        else if (arg == "--boids" && has_value)            options.boid_counts = parse_int_list(argv[++i]);
+        else if (arg == "--search" && has_value)           options.searches = split(argv[++i]);
+        else if (arg == "--presets" && has_value)          options.presets = parse_int_list(argv[++i]);
+        else if (arg == "--steps" && has_value)            options.steps = std::stoi(argv[++i]);
+        else if (arg == "--warmup" && has_value)           options.warmup_steps = std::stoi(argv[++i]);
+        else if (arg == "--naiive-max-boids" && has_value) options.naiive_max_boids = std::stoi(argv[++i]);
+        else if (arg == "--out" && has_value)              options.out_path = argv[++i];
+        else if (arg == "--baseline" && has_value)         options.baseline_path = argv[++i];
+        else if (arg == "--threshold" && has_value)        options.threshold = std::stod(argv[++i]);
+        else if (arg == "--fixed-world")                   options.fixed_world = true;
+        else if (arg == "--mode" && has_value) {
+            std::string mode = argv[++i];
+            options.strong = (mode == "strong" || mode == "both");
+            options.weak = (mode == "weak" || mode == "both");
+        }
+        else if (arg == "--quick") {
+            // small sweep for a quick sanity check
+            options.boid_counts = {1000, 10000};
+            options.steps = 10;
+            options.warmup_steps = 2;
+        }
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.threads.empty()) {
+        options.threads = default_thread_counts();
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parse_args(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    std::vector<std::string> modes;
+    if (options.strong) modes.push_back("strong");
+    if (options.weak) modes.push_back("weak");
+
+    for (const std::string& mode : modes) {
+        for (int preset : options.presets) {
+            for (const std::string& search : options.searches) {
+                for (int base_boids : options.boid_counts) {
+                    double first_step_ms = 0.0;
+                    int first_threads = 0;
+
+                    for (int threads : options.threads) {
+                        int boids = (mode == "weak") ? base_boids * threads : base_boids;
+                        if (search == "naiive" && boids > options.naiive_max_boids) {
+                            continue; // O(N^2) would take forever here
+                        }
+
+                        BenchResult result = run_configuration(options, mode, preset, search, boids, threads);
+
+                        // speedup / efficiency are relative to the smallest thread count that was run
+                        if (first_threads == 0) {
+                            first_step_ms = result.median_step_ms;
+                            first_threads = threads;
+                        }
+                        double ratio = (result.median_step_ms > 0.0) ? first_step_ms / result.median_step_ms : 0.0;
+                        double thread_ratio = static_cast<double>(threads) / first_threads;
+                        if (mode == "strong") {
+                            result.speedup = ratio;
+                            result.efficiency = ratio / thread_ratio;
+                        } else {
+                            // weak scaling: the work grows with the threads, so ideal is a flat step time
+                            result.speedup = ratio * thread_ratio;
+                            result.efficiency = ratio;
+                        }
+
+                        std::printf("%-6s preset=%d %-11s boids=%-8d threads=%-3d  median=%9.3f ms  p95=%9.3f ms  "
+                                    "build=%8.3f ms  cand/boid=%8.1f  speedup=%5.2f  eff=%4.2f\n",
+                                    mode.c_str(), preset, search.c_str(), boids, threads,
+                                    result.median_step_ms, result.p95_step_ms, result.median_build_ms,
+                                    result.avg_candidates, result.speedup, result.efficiency);
+                        std::fflush(stdout);
+                        results.push_back(result);
+                    }
+                }
+            }
+        }
+    }
+
+    write_csv(options.out_path, results);
+    std::printf("wrote %zu results to %s\n", results.size(), options.out_path.c_str());
+
+    if (!options.baseline_path.empty()) {
+        int regressions = check_regressions(options, results);
+        if (regressions < 0) {
+            return 1;
+        }
+        if (regressions > 0) {
+            std::printf("%d configuration(s) regressed by more than %.1f%%\n", regressions, options.threshold * 100.0);
+            return 2;
+        }
+        std::printf("no regressions against %s\n", options.baseline_path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+/*
+Spatial index benchmark (published snapshots + concurrent readers)
+- steps a grid search Simulation that publishes a SpatialSnapshot after every step while reader threads
+  run radius / k nearest / box queries against the latest snapshot as fast as they can
+- reports the step time and publish time next to the same run without readers (the simulation never
+  waits on a reader, so the step time should only change by what the readers take from the cores),
+  the query rate over all readers and how many retired snapshots readers kept alive at most
+- --hold-ms makes every reader keep its snapshot that long after querying (a slow reader)
+- afterwards every query type is checked against a brute force pass over the last snapshot
+
+usage:
+    BoidsSpatialQueryBench [--boids 10000,100000] [--readers 0,1,2,4] [--preset 0] [--steps 200]
+                           [--radius 50] [--k 8] [--hold-ms 0] [--periodic] [--threads 8]
+                           [--out spatial_query.csv]
+*/
+
+
+#include <omp.h>
+#include "bench_utils.hpp"
+#include "grid_neighbor_search.hpp"
+#include "simulation.hpp"
+#include "simulation_config.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+
+struct SpatialQueryOptions {
+    std::vector<int> boid_counts = {10000, 100000};
+    std::vector<int> reader_counts = {0, 1, 2, 4};
+    int preset = 0;
+    int steps = 200;
+    float radius = 50.0f;
+    int k = 8;
+    int hold_ms = 0;
+    bool periodic = false;
+    int threads = 0;                    // 0 = OpenMP default
+    std::string out_path = "spatial_query.csv";
+};
+
+struct SpatialQueryResult {
+    int boids = 0;
+    int readers = 0;
+    double step_ms = 0.0;               // median, publish included
+    double publish_ms = 0.0;            // median
+    double publish_p99_ms = 0.0;
+    double queries_per_second = 0.0;    // over all readers
+    int max_retired = 0;
+    int mismatches = 0;                 // verification against brute force (0 = every query matched)
+};
+
+
+// checks radius, k nearest and box queries at random points against every boid of the snapshot
+static int verify(const SpatialSnapshot& snapshot, const SpatialQueryOptions& options, std::mt19937& rng) {
+    const float width = snapshot.get_world_width();
+    const float height = snapshot.get_world_height();
+    std::vector<SpatialHit> all, hits;
+    snapshot.query_box(0.0f, 0.0f, width, height, all);
+    if (static_cast<int>(all.size()) != snapshot.size()) return 1;
+
+    auto distance_sq = [&](const Boid& boid, float x, float y) {
+        float dx = boid.x - x, dy = boid.y - y;
+        if (options.periodic) {
+            dx = std::min(std::fabs(dx), width - std::fabs(dx));
+            dy = std::min(std::fabs(dy), height - std::fabs(dy));
+        }
+        return dx * dx + dy * dy;
+    };
+
+    std::uniform_real_distribution<float> x_dist(0.0f, width), y_dist(0.0f, height);
+    int mismatches = 0;
+    for (int check = 0; check < 200; check++) {
+        float x = x_dist(rng), y = y_dist(rng);
+
+        // radius: same set of slots
+        std::vector<int> expected, found;
+        for (const SpatialHit& hit : all) {
+            if (distance_sq(hit.boid, x, y) <= options.radius * options.radius) expected.push_back(hit.slot);
+        }
+        snapshot.query_radius(x, y, options.radius, hits);
+        for (const SpatialHit& hit : hits) found.push_back(hit.slot);
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        if (expected != found) mismatches++;
+
+        // k nearest: same distances (ties may pick different boids)
+        std::vector<float> expected_distances;
+        for (const SpatialHit& hit : all) expected_distances.push_back(distance_sq(hit.boid, x, y));
+        std::sort(expected_distances.begin(), expected_distances.end());
+        expected_distances.resize(std::min<size_t>(expected_distances.size(), options.k));
+        snapshot.query_nearest(x, y, options.k, hits);
+        bool nearest_ok = hits.size() == expected_distances.size();
+        for (size_t i = 0; nearest_ok && i < hits.size(); i++) nearest_ok = hits[i].distance_sq == expected_distances[i];
+        if (!nearest_ok) mismatches++;
+
+        // box (reaching past the edge when periodic)
+        float box_width = options.radius * 3.0f, box_height = options.radius * 2.0f;
+        expected.clear();
+        found.clear();
+        for (const SpatialHit& hit : all) {
+            float dx = hit.boid.x - x, dy = hit.boid.y - y;
+            if (options.periodic) {
+                dx -= width * std::floor(dx / width);
+                dy -= height * std::floor(dy / height);
+            }
+            if (dx >= 0.0f && dx <= box_width && dy >= 0.0f && dy <= box_height) expected.push_back(hit.slot);
+        }
+        snapshot.query_box(x, y, x + box_width, y + box_height, hits);
+        for (const SpatialHit& hit : hits) found.push_back(hit.slot);
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        if (expected != found) mismatches++;
+    }
+    return mismatches;
+}
+
+
+static SpatialQueryResult run_configuration(const SpatialQueryOptions& options, int boids, int readers) {
+    SimulationConfig config;
+    apply_preset(config, options.preset);
+    // keep the density of the preset
+    float area_scale = std::sqrt(static_cast<float>(boids) / static_cast<float>(config.NUM_BOIDS));
+    config.NUM_BOIDS = boids;
+    config.WINDOW_WIDTH = std::max(1, static_cast<int>(config.WINDOW_WIDTH * area_scale));
+    config.WINDOW_HEIGHT = std::max(1, static_cast<int>(config.WINDOW_HEIGHT * area_scale));
+    config.PARALLELISM_ENABLED = true;
+    config.PERIODIC_BOUNDARIES = options.periodic;
+    SimulationParams params = SimulationParams::from_config(config);
+    float dt = (1.0f / 60.0f) * config.SPEED;
+
+    SimulationState state;
+    std::mt19937 rng(12345u);
+    std::uniform_real_distribution<float> x_dist(0.0f, params.world_width);
+    std::uniform_real_distribution<float> y_dist(0.0f, params.world_height);
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+    for (int i = 0; i < boids; i++) {
+        state.spawn({x_dist(rng), y_dist(rng), v_dist(rng), v_dist(rng)});
+    }
+
+    GridNeighborSearch grid;
+    Simulation sim(&grid);
+    SpatialIndex index;
+    sim.set_spatial_index(&index);
+    SimulationStats stats;
+    sim.update(state, dt, params, stats);
+    sim.publish_snapshot(state, params, stats);   // first snapshot
+
+    // ================= READERS =================
+    std::atomic<bool> stop{false};
+    std::atomic<long long> queries{0};
+    std::vector<std::thread> threads;
+    for (int reader = 0; reader < readers; reader++) {
+        threads.emplace_back([&, reader] {
+            SpatialReader spatial_reader(index);
+            std::mt19937 reader_rng(1000u + reader);
+            std::vector<SpatialHit> hits;
+            long long done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const SpatialSnapshot* snapshot = spatial_reader.acquire();
+                float x = x_dist(reader_rng), y = y_dist(reader_rng);
+                snapshot->query_radius(x, y, options.radius, hits);
+                snapshot->query_nearest(x, y, options.k, hits);
+                snapshot->query_box(x, y, x + options.radius, y + options.radius, hits);
+                done += 3;
+                if (options.hold_ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(options.hold_ms));
+                spatial_reader.release();
+            }
+            queries += done;
+        });
+    }
+
+    // ================= TIMED STEPS =================
+    std::vector<double> step_ms, publish_ms;
+    SpatialQueryResult result;
+    result.boids = boids;
+    result.readers = readers;
+    double start_all = steady_now_ms();
+    for (int step = 0; step < options.steps; step++) {
+        double start = steady_now_ms();
+        sim.update(state, dt, params, stats);
+        sim.publish_snapshot(state, params, stats);
+        step_ms.push_back(steady_now_ms() - start);
+        publish_ms.push_back(stats.snapshot_publish_time_ms);
+        result.max_retired = std::max(result.max_retired, stats.snapshots_retired);
+    }
+    double elapsed_ms = steady_now_ms() - start_all;
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+
+    result.step_ms = median(step_ms);
+    result.publish_ms = median(publish_ms);
+    result.publish_p99_ms = percentile(publish_ms, 99.0);
+    result.queries_per_second = elapsed_ms > 0.0 ? queries.load() * 1000.0 / elapsed_ms : 0.0;
+
+    // ================= VERIFICATION =================
+    SpatialReader checker(index);
+    result.mismatches = verify(*checker.acquire(), options, rng);
+    checker.release();
+    return result;
+}
+
+
+static void write_csv(const std::string& path, const std::vector<SpatialQueryResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "could not open " << path << " for writing\n";
+        return;
+    }
+    std::fprintf(file, "boids,readers,step_ms,publish_ms,publish_p99_ms,queries_per_second,max_retired,mismatches\n");
+    for (const SpatialQueryResult& r : results) {
+        std::fprintf(file, "%d,%d,%.4f,%.4f,%.4f,%.1f,%d,%d\n", r.boids, r.readers, r.step_ms, r.publish_ms,
+                     r.publish_p99_ms, r.queries_per_second, r.max_retired, r.mismatches);
+    }
+    std::fclose(file);
+}
+
+
+static bool parse_args(int argc, char** argv, SpatialQueryOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--boids" && has_value)          options.boid_counts = parse_int_list(argv[++i]);
+        else if (arg == "--readers" && has_value)   options.reader_counts = parse_int_list(argv[++i]);
+        else if (arg == "--preset" && has_value)    options.preset = std::stoi(argv[++i]);
+        else if (arg == "--steps" && has_value)     options.steps = std::stoi(argv[++i]);
+        else if (arg == "--radius" && has_value)    options.radius = std::stof(argv[++i]);
+        else if (arg == "--k" && has_value)         options.k = std::stoi(argv[++i]);
+        else if (arg == "--hold-ms" && has_value)   options.hold_ms = std::stoi(argv[++i]);
+        else if (arg == "--periodic")               options.periodic = true;
+        else if (arg == "--threads" && has_value)   options.threads = std::stoi(argv[++i]);
+        else if (arg == "--out" && has_value)       options.out_path = argv[++i];
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    SpatialQueryOptions options;
+    if (!parse_args(argc, argv, options)) {
+        return 1;
+    }
+    if (options.threads > 0) {
+        omp_set_num_threads(options.threads);
+    }
+
+    std::vector<SpatialQueryResult> results;
+    bool all_matched = true;
+    for (int boids : options.boid_counts) {
+        for (int readers : options.reader_counts) {
+            SpatialQueryResult r = run_configuration(options, boids, readers);
+            std::printf("boids=%-8d readers=%-2d  step=%8.3f ms  publish=%7.3f ms (p99 %7.3f)  queries=%10.0f/s  "
+                        "max retired=%-4d  %s\n",
+                        r.boids, r.readers, r.step_ms, r.publish_ms, r.publish_p99_ms, r.queries_per_second,
+                        r.max_retired, r.mismatches == 0 ? "verified" : "MISMATCH");
+            all_matched = all_matched && r.mismatches == 0;
+            results.push_back(r);
+        }
+    }
+
+    write_csv(options.out_path, results);
+    std::printf("wrote %zu rows to %s\n", results.size(), options.out_path.c_str());
+    return all_matched ? 0 : 1;
+}
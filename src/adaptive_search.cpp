@@ -0,0 +1,185 @@
+#include "adaptive_search.hpp"
+
+#include <algorithm>
+using namespace std;
+
+
+AdaptiveSearchController::~AdaptiveSearchController() {
+    if (log_file) fclose(log_file);
+}
+
+
+int AdaptiveSearchController::add_candidate(const char* name, NeighborSearch* search) {
+    candidates.push_back({name, search, 0.0f, 0.0f});
+    return static_cast<int>(candidates.size()) - 1;
+}
+
+
+void AdaptiveSearchController::set_log_file(const char* path) {
+    if (log_file) fclose(log_file);
+    log_file = (path && path[0]) ? fopen(path, "a") : nullptr;
+}
+
+
+void AdaptiveSearchController::reset(int new_active) {
+    active = new_active;
+    running = new_active;
+    phase = Phase::MEASURE;
+    frames_until_probe = SETTLE_FRAMES;
+    frames_on_running = 0;
+    active_costs.clear();
+    active_costs_next = 0;
+    probe_costs.clear();
+    probe_checked = 0.0f;
+}
+
+
+// ================= PER FRAME =================
+
+NeighborSearch* AdaptiveSearchController::on_frame(const SimulationStats& stats, const SimulationConfig& config) {
+    if (candidates.empty()) return nullptr;
+    frames++;
+    if (candidates.size() < 2) return candidates[active].search;
+
+    // the numbers collected so far say nothing about the new setup, go back to the active search and
+    // probe again once things settled
+    if (config_changed(config)) {
+        reset(active);
+        return candidates[active].search;
+    }
+
+    frames_on_running++;
+    bool measured = frames_on_running > WARMUP_FRAMES;
+    float cost = frame_cost(stats);
+
+    if (phase == Phase::MEASURE) {
+        if (measured) {
+            if (static_cast<int>(active_costs.size()) < PROBE_FRAMES) {
+                active_costs.push_back(cost);
+            } else {
+                active_costs[active_costs_next] = cost;
+            }
+            active_costs_next = (active_costs_next + 1) % PROBE_FRAMES;
+            candidates[active].avg_checked = stats.avg_checked_neighbors;
+        }
+        frames_until_probe--;
+        if (frames_until_probe <= 0 && static_cast<int>(active_costs.size()) == PROBE_FRAMES) {
+            start_probe();
+        }
+        return candidates[running].search;
+    }
+
+    // ================= PROBING =================
+    if (measured) {
+        probe_costs.push_back(cost);
+        probe_checked += stats.avg_checked_neighbors;
+    }
+    if (static_cast<int>(probe_costs.size()) == PROBE_FRAMES) {
+        candidates[running].cost_ms = median(probe_costs);
+        candidates[running].avg_checked = probe_checked / PROBE_FRAMES;
+
+        int next = next_probe_candidate(running);
+        if (next < 0) {
+            finish_probe(config);
+        } else {
+            running = next;
+            frames_on_running = 0;
+            probe_costs.clear();
+            probe_checked = 0.0f;
+        }
+    }
+    return candidates[running].search;
+}
+
+
+// ================= HELPERS =================
+
+float AdaptiveSearchController::frame_cost(const SimulationStats& stats) {
+    // the per-boid neighbor time is summed over the worker threads
+    int threads = std::max(1, stats.num_threads);
+    return stats.grid_map_hash_time_ms + stats.get_neighbors_calc_time_ms / threads;
+}
+
+
+float AdaptiveSearchController::median(std::vector<float> values) {
+    if (values.empty()) return 0.0f;
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    return values[middle];
+}
+
+
+bool AdaptiveSearchController::config_changed(const SimulationConfig& config) {
+    bool changed = config.NUM_BOIDS != last_num_boids ||
+                   config.PERCEPTION_RADIUS != last_perception_radius ||
+                   config.GRID_CELL_SIZE != last_grid_cell_size ||
+                   config.PARALLELISM_ENABLED != last_parallelism ||
+                   config.SYMMETRIC_PAIRS_ENABLED != last_symmetric_pairs ||
+                   config.FAR_FIELD_ENABLED != last_far_field;
+    last_num_boids = config.NUM_BOIDS;
+    last_perception_radius = config.PERCEPTION_RADIUS;
+    last_grid_cell_size = config.GRID_CELL_SIZE;
+    last_parallelism = config.PARALLELISM_ENABLED;
+    last_symmetric_pairs = config.SYMMETRIC_PAIRS_ENABLED;
+    last_far_field = config.FAR_FIELD_ENABLED;
+    return changed;
+}
+
+
+void AdaptiveSearchController::start_probe() {
+    int first = next_probe_candidate(-1);
+    if (first < 0) return;
+    phase = Phase::PROBE;
+    running = first;
+    frames_on_running = 0;
+    probe_costs.clear();
+    probe_checked = 0.0f;
+}
+
+
+// next candidate (other than the active one) after `after`, -1 once all were probed
+int AdaptiveSearchController::next_probe_candidate(int after) const {
+    for (int c = after + 1; c < static_cast<int>(candidates.size()); c++) {
+        if (c != active) return c;
+    }
+    return -1;
+}
+
+
+void AdaptiveSearchController::finish_probe(const SimulationConfig& config) {
+    candidates[active].cost_ms = median(active_costs);
+
+    int best = active;
+    for (int c = 0; c < static_cast<int>(candidates.size()); c++) {
+        if (candidates[c].cost_ms < candidates[best].cost_ms) best = c;
+    }
+    // hysteresis: the winner has to be clearly cheaper than what is running now
+    int previous = active;
+    if (best != active && candidates[best].cost_ms < candidates[active].cost_ms * (1.0f - config.ADAPTIVE_SEARCH_HYSTERESIS)) {
+        active = best;
+        switches++;
+    }
+
+    if (log_file) {
+        fprintf(log_file, "[frame %lld] boids=%d radius=%g cell=%g parallel=%d |",
+                frames, config.NUM_BOIDS, config.PERCEPTION_RADIUS, config.GRID_CELL_SIZE, config.PARALLELISM_ENABLED ? 1 : 0);
+        for (const Candidate& candidate : candidates) {
+            fprintf(log_file, " %s %.3f ms (%.1f checked/boid) |", candidate.name, candidate.cost_ms, candidate.avg_checked);
+        }
+        if (active != previous) {
+            fprintf(log_file, " switch %s -> %s\n", candidates[previous].name, candidates[active].name);
+        } else {
+            fprintf(log_file, " keep %s\n", candidates[active].name);
+        }
+        fflush(log_file);
+    }
+
+    phase = Phase::MEASURE;
+    running = active;
+    frames_on_running = 0;
+    frames_until_probe = config.ADAPTIVE_SEARCH_INTERVAL;
+    active_costs.clear();
+    active_costs_next = 0;
+    probe_costs.clear();
+    probe_checked = 0.0f;
+}
@@ -0,0 +1,94 @@
+/*
+adaptive selection between the metric neighbor searches (naiive / grid)
+- which one is faster depends on the number of boids, the perception radius, the grid cell size and how
+  clustered the flock is, so instead of guessing the controller measures them
+- every ADAPTIVE_SEARCH_INTERVAL frames (and shortly after N, the radius, the cell size, parallelism
+  or the grid options change) it runs each of the other searches for a few probe frames, then compares
+  the median frame cost of every candidate against the median cost of the active one
+- cost = neighbor search build time + per-boid neighbor time / threads (both straight from
+  SimulationStats), so it is roughly the wall time the search adds to a frame
+- it only switches when the winner is cheaper by more than ADAPTIVE_SEARCH_HYSTERESIS, so two searches
+  that cost about the same don't flip back and forth
+- every decision (switch or keep) is appended to a log file together with the measured costs and
+  candidate counts
+*/
+
+
+#pragma once
+#include <cstdio>
+#include <vector>
+#include "neighbor_search.hpp"
+#include "simulation_config.hpp"
+#include "simulation_stats.hpp"
+using namespace std;
+
+
+class AdaptiveSearchController {
+    public:
+        static const int PROBE_FRAMES = 12;         // measured frames per candidate
+        static const int WARMUP_FRAMES = 2;         // frames skipped after every switch (cold caches / first build)
+        static const int SETTLE_FRAMES = 10;        // frames to wait after a relevant config change before probing
+
+        ~AdaptiveSearchController();
+
+        // candidates must all be metric (radius) searches that give the same neighbors
+        int add_candidate(const char* name, NeighborSearch* search);
+        // append decisions to this file (nullptr / empty = no log)
+        void set_log_file(const char* path);
+
+        // start over with candidate `active` (drops all measurements, probes again soon)
+        void reset(int active);
+
+        // call once per frame after the update, returns the search to run on the next frame
+        // (while probing that is not necessarily the active one)
+        NeighborSearch* on_frame(const SimulationStats& stats, const SimulationConfig& config);
+
+        int get_active() const { return active; }
+        bool is_probing() const { return phase == Phase::PROBE; }
+        const char* get_name(int candidate) const { return candidates[candidate].name; }
+        int get_switches() const { return switches; }
+
+    private:
+        enum class Phase {
+            MEASURE,                                // running the active search, collecting its costs
+            PROBE                                   // running the other candidates one after another
+        };
+
+        struct Candidate {
+            const char* name;
+            NeighborSearch* search;
+            float cost_ms;                          // median cost of the last probe
+            float avg_checked;                      // mean candidates checked per boid during that probe
+        };
+
+        std::vector<Candidate> candidates;
+        int active = 0;                             // the search that was decided on
+        int running = 0;                            // the search running this frame
+        Phase phase = Phase::MEASURE;
+        int frames_until_probe = SETTLE_FRAMES;
+        int frames_on_running = 0;                  // frames since `running` was switched to
+        int switches = 0;
+        long long frames = 0;                       // frames seen (only used for the log)
+
+        std::vector<float> active_costs;            // ring of the active search's recent costs
+        int active_costs_next = 0;
+        std::vector<float> probe_costs;
+        float probe_checked = 0.0f;
+
+        // the config values the right choice depends on (a change triggers an early probe)
+        int last_num_boids = -1;
+        float last_perception_radius = -1.0f;
+        float last_grid_cell_size = -1.0f;
+        bool last_parallelism = false;
+        bool last_symmetric_pairs = false;
+        bool last_far_field = false;
+
+        FILE* log_file = nullptr;
+
+        static float frame_cost(const SimulationStats& stats);
+        static float median(std::vector<float> values);
+        bool config_changed(const SimulationConfig& config);
+        void start_probe();
+        void finish_probe(const SimulationConfig& config);
+        int next_probe_candidate(int after) const;
+};
@@ -0,0 +1,197 @@
+/*
+headless batch parameter sweep
+- builds the cartesian product of the given parameter lists (on top of one of the presets), or reads
+  the variants from a CSV file, and runs them all through run_batch
+- writes one summary row per run as CSV
+
+usage:
+    BoidsBatch [--preset 0] [--boids 1000] [--radius 30,45,60] [--alignment 0.1,0.3,0.5]
+               [--cohesion 0.05,0.1,0.2] [--separation 0.5,1.0,2.0] [--speed 5]
+               [--search grid|naiive|topological] [--dims 2|3] [--depth 600] [--quantized] [--steps 500] [--measure-steps 100] [--team-size 1]
+               [--seed 1234] [--configs variants.csv] [--out batch.csv]
+
+variants.csv uses the config field names as headers, e.g.
+    NUM_BOIDS,PERCEPTION_RADIUS,ALIGNMENT_WEIGHT,COHESION_WEIGHT,SEPARATION_WEIGHT
+    1000,45,0.3,0.2,1.0
+
+3D runs (--dims 3) always use the dense grid search with a 27 cell stencil, the world is
+WORLD_WIDTH x WORLD_HEIGHT (the window size unless set in the variants file) x WORLD_DEPTH
+
+--quantized stores the boids as 16-bit fixed point (packed_boid.hpp). like 3D runs these go through
+the dense grid FlockSimulation, whatever --search says
+*/
+
+
+#include "batch_runner.hpp"
+#include "simulation_config.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty() && part.back() == '\r') part.pop_back();
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static std::vector<float> parse_float_list(const std::string& text) {
+    std::vector<float> values;
+    for (const std::string& part : split_list(text)) values.push_back(std::stof(part));
+    return values;
+}
+
+
+// every row of the file becomes one variant of the base config
+static bool read_config_file(const std::string& path, const SimulationConfig& base, std::vector<SimulationConfig>& configs) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "could not open " << path << "\n";
+        return false;
+    }
+    std::string line;
+    if (!std::getline(file, line)) return false;
+    std::vector<std::string> header = split_list(line);
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::vector<std::string> cells = split_list(line);
+        SimulationConfig config = base;
+        for (size_t c = 0; c < cells.size() && c < header.size(); c++) {
+            if (!set_config_field(config, header[c], cells[c])) {
+                std::cerr << "unknown config field: " << header[c] << "\n";
+                return false;
+            }
+        }
+        configs.push_back(config);
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    int preset = 0;
+    std::string configs_path;
+    std::string out_path = "batch.csv";
+    bool use_grid = true;
+    bool use_topological = false;
+    int dimensions = 2;
+    int depth = -1;
+    bool quantized = false;
+    std::vector<float> boid_counts, radii, alignments, cohesions, separations, speeds;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        if (arg == "--preset" && has_value)              preset = std::stoi(argv[++i]);
+        else if (arg == "--boids" && has_value)          boid_counts = parse_float_list(argv[++i]);
+        else if (arg == "--radius" && has_value)         radii = parse_float_list(argv[++i]);
+        else if (arg == "--alignment" && has_value)      alignments = parse_float_list(argv[++i]);
+        else if (arg == "--cohesion" && has_value)       cohesions = parse_float_list(argv[++i]);
+        else if (arg == "--separation" && has_value)     separations = parse_float_list(argv[++i]);
+        else if (arg == "--speed" && has_value)          speeds = parse_float_list(argv[++i]);
+        else if (arg == "--search" && has_value) {
+            std::string search = argv[++i];
+            use_grid = (search != "naiive");
+            use_topological = (search == "topological");
+        }
+        else if (arg == "--dims" && has_value)           dimensions = std::stoi(argv[++i]);
+        else if (arg == "--depth" && has_value)          depth = std::stoi(argv[++i]);
+        else if (arg == "--quantized")                   quantized = true;
+        else if (arg == "--steps" && has_value)          options.steps = std::stoi(argv[++i]);
+        else if (arg == "--measure-steps" && has_value)  options.measure_steps = std::stoi(argv[++i]);
+        else if (arg == "--team-size" && has_value)      options.team_size = std::stoi(argv[++i]);
+        else if (arg == "--seed" && has_value)           options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--configs" && has_value)        configs_path = argv[++i];
+        else if (arg == "--out" && has_value)            out_path = argv[++i];
+        else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // ================= BUILD THE LIST OF VARIANTS =================
+    SimulationConfig base;
+    if (!apply_preset(base, preset)) {
+        std::cerr << "unknown preset " << preset << "\n";
+        return 1;
+    }
+    base.SIMULATION_TYPE_GRID = use_grid;
+    base.TOPOLOGICAL_ENABLED = use_topological;
+    if (dimensions != 2 && dimensions != 3) {
+        std::cerr << "--dims must be 2 or 3\n";
+        return 1;
+    }
+    base.SIMULATION_DIMENSIONS = dimensions;
+    if (depth > 0) base.WORLD_DEPTH = depth;
+    base.QUANTIZED_STORAGE = quantized;
+
+    std::vector<SimulationConfig> configs;
+    if (!configs_path.empty()) {
+        if (!read_config_file(configs_path, base, configs)) return 1;
+    } else {
+        // an empty list means "keep the preset value"
+        if (boid_counts.empty()) boid_counts = {static_cast<float>(base.NUM_BOIDS)};
+        if (radii.empty())       radii = {base.PERCEPTION_RADIUS};
+        if (alignments.empty())  alignments = {base.ALIGNMENT_WEIGHT};
+        if (cohesions.empty())   cohesions = {base.COHESION_WEIGHT};
+        if (separations.empty()) separations = {base.SEPARATION_WEIGHT};
+        if (speeds.empty())      speeds = {base.SPEED};
+
+        for (float boids : boid_counts)
+        for (float radius : radii)
+        for (float alignment : alignments)
+        for (float cohesion : cohesions)
+        for (float separation : separations)
+        for (float speed : speeds) {
+            SimulationConfig config = base;
+            config.NUM_BOIDS = static_cast<int>(boids);
+            config.PERCEPTION_RADIUS = radius;
+            config.ALIGNMENT_WEIGHT = alignment;
+            config.COHESION_WEIGHT = cohesion;
+            config.SEPARATION_WEIGHT = separation;
+            config.SPEED = speed;
+            configs.push_back(config);
+        }
+    }
+
+    std::cout << "Running " << configs.size() << " simulations for " << options.steps << " steps each...\n";
+    std::vector<RunSummary> summaries = run_batch(configs, options);
+
+    // ================= OUTPUT =================
+    FILE* csv = std::fopen(out_path.c_str(), "w");
+    if (!csv) {
+        std::cerr << "could not open " << out_path << " for writing\n";
+        return 1;
+    }
+    std::fprintf(csv, "run,dims,num_boids,speed,perception_radius,alignment_weight,cohesion_weight,separation_weight,search,storage,"
+                      "wall_time_ms,mean_step_ms,mean_neighbors,mean_order_parameter,final_order_parameter,"
+                      "cluster_count,largest_cluster_fraction\n");
+    for (const RunSummary& s : summaries) {
+        const SimulationConfig& c = s.config;
+        const char* search = (c.SIMULATION_DIMENSIONS == 3 || c.QUANTIZED_STORAGE) ? "dense_grid" 
+                           : (c.TOPOLOGICAL_ENABLED ? "topological" : (c.SIMULATION_TYPE_GRID ? "grid" : "naiive"));
+        std::fprintf(csv, "%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%s,%s,%.2f,%.4f,%.3f,%.4f,%.4f,%d,%.4f\n",
+                     s.run_index, c.SIMULATION_DIMENSIONS, c.NUM_BOIDS, c.SPEED, c.PERCEPTION_RADIUS, c.ALIGNMENT_WEIGHT, c.COHESION_WEIGHT,
+                     c.SEPARATION_WEIGHT, search, c.QUANTIZED_STORAGE ? "fixed16" : "float",
+                     s.wall_time_ms, s.mean_step_ms, s.mean_neighbors, s.mean_order_parameter, s.final_order_parameter,
+                     s.cluster_count, s.largest_cluster_fraction);
+        std::printf("run %3d  radius=%6.1f  align=%.2f  coh=%.2f  sep=%.2f  ->  neighbors=%6.2f  order=%.3f  clusters=%d\n",
+                    s.run_index, c.PERCEPTION_RADIUS, c.ALIGNMENT_WEIGHT, c.COHESION_WEIGHT, c.SEPARATION_WEIGHT,
+                    s.mean_neighbors, s.final_order_parameter, s.cluster_count);
+    }
+    std::fclose(csv);
+    std::printf("wrote %zu runs to %s\n", summaries.size(), out_path.c_str());
+    return 0;
+}
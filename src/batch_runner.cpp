@@ -0,0 +1,241 @@
+#include <omp.h>
+#include "batch_runner.hpp"
+#include "simulation.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+#include "naiive_neighbor_search.hpp"
+#include "grid_neighbor_search.hpp"
+#include "topological_neighbor_search.hpp"
+#include "flock_simulation.hpp"
+#include "dense_grid.hpp"
+#include "timing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+
+// polarization: length of the average unit velocity (0 = random headings, 1 = all boids aligned)
+template <int D>
+static float order_parameter(const std::vector<typename BoidTraits<D>::type>& boids) {
+    typedef BoidTraits<D> T;
+    if (boids.empty()) return 0.0f;
+    double sum[D] = {};
+    for (const auto& boid : boids) {
+        float speed_sq = 0.0f;
+        for (int a = 0; a < D; a++) speed_sq += T::velocity(boid, a) * T::velocity(boid, a);
+        float speed = std::sqrt(speed_sq);
+        if (speed > 0.0f) {
+            for (int a = 0; a < D; a++) sum[a] += T::velocity(boid, a) / speed;
+        }
+    }
+    double length_sq = 0.0;
+    for (int a = 0; a < D; a++) length_sq += sum[a] * sum[a];
+    return static_cast<float>(std::sqrt(length_sq) / boids.size());
+}
+
+
+// union-find root lookup (with path halving)
+static int find_root(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// counts the connected components of the "within perception radius" graph
+template <int D>
+static void count_clusters(const std::vector<typename BoidTraits<D>::type>& boids, const SimulationParams& params, RunSummary& summary) {
+    typedef BoidTraits<D> T;
+    int n = static_cast<int>(boids.size());
+    if (n == 0) return;
+
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    DenseGrid<D> grid;
+    grid.build(boids, params);
+    for (int i = 0; i < n; i++) {
+        grid.for_each_candidate(i, [&](int j) {
+            float distance_sq = 0.0f;
+            for (int a = 0; a < D; a++) {
+                float delta = T::position(boids[j], a) - T::position(boids[i], a);
+                if (params.periodic_boundaries) delta = minimum_image(delta, world_extent(params, a));
+                distance_sq += delta * delta;
+            }
+            if (distance_sq > params.perception_radius_sq) return;
+            int root_i = find_root(parent, i);
+            int root_j = find_root(parent, j);
+            if (root_i != root_j) parent[root_j] = root_i;
+        });
+    }
+
+    std::vector<int> cluster_sizes(n, 0);
+    int clusters = 0;
+    int largest = 0;
+    for (int i = 0; i < n; i++) {
+        int root = find_root(parent, i);
+        if (cluster_sizes[root]++ == 0) clusters++;
+        largest = std::max(largest, cluster_sizes[root]);
+    }
+    summary.cluster_count = clusters;
+    summary.largest_cluster_fraction = static_cast<float>(largest) / n;
+}
+
+
+// 3D runs (and 2D runs with quantized storage) go through the dimension generic FlockSimulation 
+// (dense grid, 9 / 27 cell stencil)
+template <int D, typename Storage>
+static RunSummary run_flock(int run_index, const SimulationConfig& config, const BatchOptions& options) {
+    typedef typename BoidTraits<D>::type BoidType;
+    typedef BoidTraits<D> T;
+    double start = steady_now_ms();
+
+    RunSummary summary;
+    summary.run_index = run_index;
+    summary.config = config;
+
+    SimulationParams params = SimulationParams::from_config(config);
+    params.parallelism_enabled = (options.team_size > 1);
+    params.perf_counters_enabled = false;
+    SimulationStats stats;
+
+    FlockSimulation<D, Storage> sim;
+    std::mt19937 rng(options.seed + run_index);
+    std::uniform_real_distribution<float> x_dist(0.0f, params.world_width);
+    std::uniform_real_distribution<float> y_dist(0.0f, params.world_height);
+    std::uniform_real_distribution<float> z_dist(0.0f, params.world_depth);
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+    sim.boids.reserve(config.NUM_BOIDS);
+    for (int i = 0; i < config.NUM_BOIDS; i++) {
+        // (same draw order as the float 2D / 3D runs, so the same seed gives the same start)
+        BoidType boid;
+        T::position(boid, 0) = x_dist(rng);
+        T::position(boid, 1) = y_dist(rng);
+        if (D == 3) T::position(boid, 2) = z_dist(rng);
+        for (int a = 0; a < D; a++) T::velocity(boid, a) = v_dist(rng);
+        sim.add_boid(boid, params);
+    }
+
+    if (params.parallelism_enabled) {
+        omp_set_num_threads(options.team_size);
+    }
+
+    float dt = (1.0f / 60.0f) * config.SPEED;
+    int measure_from = std::max(0, options.steps - options.measure_steps);
+    double neighbors_total = 0.0;
+    double order_total = 0.0;
+    int measured = 0;
+    for (int step = 0; step < options.steps; step++) {
+        sim.step(dt, params, stats);
+        if (step >= measure_from) {
+            neighbors_total += stats.avg_neighbors;
+            order_total += order_parameter<D>(sim.float_boids(params));
+            measured++;
+        }
+    }
+
+    summary.mean_neighbors = measured > 0 ? static_cast<float>(neighbors_total / measured) : 0.0f;
+    summary.mean_order_parameter = measured > 0 ? static_cast<float>(order_total / measured) : 0.0f;
+    summary.final_order_parameter = order_parameter<D>(sim.float_boids(params));
+    count_clusters<D>(sim.float_boids(params), params, summary);
+
+    summary.wall_time_ms = static_cast<float>(steady_now_ms() - start);
+    summary.mean_step_ms = options.steps > 0 ? summary.wall_time_ms / options.steps : 0.0f;
+    return summary;
+}
+
+
+static RunSummary run_single(int run_index, const SimulationConfig& config, const BatchOptions& options) {
+    if (config.SIMULATION_DIMENSIONS == 3) {
+        return config.QUANTIZED_STORAGE ? run_flock<3, PackedStorage<3>>(run_index, config, options)
+                                        : run_flock<3, FloatStorage<3>>(run_index, config, options);
+    }
+    if (config.QUANTIZED_STORAGE) {
+        return run_flock<2, PackedStorage<2>>(run_index, config, options);
+    }
+    double start = steady_now_ms();
+
+    RunSummary summary;
+    summary.run_index = run_index;
+    summary.config = config;
+
+    // ================= PER-RUN STATE (nothing shared) =================
+    SimulationState state;
+    state.sim_config = config;
+    SimulationParams params = SimulationParams::from_config(config);
+    params.parallelism_enabled = (options.team_size > 1);
+    params.perf_counters_enabled = false;
+    SimulationStats stats;
+
+    std::mt19937 rng(options.seed + run_index);
+    std::uniform_real_distribution<float> x_dist(0.0f, params.world_width);
+    std::uniform_real_distribution<float> y_dist(0.0f, params.world_height);
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+    state.boids.reserve(config.NUM_BOIDS);
+    for (int i = 0; i < config.NUM_BOIDS; i++) {
+        state.boids.push_back({x_dist(rng), y_dist(rng), v_dist(rng), v_dist(rng)});
+    }
+
+    NaiiveNeighborSearch naiive_neighbor_search;
+    GridNeighborSearch grid_neighbor_search;
+    TopologicalNeighborSearch topological_neighbor_search;
+    NeighborSearch* neighbor_search = &naiive_neighbor_search;
+    if (config.TOPOLOGICAL_ENABLED) {
+        neighbor_search = &topological_neighbor_search;
+    } else if (config.SIMULATION_TYPE_GRID) {
+        neighbor_search = &grid_neighbor_search;
+    }
+    Simulation sim(neighbor_search);
+
+    // the team size only matters for this thread's nested parallel region
+    if (params.parallelism_enabled) {
+        omp_set_num_threads(options.team_size);
+    }
+
+    // ================= STEPS =================
+    float dt = (1.0f / 60.0f) * config.SPEED;  // fixed timestep (60 fps worth of time)
+    int measure_from = std::max(0, options.steps - options.measure_steps);
+    double neighbors_total = 0.0;
+    double order_total = 0.0;
+    int measured = 0;
+    for (int step = 0; step < options.steps; step++) {
+        sim.update(state, dt, params, stats);
+        if (step >= measure_from) {
+            neighbors_total += stats.avg_neighbors;
+            order_total += order_parameter<2>(state.boids);
+            measured++;
+        }
+    }
+
+    // ================= SUMMARY =================
+    summary.mean_neighbors = measured > 0 ? static_cast<float>(neighbors_total / measured) : 0.0f;
+    summary.mean_order_parameter = measured > 0 ? static_cast<float>(order_total / measured) : 0.0f;
+    summary.final_order_parameter = order_parameter<2>(state.boids);
+    count_clusters<2>(state.boids, params, summary);
+
+    summary.wall_time_ms = static_cast<float>(steady_now_ms() - start);
+    summary.mean_step_ms = options.steps > 0 ? summary.wall_time_ms / options.steps : 0.0f;
+    return summary;
+}
+
+
+std::vector<RunSummary> run_batch(const std::vector<SimulationConfig>& configs, const BatchOptions& options) {
+    std::vector<RunSummary> summaries(configs.size());
+
+    // one simulation per core, or (cores / team size) simulations with a small team each
+    int team_size = std::max(1, options.team_size);
+    int concurrent_runs = std::max(1, omp_get_num_procs() / team_size);
+    if (team_size > 1) {
+        omp_set_max_active_levels(2);
+    }
+
+    // runs can take very different amounts of time (boid count, radius), so hand them out dynamically
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(concurrent_runs)
+    for (int i = 0; i < static_cast<int>(configs.size()); i++) {
+        summaries[i] = run_single(i, configs[i], options);
+    }
+    return summaries;
+}
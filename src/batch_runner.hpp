@@ -0,0 +1,40 @@
+/* 
+batch driver for parameter sweeps 
+- takes a list of SimulationConfig variants and runs each one as its own headless simulation for a 
+  fixed number of steps
+- runs are spread across the cores (one simulation per core, or a small OpenMP team per simulation)
+- every run owns its own state, neighbor search, params and stats (nothing is shared between runs, 
+  and the global simulation_config / simulation_stats are never touched)
+- each run produces a summary: mean neighbors, order parameter and number of clusters
+*/
+
+
+#pragma once
+#include <vector>
+#include "simulation_config.hpp"
+
+
+struct BatchOptions {
+    int steps = 500;                    // simulation steps per run
+    int measure_steps = 100;            // the last N steps are averaged into the summary
+    int team_size = 1;                  // threads per simulation (1 = one simulation per core)
+    unsigned seed = 1234;               // run i uses seed + i for its starting positions
+};
+
+struct RunSummary {
+    int run_index = 0;
+    SimulationConfig config;
+
+    float wall_time_ms = 0.0f;          // total time for this run
+    float mean_step_ms = 0.0f;
+
+    float mean_neighbors = 0.0f;        // average neighbors per boid (over the measured steps)
+    float mean_order_parameter = 0.0f;  // average polarization over the measured steps
+    float final_order_parameter = 0.0f; // |sum of unit velocities| / N after the last step (1 = everyone aligned)
+    int cluster_count = 0;              // connected groups of boids (within perception radius) after the last step
+    float largest_cluster_fraction = 0.0f;
+};
+
+
+// runs every config to completion and returns one summary per config (in the same order)
+std::vector<RunSummary> run_batch(const std::vector<SimulationConfig>& configs, const BatchOptions& options);
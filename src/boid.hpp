@@ -12,3 +12,9 @@ struct Boid {
     float vx, vy;     // velocity
 };
 
+// 3D boid (headless / batch runs only, see flock_simulation.hpp)
+struct Boid3 {
+    float x, y, z;    // position
+    float vx, vy, vz; // velocity
+};
+
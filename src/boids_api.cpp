@@ -0,0 +1,296 @@
+#define BOIDS_API_BUILD
+#include "boids_api.h"
+#include "adaptive_search.hpp"
+#include "grid_neighbor_search.hpp"
+#include "naiive_neighbor_search.hpp"
+#include "simulation.hpp"
+#include "simulation_config.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+#include "task_graph.hpp"
+#include "time_stepper.hpp"
+#include "timing.hpp"
+#include "topological_neighbor_search.hpp"
+
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+
+// everything one embedded simulation needs (nothing here is shared with other handles or the globals)
+struct boids_simulation {
+    SimulationConfig config;
+    SimulationState state;
+    SimulationStats stats;
+    float step_ms = 0.0f;
+
+    NaiiveNeighborSearch naiive_neighbor_search;
+    GridNeighborSearch grid_neighbor_search;
+    TopologicalNeighborSearch topological_neighbor_search;
+    AdaptiveSearchController adaptive_search;
+    int adaptive_naiive = 0;
+    int adaptive_grid = 0;
+    boids_search_type search_type = BOIDS_SEARCH_NAIIVE;
+
+    Simulation sim;
+    TimeStepper time_stepper;                       // only used with FIXED_TIMESTEP_ENABLED
+    std::unique_ptr<TaskExecutor> executor;         // created by the first step with PARALLELISM_ENABLED + TASK_GRAPH_ENABLED
+    std::mt19937 rng;
+
+    boids_simulation() : sim(&naiive_neighbor_search) {
+        adaptive_naiive = adaptive_search.add_candidate("naiive", &naiive_neighbor_search);
+        adaptive_grid = adaptive_search.add_candidate("grid", &grid_neighbor_search);
+    }
+};
+
+
+// ================= HELPERS =================
+
+static Boid random_boid(boids_simulation* sim) {
+    // same ranges as the interactive app: anywhere in the world, velocity in [-0.5, 0.5)
+    std::uniform_real_distribution<float> x_dist(0.0f, static_cast<float>(sim->config.get_world_width()));
+    std::uniform_real_distribution<float> y_dist(0.0f, static_cast<float>(sim->config.get_world_height()));
+    std::uniform_real_distribution<float> v_dist(-0.5f, 0.5f);
+    Boid boid;
+    boid.x = x_dist(sim->rng);
+    boid.y = y_dist(sim->rng);
+    boid.vx = v_dist(sim->rng);
+    boid.vy = v_dist(sim->rng);
+    return boid;
+}
+
+// grows / shrinks the pool to NUM_BOIDS. the pool is compacted right away so the exposed buffer never
+// has dead slots in it
+static void match_boid_count(boids_simulation* sim) {
+    SimulationState& state = sim->state;
+    while (state.num_live() < sim->config.NUM_BOIDS) {
+        state.spawn(random_boid(sim));
+    }
+    for (int slot = static_cast<int>(state.boids.size()) - 1; slot >= 0 && state.num_live() > sim->config.NUM_BOIDS; slot--) {
+        state.kill_slot(slot);
+    }
+    state.compact(sim->config.PARALLELISM_ENABLED);
+}
+
+// points the simulation at the search for search_type (and keeps the config flags in line with it)
+static void apply_search(boids_simulation* sim) {
+    SimulationConfig& config = sim->config;
+    switch (sim->search_type) {
+        case BOIDS_SEARCH_GRID:
+            config.SIMULATION_TYPE_GRID = true;
+            config.TOPOLOGICAL_ENABLED = false;
+            sim->sim.change_neighbor_search_type(&sim->grid_neighbor_search);
+            break;
+        case BOIDS_SEARCH_TOPOLOGICAL:
+            config.TOPOLOGICAL_ENABLED = true;
+            sim->sim.change_neighbor_search_type(&sim->topological_neighbor_search);
+            break;
+        case BOIDS_SEARCH_AUTO:
+            config.TOPOLOGICAL_ENABLED = false;
+            sim->adaptive_search.reset(config.SIMULATION_TYPE_GRID ? sim->adaptive_grid : sim->adaptive_naiive);
+            sim->sim.change_neighbor_search_type(config.SIMULATION_TYPE_GRID ? static_cast<NeighborSearch*>(&sim->grid_neighbor_search)
+                                                                             : &sim->naiive_neighbor_search);
+            break;
+        default:
+            config.SIMULATION_TYPE_GRID = false;
+            config.TOPOLOGICAL_ENABLED = false;
+            sim->sim.change_neighbor_search_type(&sim->naiive_neighbor_search);
+            break;
+    }
+}
+
+
+// ================= LIFETIME =================
+
+extern "C" int boids_api_version(void) {
+    return BOIDS_API_VERSION;
+}
+
+
+extern "C" boids_simulation* boids_create(int num_boids, int preset, unsigned int seed) {
+    if (num_boids < 0) return nullptr;
+    try {
+        boids_simulation* sim = new boids_simulation();
+        if (!apply_preset(sim->config, preset)) {
+            delete sim;
+            return nullptr;
+        }
+        sim->config.NUM_BOIDS = num_boids;
+        sim->state.sim_config = sim->config;
+        apply_search(sim);
+        sim->rng.seed(seed);
+        match_boid_count(sim);
+        return sim;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+
+extern "C" void boids_destroy(boids_simulation* sim) {
+    delete sim;
+}
+
+
+extern "C" boids_status boids_reset(boids_simulation* sim, int num_boids, unsigned int seed) {
+    if (!sim || num_boids < 0) return BOIDS_ERROR_INVALID_ARGUMENT;
+    try {
+        sim->state.clear_boids();
+        sim->state.lod.clear();
+        sim->config.NUM_BOIDS = num_boids;
+        sim->rng.seed(seed);
+        match_boid_count(sim);
+        sim->time_stepper.reset();
+        if (sim->search_type == BOIDS_SEARCH_AUTO) apply_search(sim);
+        return BOIDS_OK;
+    } catch (const std::bad_alloc&) {
+        return BOIDS_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return BOIDS_ERROR_INTERNAL;
+    }
+}
+
+
+// ================= STEPPING =================
+
+extern "C" boids_status boids_step(boids_simulation* sim, float seconds) {
+    if (!sim || !(seconds >= 0.0f)) return BOIDS_ERROR_INVALID_ARGUMENT;
+    try {
+        double start_time = steady_now_ms();
+        sim->state.sim_config = sim->config;
+        SimulationParams params = SimulationParams::from_config(sim->config);
+        // (the workers are only started once a step can use them, a serial embedding never pays for them)
+        if (params.parallelism_enabled && params.task_graph_enabled && !sim->executor) {
+            sim->executor.reset(new TaskExecutor());
+            sim->sim.set_executor(sim->executor.get());
+        }
+        if (sim->config.FIXED_TIMESTEP_ENABLED) {
+            // whole fixed steps out of the accumulated time (can be none for a short step), the buffer 
+            // always holds the last simulated step, not an interpolation
+            sim->time_stepper.advance(sim->sim, sim->state, seconds * sim->config.SPEED, params, sim->stats);
+        } else {
+            sim->sim.update(sim->state, seconds * sim->config.SPEED, params, sim->stats);
+        }
+        double end_time = steady_now_ms();
+        sim->step_ms = static_cast<float>(end_time - start_time);
+
+        // let the controller pick the search for the next step
+        if (sim->search_type == BOIDS_SEARCH_AUTO) {
+            NeighborSearch* next = sim->adaptive_search.on_frame(sim->stats, sim->config);
+            if (next) sim->sim.change_neighbor_search_type(next);
+            sim->config.SIMULATION_TYPE_GRID = (sim->adaptive_search.get_active() == sim->adaptive_grid);
+        }
+        return BOIDS_OK;
+    } catch (const std::bad_alloc&) {
+        return BOIDS_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return BOIDS_ERROR_INTERNAL;
+    }
+}
+
+
+// ================= PARAMETERS =================
+
+extern "C" boids_status boids_set_param(boids_simulation* sim, const char* name, const char* value) {
+    if (!sim || !name || !value) return BOIDS_ERROR_INVALID_ARGUMENT;
+    try {
+        SimulationConfig config = sim->config;
+        if (!set_config_field(config, name, value)) return BOIDS_ERROR_UNKNOWN_PARAM;
+        if (config.NUM_BOIDS < 0 || config.WINDOW_WIDTH <= 0 || config.WINDOW_HEIGHT <= 0 ||
+            config.WORLD_WIDTH < 0 || config.WORLD_HEIGHT < 0 ||
+            config.GRID_CELL_SIZE <= 0.0f || config.SIMULATION_DIMENSIONS != 2 ||
+            !(config.PERCEPTION_RADIUS > 0.0f) || !(config.MAX_SPEED > 0.0f) ||
+            !(config.FIXED_STEP_SECONDS > 0.0f) || config.MAX_SUBSTEPS < 1 || config.STEP_DISTANCE_FRACTION < 0.0f ||
+            config.CANDIDATE_SKIN_FRACTION < 0.0f || config.CANDIDATE_CACHE_MAX_STEPS < 1 ||
+            config.LOD_INTERVAL < 1 || config.LOD_MAX_DRIFT < 0.0f || config.ADAPTIVE_SEARCH_INTERVAL < 1 ||
+            !(config.ADAPTIVE_SEARCH_HYSTERESIS >= 0.0f && config.ADAPTIVE_SEARCH_HYSTERESIS < 1.0f)) {
+            return BOIDS_ERROR_INVALID_VALUE;
+        }
+        bool search_flags_changed = config.SIMULATION_TYPE_GRID != sim->config.SIMULATION_TYPE_GRID ||
+                                    config.TOPOLOGICAL_ENABLED != sim->config.TOPOLOGICAL_ENABLED;
+        sim->config = config;
+
+        // the search flags select the search (like the E / T keys in the app)
+        if (search_flags_changed) {
+            sim->search_type = config.TOPOLOGICAL_ENABLED ? BOIDS_SEARCH_TOPOLOGICAL
+                             : (config.SIMULATION_TYPE_GRID ? BOIDS_SEARCH_GRID : BOIDS_SEARCH_NAIIVE);
+            apply_search(sim);
+        }
+        if (sim->state.num_live() != config.NUM_BOIDS) {
+            match_boid_count(sim);
+            // (compacting moved boids to other slots, the stepper's previous step / cached candidates don't match anymore)
+            sim->time_stepper.reset();
+        }
+        return BOIDS_OK;
+    } catch (const std::invalid_argument&) {
+        return BOIDS_ERROR_INVALID_VALUE;
+    } catch (const std::out_of_range&) {
+        return BOIDS_ERROR_INVALID_VALUE;
+    } catch (const std::bad_alloc&) {
+        return BOIDS_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return BOIDS_ERROR_INTERNAL;
+    }
+}
+
+
+extern "C" boids_status boids_set_param_float(boids_simulation* sim, const char* name, double value) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    return boids_set_param(sim, name, text);
+}
+
+
+extern "C" boids_status boids_set_search(boids_simulation* sim, boids_search_type type) {
+    if (!sim || type < BOIDS_SEARCH_NAIIVE || type > BOIDS_SEARCH_AUTO) return BOIDS_ERROR_INVALID_ARGUMENT;
+    sim->search_type = type;
+    apply_search(sim);
+    return BOIDS_OK;
+}
+
+
+extern "C" boids_search_type boids_get_search(const boids_simulation* sim) {
+    if (!sim) return BOIDS_SEARCH_NAIIVE;
+    if (sim->search_type == BOIDS_SEARCH_AUTO) {
+        return sim->adaptive_search.get_active() == sim->adaptive_grid ? BOIDS_SEARCH_GRID : BOIDS_SEARCH_NAIIVE;
+    }
+    return sim->search_type;
+}
+
+
+// ================= BOID BUFFERS =================
+
+extern "C" int boids_count(const boids_simulation* sim) {
+    return sim ? static_cast<int>(sim->state.boids.size()) : 0;
+}
+
+
+extern "C" const float* boids_positions(const boids_simulation* sim, int* stride) {
+    if (stride) *stride = static_cast<int>(sizeof(Boid) / sizeof(float));
+    if (!sim || sim->state.boids.empty()) return nullptr;
+    return &sim->state.boids[0].x;
+}
+
+
+extern "C" const float* boids_velocities(const boids_simulation* sim, int* stride) {
+    if (stride) *stride = static_cast<int>(sizeof(Boid) / sizeof(float));
+    if (!sim || sim->state.boids.empty()) return nullptr;
+    return &sim->state.boids[0].vx;
+}
+
+
+extern "C" boids_status boids_get_stats(const boids_simulation* sim, boids_step_stats* out) {
+    if (!sim || !out) return BOIDS_ERROR_INVALID_ARGUMENT;
+    out->step_ms = sim->step_ms;
+    out->build_ms = sim->stats.grid_map_hash_time_ms;
+    out->neighbors_ms = sim->stats.get_neighbors_calc_time_ms;
+    out->avg_neighbors = sim->stats.avg_neighbors;
+    out->avg_checked_neighbors = sim->stats.avg_checked_neighbors;
+    out->num_threads = sim->stats.num_threads;
+    return BOIDS_OK;
+}
@@ -0,0 +1,132 @@
+/*
+C API for embedding the boids simulation (engines, Python via ctypes / cffi, ...)
+- plain C, opaque handle, no C++ types or exceptions cross the boundary, so it stays stable when the
+  internals change. BOIDS_API_VERSION is bumped whenever something here changes incompatibly
+- every simulation owns its own state, config, neighbor searches and stats (the globals used by the
+  interactive app are never touched), so several simulations can live in one process
+- functions that can fail return a boids_status (BOIDS_OK = 0, negative = error)
+- the boid buffers are exposed without copying: boids_positions / boids_velocities return pointers into
+  the simulation's own array (see the layout notes there)
+- 2D only (the interactive Simulation), the 3D / fixed point runs stay in the batch runner
+
+    boids_simulation* sim = boids_create(5000, 0, 1234);
+    boids_set_param(sim, "PERCEPTION_RADIUS", "45");
+    boids_set_search(sim, BOIDS_SEARCH_GRID);
+    for (...) {
+        boids_step(sim, 1.0f / 60.0f);
+        int stride;
+        const float* xy = boids_positions(sim, &stride);   // boid i: xy[i * stride], xy[i * stride + 1]
+    }
+    boids_destroy(sim);
+*/
+
+
+#ifndef BOIDS_API_H
+#define BOIDS_API_H
+
+#if defined(_WIN32)
+    #if defined(BOIDS_API_BUILD)
+        #define BOIDS_API __declspec(dllexport)
+    #elif defined(BOIDS_API_STATIC)
+        #define BOIDS_API
+    #else
+        #define BOIDS_API __declspec(dllimport)
+    #endif
+#else
+    #define BOIDS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define BOIDS_API_VERSION 1
+
+typedef struct boids_simulation boids_simulation;
+
+typedef enum boids_status {
+    BOIDS_OK = 0,
+    BOIDS_ERROR_INVALID_ARGUMENT = -1,      // null handle / pointer, negative count, ...
+    BOIDS_ERROR_UNKNOWN_PARAM = -2,         // no config field with that name
+    BOIDS_ERROR_INVALID_VALUE = -3,         // the value could not be parsed for that field
+    BOIDS_ERROR_OUT_OF_MEMORY = -4,
+    BOIDS_ERROR_INTERNAL = -5
+} boids_status;
+
+typedef enum boids_search_type {
+    BOIDS_SEARCH_NAIIVE = 0,                // all pairs
+    BOIDS_SEARCH_GRID = 1,                  // uniform grid (GRID_CELL_SIZE)
+    BOIDS_SEARCH_TOPOLOGICAL = 2,           // k nearest (TOPOLOGICAL_K) instead of a radius
+    BOIDS_SEARCH_AUTO = 3                   // naiive or grid, whichever measures faster (adaptive_search.hpp)
+} boids_search_type;
+
+// timings / counts of the last boids_step (all times in milliseconds)
+typedef struct boids_step_stats {
+    float step_ms;                          // wall time of the whole step
+    float build_ms;                         // neighbor search build
+    float neighbors_ms;                     // neighbor queries, summed over threads
+    float avg_neighbors;                    // neighbors per boid
+    float avg_checked_neighbors;            // candidates checked per boid
+    int num_threads;
+} boids_step_stats;
+
+
+// BOIDS_API_VERSION of the loaded library (compare against the header the host was built with)
+BOIDS_API int boids_api_version(void);
+
+// new simulation with num_boids boids at random positions (seeded). preset: 0 = default config,
+// 1-4 = the presets from the number keys. returns NULL on failure
+BOIDS_API boids_simulation* boids_create(int num_boids, int preset, unsigned int seed);
+BOIDS_API void boids_destroy(boids_simulation* sim);
+
+// replaces every boid with num_boids new random ones (seeded)
+BOIDS_API boids_status boids_reset(boids_simulation* sim, int num_boids, unsigned int seed);
+
+// advances the simulation by `seconds` of real time (scaled by SPEED like the interactive app). with
+// FIXED_TIMESTEP_ENABLED the time is split into fixed steps (FIXED_STEP_SECONDS, MAX_SUBSTEPS, 
+// CANDIDATE_* as in the app), leftover time carries over to the next call
+BOIDS_API boids_status boids_step(boids_simulation* sim, float seconds);
+
+// sets a config field by its SimulationConfig name ("PERCEPTION_RADIUS", "ALIGNMENT_WEIGHT", ...,
+// booleans take "1" / "0" / "true" / "false", anything else is BOIDS_ERROR_INVALID_VALUE). takes 
+// effect on the next step. changing NUM_BOIDS spawns / removes boids, WORLD_WIDTH / WORLD_HEIGHT are 
+// the world size (0 = WINDOW_WIDTH / WINDOW_HEIGHT). every field a headless step reads can be set:
+//   NUM_BOIDS, SPEED, MAX_SPEED, PERCEPTION_RADIUS, ALIGNMENT_WEIGHT, COHESION_WEIGHT, SEPARATION_WEIGHT,
+//   GRID_CELL_SIZE, WINDOW_WIDTH, WINDOW_HEIGHT, WORLD_WIDTH, WORLD_HEIGHT, PERIODIC_BOUNDARIES,
+//   SIMULATION_TYPE_GRID, TOPOLOGICAL_ENABLED, TOPOLOGICAL_K, TOPOLOGICAL_MAX_RANGE, FAR_FIELD_ENABLED,
+//   FAR_FIELD_NEAR_CELLS, SYMMETRIC_PAIRS_ENABLED, PARALLELISM_ENABLED, TASK_GRAPH_ENABLED, LOD_ENABLED,
+//   LOD_INTERVAL, LOD_NEIGHBOR_THRESHOLD, LOD_STEER_THRESHOLD, LOD_MAX_DRIFT, FIXED_TIMESTEP_ENABLED,
+//   FIXED_STEP_SECONDS, STEP_DISTANCE_FRACTION, MAX_SUBSTEPS, CANDIDATE_CACHE_ENABLED,
+//   CANDIDATE_SKIN_FRACTION, CANDIDATE_CACHE_MAX_STEPS, ADAPTIVE_SEARCH_INTERVAL, ADAPTIVE_SEARCH_HYSTERESIS
+//   (plus QUANTIZED_STORAGE / SIMULATION_DIMENSIONS / WORLD_DEPTH, which only the batch runner uses).
+// anything else (rendering, input, obstacles) is BOIDS_ERROR_UNKNOWN_PARAM
+BOIDS_API boids_status boids_set_param(boids_simulation* sim, const char* name, const char* value);
+// same as boids_set_param for numeric fields
+BOIDS_API boids_status boids_set_param_float(boids_simulation* sim, const char* name, double value);
+
+BOIDS_API boids_status boids_set_search(boids_simulation* sim, boids_search_type type);
+// the search the last step ran with (for BOIDS_SEARCH_AUTO: the one currently picked)
+BOIDS_API boids_search_type boids_get_search(const boids_simulation* sim);
+
+BOIDS_API int boids_count(const boids_simulation* sim);
+
+/*
+read-only views of the boid buffer (no copy)
+- the boids are stored interleaved: x, y, vx, vy (floats). *stride (optional) receives the distance
+  between two boids in floats, so boid i is at ptr[i * stride] (x / vx) and ptr[i * stride + 1] (y / vy)
+- the pointers are only valid until the next call that changes the simulation (step, reset,
+  set_param, destroy), fetch them again after every step
+- NULL if there are no boids
+*/
+BOIDS_API const float* boids_positions(const boids_simulation* sim, int* stride);
+BOIDS_API const float* boids_velocities(const boids_simulation* sim, int* stride);
+
+BOIDS_API boids_status boids_get_stats(const boids_simulation* sim, boids_step_stats* out);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+#include <omp.h>
+#include "cached_neighbor_search.hpp"
+#include "flock_kernels.hpp"
+
+#include <algorithm>
+using namespace std;
+
+
+void CachedNeighborSearch::set_source(NeighborSearch* search) {
+    if (search != source) valid = false;
+    source = search;
+}
+
+
+bool CachedNeighborSearch::can_reuse(const std::vector<Boid>& boids, const SimulationParams& params) const {
+    if (!valid || steps_since_rebuild + 1 >= params.candidate_cache_max_steps) return false;
+    if (anchors.size() != boids.size()) return false;
+    // lists gathered for a different radius / skin / world can't be filtered down to this one
+    if (gathered_params.perception_radius != params.perception_radius ||
+        gathered_params.candidate_skin != params.candidate_skin ||
+        gathered_params.grid_cell_size != params.grid_cell_size ||
+        gathered_params.world_width != params.world_width || gathered_params.world_height != params.world_height ||
+        gathered_params.periodic_boundaries != params.periodic_boundaries) {
+        return false;
+    }
+
+    // every boid still within half the skin of where it was at the rebuild (and nobody spawned / died, and 
+    // every list was gathered)
+    const float half_skin = params.candidate_skin * 0.5f;
+    const float half_skin_sq = half_skin * half_skin;
+    const int n = static_cast<int>(boids.size());
+    int moved_too_far = 0;
+    #pragma omp parallel for reduction(+:moved_too_far) if(params.parallelism_enabled)
+    for (int i = 0; i < n; i++) {
+        unsigned char alive = is_alive(i) ? 1 : 0;
+        if (alive != anchor_alive[i]) {
+            moved_too_far++;
+            continue;
+        }
+        if (!alive) continue;
+        if (!list_gathered[i]) {
+            moved_too_far++;
+            continue;
+        }
+        // (the lists are gathered across the wrap, so a boid that just wrapped around an edge only moved a little)
+        float dx = minimum_image(boids[i].x - anchors[i].x, params.world_width);
+        float dy = minimum_image(boids[i].y - anchors[i].y, params.world_height);
+        if (dx*dx + dy*dy > half_skin_sq) moved_too_far++;
+    }
+    return moved_too_far == 0;
+}
+
+
+SimulationParams CachedNeighborSearch::gather_params(const SimulationParams& params) const {
+    SimulationParams gathered = params;
+    gathered.perception_radius = params.perception_radius + params.candidate_skin;
+    gathered.perception_radius_sq = gathered.perception_radius * gathered.perception_radius;
+    if (gathered.grid_cell_size < gathered.perception_radius) {
+        gathered.grid_cell_size = gathered.perception_radius;
+        gathered.inv_grid_cell_size = 1.0f / gathered.grid_cell_size;
+    }
+    // always across the wrap: boids wrap around the edges either way, and a boid that wraps would otherwise 
+    // need new lists right away. get_neighbors drops the candidates across the wrap again when the 
+    // boundaries aren't periodic
+    gathered.periodic_boundaries = true;
+    // plain lists only
+    gathered.far_field_enabled = false;
+    gathered.symmetric_pairs_enabled = false;
+    return gathered;
+}
+
+
+void CachedNeighborSearch::rebuild(const std::vector<Boid>& boids, const SimulationParams& params) {
+    const int n = static_cast<int>(boids.size());
+    anchors = boids;
+    anchor_alive.resize(n);
+    for (int i = 0; i < n; i++) anchor_alive[i] = is_alive(i) ? 1 : 0;
+    candidates.resize(n);
+    list_gathered.assign(n, 0);
+
+    gathered_params = params;
+    steps_since_rebuild = 0;
+    valid = true;
+}
+
+
+void CachedNeighborSearch::gather(const std::vector<Boid>& boids, const SimulationParams& gathered, int boid_index) {
+    list_gathered[boid_index] = 1;
+    if (!anchor_alive[boid_index]) {
+        candidates[boid_index].clear();
+        return;
+    }
+    candidates[boid_index] = std::move(std::get<0>(source->get_neighbors(boids, boid_index, gathered)));
+}
+
+
+void CachedNeighborSearch::build(const std::vector<Boid>& boids, SimulationParams params) {
+    reused = can_reuse(boids, params);
+    if (reused) {
+        steps_since_rebuild++;
+        return;
+    }
+
+    gather_pending = false;
+    const SimulationParams gathered = gather_params(params);
+    source->set_alive_mask(alive_mask);
+    source->build(boids, gathered);
+    rebuild(boids, params);
+    const int n = static_cast<int>(boids.size());
+    #pragma omp parallel for schedule(dynamic, 64) if(params.parallelism_enabled)
+    for (int i = 0; i < n; i++) {
+        gather(boids, gathered, i);
+    }
+}
+
+
+std::tuple<std::vector<int>, long long> CachedNeighborSearch::get_neighbors(const std::vector<Boid>& boids, int boid_index, SimulationParams params) {
+    // (first query of a block build rebuild: the wrapped search's blocks this boid reads are built by now)
+    if (gather_pending) gather(boids, gather_params(params), boid_index);
+    const Boid& boid = boids[boid_index];
+    const std::vector<int>& list = candidates[boid_index];
+    std::vector<int> neighbors;
+    neighbors.reserve(list.size());
+
+    for (int j : list) {
+        if (!is_alive(j)) continue;
+        float dx = boids[j].x - boid.x;
+        float dy = boids[j].y - boid.y;
+        if (params.periodic_boundaries) {
+            dx = minimum_image_length(dx, params.world_width);
+            dy = minimum_image_length(dy, params.world_height);
+        }
+        if (dx*dx + dy*dy <= params.perception_radius_sq) neighbors.push_back(j);
+    }
+    return {neighbors, static_cast<long long>(list.size())};
+}
+
+
+// ================= BLOCK BUILD =================
+
+int CachedNeighborSearch::begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) {
+    const int n = static_cast<int>(boids.size());
+    reused = can_reuse(boids, params);
+    gather_pending = !reused;
+    if (reused) {
+        // same block count as the rebuild (index ranges), nothing to build
+        steps_since_rebuild++;
+        block_size = std::max(1, (n + blocks - 1) / blocks);
+        return blocks;
+    }
+
+    const SimulationParams gathered = gather_params(params);
+    source->set_alive_mask(alive_mask);
+    blocks = std::max(1, source->begin_block_build(boids, gathered, max_blocks));
+    reach = source->block_reach(gathered);
+    rebuild(boids, params);
+    return blocks;
+}
+
+
+int CachedNeighborSearch::block_of(int boid_index, const Boid& boid) const {
+    return gather_pending ? source->block_of(boid_index, boid) : std::min(blocks - 1, boid_index / block_size);
+}
+
+
+void CachedNeighborSearch::build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) {
+    if (gather_pending) source->build_block(boids, gather_params(params), block, members);
+}
+
+
+int CachedNeighborSearch::block_reach(SimulationParams params) const {
+    // (reused steps keep the rebuild's reach too, so the graph isn't rebuilt every time the mode changes)
+    return reach;
+}
@@ -0,0 +1,72 @@
+/*
+Cached Neighbor Search (candidate lists reused across steps)
+- wraps another (radius based) search. a rebuild asks that search for every boid within
+  perception radius + skin and keeps the lists, the steps after that only filter their boid's list by
+  the real radius, without building or querying anything
+- the lists stay complete as long as no boid moved more than half the skin since the rebuild (two boids
+  closing in on each other can then have closed at most one skin), so build() checks every boid's
+  displacement and only rebuilds once one of them moved too far (or after candidate_cache_max_steps)
+- the wrapped search is built with the radius grown by the skin and, for the grid, cells at least that
+  big, so its 3x3 stencil still covers the bigger radius. it always gathers across the wrap (boids wrap
+  around the edges even without periodic boundaries), get_neighbors applies the real boundaries
+- boid slots must not be moved between builds without calling invalidate() (SimulationState::compact)
+- neighbors come out in the order of the cached list, not the order a fresh search would give, so sums
+  can differ from the uncached search in the last bits
+*/
+
+
+#pragma once
+#include "neighbor_search.hpp"
+#include <cmath>
+using namespace std;
+
+
+class CachedNeighborSearch : public NeighborSearch {
+    public:
+        // the search used for rebuilds (changing it drops the cache)
+        void set_source(NeighborSearch* search);
+        NeighborSearch* get_source() const { return source; }
+        // next build() gathers the lists again
+        void invalidate() { valid = false; }
+        // whether the last build() reused the lists of an earlier one
+        bool last_build_reused() const { return reused; }
+
+        void build(const std::vector<Boid>& boids, SimulationParams params) override;
+        std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids,
+                                                              int boid_index,
+                                                              SimulationParams params) override;
+
+        // the check runs in begin_block_build. a rebuild is forwarded to the wrapped search's own block build
+        // (its blocks, its reach), and every boid's list is then gathered by its first get_neighbors, which
+        // the graph only runs once the blocks it reads are built. reused steps keep the same number of
+        // blocks (ranges of boid indices, nothing to build) so the graph's shape doesn't change
+        int begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) override;
+        int block_of(int boid_index, const Boid& boid) const override;
+        void build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) override;
+        int block_reach(SimulationParams params) const override;
+
+    private:
+        NeighborSearch* source = nullptr;
+        bool valid = false;
+        bool reused = false;
+        bool gather_pending = false;                // begin_block_build rebuilt, get_neighbors gathers the lists
+        int steps_since_rebuild = 0;
+        int block_size = 1;
+        int blocks = 1;                             // block count / reach of the wrapped search at the last rebuild
+        int reach = 0;
+
+        // what the lists were gathered with
+        SimulationParams gathered_params;           // (radius, cell size and world of the last rebuild)
+        std::vector<Boid> anchors;                  // positions at the last rebuild
+        std::vector<unsigned char> anchor_alive;
+        std::vector<std::vector<int>> candidates;   // per boid, everyone within radius + skin at the last rebuild
+        std::vector<unsigned char> list_gathered;   // per boid, whether its list was gathered since the last rebuild
+                                                    // (a boid the LOD scheduler skipped during a block build rebuild wasn't)
+
+        bool can_reuse(const std::vector<Boid>& boids, const SimulationParams& params) const;
+        // params for the wrapped search (radius + skin, cells at least that big)
+        SimulationParams gather_params(const SimulationParams& params) const;
+        // remembers the anchors (the wrapped search is built and the lists gathered separately)
+        void rebuild(const std::vector<Boid>& boids, const SimulationParams& params);
+        void gather(const std::vector<Boid>& boids, const SimulationParams& gathered, int boid_index);
+};
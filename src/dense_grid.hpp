@@ -0,0 +1,127 @@
+/*
+dense uniform grid for D dimensions (used by the dimension generic FlockSimulation)
+- the world box is split into cells of GRID_CELL_SIZE, every cell exists (no hashing), boids are
+  bucketed with a counting sort into one flat index array (cell_start / cell_boids)
+- queries visit the 3^D cells around the boid's cell: 9 cells in 2D, 27 cells in 3D
+- like GridNeighborSearch the stencil stops at the world edges, unless params.periodic_boundaries: then 
+  a whole number of (slightly bigger) cells covers every axis and the stencil wraps around. the visitor 
+  only gets the index, so distances across the wrap are up to the caller (minimum_image)
+*/
+
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "flock_kernels.hpp"
+using namespace std;
+
+
+template <int D>
+class DenseGrid {
+    public:
+        typedef typename BoidTraits<D>::type BoidType;
+
+        void build(const std::vector<BoidType>& boids, const SimulationParams& params) {
+            typedef BoidTraits<D> T;
+            build(static_cast<int>(boids.size()), [&](int i, int axis) { return T::position(boids[i], axis); }, params);
+        }
+
+        // same as above for any boid storage, position_of(i, axis) returns boid i's position as a float
+        template <typename PositionOf>
+        void build(int n, PositionOf&& position_of, const SimulationParams& params) {
+            periodic = params.periodic_boundaries;
+            num_cells = 1;
+            for (int a = 0; a < D; a++) {
+                float extent = world_extent(params, a);
+                if (periodic) {
+                    dims[a] = std::max(1, static_cast<int>(extent * params.inv_grid_cell_size));
+                    inv_cell_size[a] = dims[a] / extent;
+                    // fewer than 3 cells: -1 and +1 would be the same cell (or this one), only walk the distinct ones
+                    offset_min[a] = dims[a] >= 3 ? -1 : 0;
+                    offset_max[a] = dims[a] >= 2 ? 1 : 0;
+                } else {
+                    dims[a] = std::max(1, static_cast<int>(std::ceil(extent * params.inv_grid_cell_size)));
+                    inv_cell_size[a] = params.inv_grid_cell_size;
+                    offset_min[a] = -1;
+                    offset_max[a] = 1;
+                }
+                stride[a] = num_cells;
+                num_cells *= dims[a];
+            }
+
+            // counting sort: count per cell, prefix sum, scatter
+            boid_cells.resize(n);
+            cell_start.assign(num_cells + 1, 0);
+            for (int i = 0; i < n; i++) {
+                int cell = 0;
+                for (int a = 0; a < D; a++) cell += cell_coordinate(position_of(i, a), a) * stride[a];
+                boid_cells[i] = cell;
+                cell_start[cell + 1]++;
+            }
+            for (int c = 0; c < num_cells; c++) cell_start[c + 1] += cell_start[c];
+            cell_boids.resize(n);
+            std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+            for (int i = 0; i < n; i++) cell_boids[fill[boid_cells[i]]++] = i;
+        }
+
+        // calls visit(j) for every boid j (other than boid_index) in the 3^D cells around boid_index,
+        // returns the number of candidates visited
+        template <typename Visitor>
+        long long for_each_candidate(int boid_index, Visitor&& visit) const {
+            int home[D];
+            int cell = boid_cells[boid_index];
+            for (int a = D - 1; a >= 0; a--) {
+                home[a] = cell / stride[a];
+                cell -= home[a] * stride[a];
+            }
+
+            long long candidates = 0;
+            int offset[D];
+            for (int a = 0; a < D; a++) offset[a] = offset_min[a];
+            // odometer over the 3^D offsets
+            while (true) {
+                int neighbor_cell = 0;
+                bool inside = true;
+                for (int a = 0; a < D; a++) {
+                    int coordinate = home[a] + offset[a];
+                    if (periodic) {
+                        coordinate += (coordinate < 0) ? dims[a] : (coordinate >= dims[a] ? -dims[a] : 0);
+                    } else if (coordinate < 0 || coordinate >= dims[a]) {
+                        inside = false;
+                        break;
+                    }
+                    neighbor_cell += coordinate * stride[a];
+                }
+                if (inside) {
+                    for (int k = cell_start[neighbor_cell]; k < cell_start[neighbor_cell + 1]; k++) {
+                        int j = cell_boids[k];
+                        if (j == boid_index) continue;
+                        candidates++;
+                        visit(j);
+                    }
+                }
+
+                int a = 0;
+                while (a < D && offset[a] == offset_max[a]) { offset[a] = offset_min[a]; a++; }
+                if (a == D) break;
+                offset[a]++;
+            }
+            return candidates;
+        }
+
+    private:
+        bool periodic = false;
+        float inv_cell_size[D];
+        int offset_min[D], offset_max[D];       // stencil range per axis (narrower on tiny periodic axes)
+        int dims[D];
+        int stride[D];
+        int num_cells = 0;
+        std::vector<int> cell_start;    // boids of cell c are cell_boids[cell_start[c] .. cell_start[c + 1])
+        std::vector<int> cell_boids;
+        std::vector<int> boid_cells;    // cell of every boid
+
+        int cell_coordinate(float position, int axis) const {
+            int coordinate = static_cast<int>(position * inv_cell_size[axis]);
+            return std::min(dims[axis] - 1, std::max(0, coordinate));
+        }
+};
@@ -0,0 +1,148 @@
+/*
+dimension generic flocking kernels
+- BoidTraits<D> maps a dimension onto its boid layout (Boid for 2D, Boid3 for 3D) and gives per-axis
+  access to position / velocity. the axis is always a compile-time constant after the loops over D are
+  unrolled, so BoidTraits<2> compiles down to plain .x / .y accesses
+- the kernels do the exact same float operations in the exact same order as the original hand written
+  2D code, so Simulation::update_void (D = 2) produces bit-identical results with them
+*/
+
+
+#pragma once
+#include <cmath>
+#include "boid.hpp"
+#include "simulation_params.hpp"
+
+
+template <int D> struct BoidTraits;
+
+template <> struct BoidTraits<2> {
+    typedef Boid type;
+    static float& position(Boid& boid, int axis) { return axis == 0 ? boid.x : boid.y; }
+    static float position(const Boid& boid, int axis) { return axis == 0 ? boid.x : boid.y; }
+    static float& velocity(Boid& boid, int axis) { return axis == 0 ? boid.vx : boid.vy; }
+    static float velocity(const Boid& boid, int axis) { return axis == 0 ? boid.vx : boid.vy; }
+};
+
+template <> struct BoidTraits<3> {
+    typedef Boid3 type;
+    static float& position(Boid3& boid, int axis) { return axis == 0 ? boid.x : (axis == 1 ? boid.y : boid.z); }
+    static float position(const Boid3& boid, int axis) { return axis == 0 ? boid.x : (axis == 1 ? boid.y : boid.z); }
+    static float& velocity(Boid3& boid, int axis) { return axis == 0 ? boid.vx : (axis == 1 ? boid.vy : boid.vz); }
+    static float velocity(const Boid3& boid, int axis) { return axis == 0 ? boid.vx : (axis == 1 ? boid.vy : boid.vz); }
+};
+
+// size of the (wrapping) world along one axis
+inline float world_extent(const SimulationParams& params, int axis) {
+    return axis == 0 ? params.world_width : (axis == 1 ? params.world_height : params.world_depth);
+}
+
+
+// shortest offset along a wrapping axis (minimum image). positions are always inside the world, so 
+// |delta| < extent and one correction is enough. the comparisons turn into masks, no branches
+inline float minimum_image(float delta, float extent) {
+    float half = extent * 0.5f;
+    return delta - extent * static_cast<float>((delta > half) - (delta < -half));
+}
+
+// length of the minimum image offset, cheaper when only the distance is needed (abs, sub, min)
+inline float minimum_image_length(float delta, float extent) {
+    float length = std::fabs(delta);
+    float other_way = extent - length;
+    return other_way < length ? other_way : length;
+}
+
+
+// summed up neighbor terms (the D dimensional version of NeighborSums)
+template <int D>
+struct FlockSums {
+    float align[D];     // sum of neighbor velocities
+    float coh[D];       // sum of neighbor positions
+    float sep[D];       // sum of inverse-square separation pushes
+
+    FlockSums() {
+        for (int a = 0; a < D; a++) align[a] = coh[a] = sep[a] = 0.0f;
+    }
+};
+
+
+// adds one neighbor into the sums. PERIODIC: the neighbor may be on the other side of the wrap, its 
+// image closest to the boid is used (for the cohesion position as well as the separation push)
+template <int D, bool PERIODIC = false>
+inline void accumulate_neighbor(FlockSums<D>& sums, const typename BoidTraits<D>::type& boid, const typename BoidTraits<D>::type& neighbor,
+                                const SimulationParams* params = nullptr) {
+    typedef BoidTraits<D> T;
+    float delta[D];
+    float distance_sq = 0.0f;
+    for (int a = 0; a < D; a++) {
+        sums.align[a] += T::velocity(neighbor, a);     // alignment
+        if constexpr (PERIODIC) {
+            delta[a] = minimum_image(T::position(boid, a) - T::position(neighbor, a), world_extent(*params, a));
+            sums.coh[a] += T::position(boid, a) - delta[a];  // cohesion (towards the closest image)
+        } else {
+            sums.coh[a] += T::position(neighbor, a);   // cohesion
+            delta[a] = T::position(boid, a) - T::position(neighbor, a);
+        }
+        distance_sq += delta[a] * delta[a];
+    }
+    // inverse square separation (stronger repulsion when closer), clamped to prevent division by zero
+    if (distance_sq < 0.0001f) distance_sq = 0.0001f;
+    for (int a = 0; a < D; a++) {
+        sums.sep[a] += delta[a] / distance_sq;
+    }
+}
+
+// turns the sums into a steering vector (zero without neighbors)
+template <int D>
+inline void flock_steering(const FlockSums<D>& sums, long long neighbor_count, const typename BoidTraits<D>::type& boid, 
+                           const SimulationParams& params, float steer[D]) {
+    typedef BoidTraits<D> T;
+    for (int a = 0; a < D; a++) steer[a] = 0.0f;
+    if (neighbor_count <= 0) return;
+
+    int num_neighbors = static_cast<int>(neighbor_count);
+    for (int a = 0; a < D; a++) {
+        // average velocity of the neighbors, and the direction to their average position
+        float align = sums.align[a] / num_neighbors;
+        float coh = sums.coh[a] / num_neighbors;
+        coh -= T::position(boid, a);
+
+        steer[a] += (align - T::velocity(boid, a)) * params.alignment_weight;
+        steer[a] += coh * params.cohesion_weight;
+        steer[a] += sums.sep[a] * params.separation_weight;
+    }
+}
+
+template <int D>
+inline void limit_speed(typename BoidTraits<D>::type& boid, const SimulationParams& params) {
+    typedef BoidTraits<D> T;
+    float speed_sq = 0.0f;
+    for (int a = 0; a < D; a++) speed_sq += T::velocity(boid, a) * T::velocity(boid, a);
+    if (speed_sq > params.max_speed_sq) { // only take the sqrt when we actually have to clamp
+        float speed = std::sqrt(speed_sq);
+        for (int a = 0; a < D; a++) T::velocity(boid, a) = (T::velocity(boid, a) / speed) * params.max_speed;
+    }
+}
+
+template <int D>
+inline void wrap_position(typename BoidTraits<D>::type& boid, const SimulationParams& params) {
+    typedef BoidTraits<D> T;
+    for (int a = 0; a < D; a++) {
+        float extent = world_extent(params, a);
+        if (T::position(boid, a) < 0) T::position(boid, a) += extent;
+        if (T::position(boid, a) >= extent) T::position(boid, a) -= extent;
+    }
+}
+
+// new velocity = old velocity + steering (speed limited), then move and wrap around the world
+// (steering is per step, steer_scale shrinks it for steps shorter than the fixed step. it is 1 otherwise, 
+//  which leaves the result bit for bit the same)
+template <int D>
+inline void integrate(typename BoidTraits<D>::type& new_boid, const typename BoidTraits<D>::type& boid, const float steer[D], 
+                      float dt, const SimulationParams& params) {
+    typedef BoidTraits<D> T;
+    for (int a = 0; a < D; a++) T::velocity(new_boid, a) = T::velocity(boid, a) + steer[a] * params.steer_scale;
+    limit_speed<D>(new_boid, params);
+    for (int a = 0; a < D; a++) T::position(new_boid, a) = T::position(boid, a) + T::velocity(new_boid, a) * dt;
+    wrap_position<D>(new_boid, params);
+}
@@ -0,0 +1,136 @@
+/*
+dimension generic headless simulation (FlockSimulation<2> / FlockSimulation<3>)
+- same steering model as Simulation (the kernels from flock_kernels.hpp) with a DenseGrid<D> metric
+  neighbor search: 9 cell stencil in 2D, 27 cell stencil in 3D (wrapping with periodic boundaries)
+- no renderer, LOD, obstacles or alternative searches, this is what the batch runner uses for 3D runs
+  (the interactive 2D program keeps using Simulation)
+- touches no globals, every instance owns its boids, grid and scratch buffers
+- Storage decides how the boids are kept in memory: FloatStorage<D> (default) or PackedStorage<D> 
+  (16-bit fixed point, see packed_boid.hpp). boids are decoded to floats in registers, the kernels 
+  are the same for both
+*/
+
+
+#pragma once
+#include <omp.h>
+#include <type_traits>
+#include <vector>
+#include "dense_grid.hpp"
+#include "flock_kernels.hpp"
+#include "packed_boid.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+#include "timing.hpp"
+using namespace std;
+
+
+template <int D, typename Storage = FloatStorage<D>>
+class FlockSimulation {
+    public:
+        typedef typename BoidTraits<D>::type BoidType;
+        typedef typename Storage::stored_type StoredBoid;
+        typedef typename Storage::Codec Codec;
+
+        std::vector<StoredBoid> boids;
+
+        // adds a boid given in floats (encoded for the packed storage)
+        void add_boid(const BoidType& boid, const SimulationParams& params) {
+            boids.push_back(Codec(params).encode(boid));
+        }
+
+        // the boids as floats (for metrics / snapshots). float storage hands back the boids themselves, 
+        // packed storage decodes them into a scratch buffer that stays valid until the next call
+        const std::vector<BoidType>& float_boids(const SimulationParams& params) {
+            if constexpr (std::is_same<StoredBoid, BoidType>::value) {
+                return boids;
+            } else {
+                const Codec codec(params);
+                decoded.resize(boids.size());
+                for (size_t i = 0; i < boids.size(); i++) decoded[i] = codec.decode(boids[i]);
+                return decoded;
+            }
+        }
+
+        void step(float dt, const SimulationParams& params, SimulationStats& stats) {
+            const Codec codec(params);
+
+            // ================= BUILD GRID =================
+            double build_start = steady_now_ms();
+            grid.build(static_cast<int>(boids.size()), [&](int i, int axis) { return codec.position(boids[i], axis); }, params);
+            double build_end = steady_now_ms();
+            stats.grid_map_hash_time_ms = static_cast<float>(build_end - build_start);
+
+            // ================= NEIGHBORS + STEERING =================
+            int n = static_cast<int>(boids.size());
+            next.resize(n);
+            long long total_checked_candidates = 0;
+            long long total_neighbors_found = 0;
+            stats.num_threads = params.parallelism_enabled ? omp_get_max_threads() : 1;
+
+            double update_start = steady_now_ms();
+            // (periodic or not is decided once here, not per candidate)
+            if (params.periodic_boundaries) {
+                steer_all<true>(dt, params, total_checked_candidates, total_neighbors_found);
+            } else {
+                steer_all<false>(dt, params, total_checked_candidates, total_neighbors_found);
+            }
+            double update_end = steady_now_ms();
+            boids.swap(next);
+
+            // ================= STATS =================
+            stats.get_neighbors_calc_time_ms = static_cast<float>(update_end - update_start);
+            stats.update_time_ms = stats.grid_map_hash_time_ms + stats.get_neighbors_calc_time_ms;
+            stats.total_checked_candidates = static_cast<int>(total_checked_candidates);
+            stats.total_neighbors_found = static_cast<int>(total_neighbors_found);
+            float count = std::max(1.0f, static_cast<float>(n));
+            stats.avg_checked_neighbors = static_cast<float>(total_checked_candidates) / count;
+            stats.avg_neighbors = static_cast<float>(total_neighbors_found) / count;
+        }
+
+        const DenseGrid<D>& get_grid() const { return grid; }
+
+    private:
+        // PERIODIC: neighbors across the wrap are found by the grid, distances / sums use the closest image
+        template <bool PERIODIC>
+        void steer_all(float dt, const SimulationParams& params, long long& total_checked_candidates, long long& total_neighbors_found) {
+            typedef BoidTraits<D> T;
+            int n = static_cast<int>(boids.size());
+            const float perception_radius_sq = params.perception_radius_sq;
+            long long checked = 0, found = 0;
+
+            const Codec codec(params);
+
+            #pragma omp parallel for schedule(dynamic, 64) reduction(+:checked) reduction(+:found) if(params.parallelism_enabled)
+            for (int i = 0; i < n; i++) {
+                // (a reference for float storage, a decoded copy for packed storage)
+                const BoidType& boid = codec.decode(boids[i]);
+                FlockSums<D> sums;
+                long long neighbor_count = 0;
+                checked += grid.for_each_candidate(i, [&](int j) {
+                    float distance_sq = 0.0f;
+                    for (int a = 0; a < D; a++) {
+                        float delta = codec.position(boids[j], a) - T::position(boid, a);
+                        if constexpr (PERIODIC) delta = minimum_image_length(delta, world_extent(params, a));
+                        distance_sq += delta * delta;
+                    }
+                    if (distance_sq <= perception_radius_sq) {
+                        accumulate_neighbor<D, PERIODIC>(sums, boid, codec.decode(boids[j]), &params);
+                        neighbor_count++;
+                    }
+                });
+                found += neighbor_count;
+
+                float steer[D];
+                flock_steering<D>(sums, neighbor_count, boid, params, steer);
+                BoidType result;
+                integrate<D>(result, boid, steer, dt, params);
+                next[i] = codec.encode(result);
+            }
+            total_checked_candidates += checked;
+            total_neighbors_found += found;
+        }
+
+        DenseGrid<D> grid;
+        std::vector<StoredBoid> next;   // positions / velocities being written this step
+        std::vector<BoidType> decoded;  // float_boids() scratch (packed storage only)
+};
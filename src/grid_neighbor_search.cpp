@@ -1,28 +1,120 @@
 #include "grid_neighbor_search.hpp"
 #include "simulation_stats.hpp"
 #include <cmath>
+#include <algorithm>
 
-void GridNeighborSearch::build(const std::vector<Boid>& boids) {
+void GridNeighborSearch::build(const std::vector<Boid>& boids, SimulationParams params) {
     // this function will calculate which boids are in which grid cells
     // returns a mapping from cell coordinates to list of boid indices in that cell
-    grid.clear();
+    set_geometry(params);
+    bands.resize(1);
+    GridBand& band = bands[0];
+    band.cells.clear();
 
     for (int i = 0; i < boids.size(); i++) {
-        int grid_cell_xpos = static_cast<int>(boids[i].x / simulation_config.GRID_CELL_SIZE);
-        int grid_cell_ypos = static_cast<int>(boids[i].y / simulation_config.GRID_CELL_SIZE);
-        long long cell_hash = hash_cell(grid_cell_xpos, grid_cell_ypos);
-        grid[cell_hash].push_back(i);
+        // dead pool slots never go into the grid, so every query below only ever sees live boids
+        if (!is_alive(i)) continue;
+        insert_boid(band, boids, i);
+    }
+
+    // ================= CELL AGGREGATES (far-field only) =================
+    band.aggregates.clear();
+    if (params.far_field_enabled) {
+        build_aggregates(band, boids);
+    }
+}
+
+
+void GridNeighborSearch::set_geometry(const SimulationParams& params) {
+    periodic = params.periodic_boundaries;
+    if (periodic) {
+        // a whole number of (slightly bigger) cells per axis, so the last cell meets the first one at the wrap
+        world_width = params.world_width;
+        world_height = params.world_height;
+        columns = std::max(1, static_cast<int>(world_width * params.inv_grid_cell_size));
+        rows = std::max(1, static_cast<int>(world_height * params.inv_grid_cell_size));
+        cell_width = world_width / columns;
+        cell_height = world_height / rows;
+        inv_cell_width = columns / world_width;
+        inv_cell_height = rows / world_height;
+    } else {
+        cell_width = cell_height = params.grid_cell_size;
+        inv_cell_width = inv_cell_height = params.inv_grid_cell_size;
+    }
+}
+
+
+void GridNeighborSearch::insert_boid(GridBand& band, const std::vector<Boid>& boids, int index) {
+    int grid_cell_xpos = cell_column(boids[index].x);
+    int grid_cell_ypos = cell_row(boids[index].y);
+    long long cell_hash = hash_cell(grid_cell_xpos, grid_cell_ypos);
+    band.cells[cell_hash].push_back(index);
+}
+
+
+void GridNeighborSearch::build_aggregates(GridBand& band, const std::vector<Boid>& boids) {
+    for (const auto& cell : band.cells) {
+        CellAggregate& aggregate = band.aggregates[cell.first];
+        aggregate.count = static_cast<int>(cell.second.size());
+        for (int boid_index : cell.second) {
+            const Boid& boid = boids[boid_index];
+            aggregate.sum_x += boid.x;
+            aggregate.sum_y += boid.y;
+            aggregate.sum_vx += boid.vx;
+            aggregate.sum_vy += boid.vy;
+        }
+    }
+}
+
+
+// ================= BLOCK BUILD =================
+// blocks are bands of rows_per_band cell rows, every band is its own cell map so they can be filled at 
+// the same time. a band's members come in index order, so every cell lists its boids in the same order 
+// as a single threaded build()
+int GridNeighborSearch::begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) {
+    set_geometry(params);
+    int total_rows = periodic ? rows : static_cast<int>(params.world_height * inv_cell_height) + 1;
+    rows_per_band = std::max(1, (total_rows + std::max(1, max_blocks) - 1) / std::max(1, max_blocks));
+    int num_bands = (total_rows + rows_per_band - 1) / rows_per_band;
+    bands.resize(num_bands);
+    return num_bands;
+}
+
+
+int GridNeighborSearch::block_of(int boid_index, const Boid& boid) const {
+    return band_of_row(cell_row(boid.y));
+}
+
+
+void GridNeighborSearch::build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) {
+    GridBand& band = bands[block];
+    band.cells.clear();
+    for (int index : members) insert_boid(band, boids, index);
+
+    band.aggregates.clear();
+    if (params.far_field_enabled) {
+        build_aggregates(band, boids);
     }
 }
 
 
+int GridNeighborSearch::block_reach(SimulationParams params) const {
+    // 3x3 stencil = one row either way, far-field covers the whole radius
+    int reach_rows = 1;
+    if (params.far_field_enabled) {
+        reach_rows = std::max(1, static_cast<int>(std::ceil(params.perception_radius * inv_cell_height)));
+    }
+    return (reach_rows + rows_per_band - 1) / rows_per_band;
+}
 
-std::tuple<std::vector<int>, long long> GridNeighborSearch::get_neighbors(const std::vector<Boid>& boids, int index) {
+
+
+std::tuple<std::vector<int>, long long> GridNeighborSearch::get_neighbors(const std::vector<Boid>& boids, int index, SimulationParams params) {
     const Boid& boid = boids[index];
 
-    float perception_radius_sq = simulation_config.PERCEPTION_RADIUS * simulation_config.PERCEPTION_RADIUS;
-    int target_grid_cell_xpos = static_cast<int>(boids[index].x / simulation_config.GRID_CELL_SIZE);
-    int target_grid_cell_ypos = static_cast<int>(boids[index].y / simulation_config.GRID_CELL_SIZE);
+    const float perception_radius_sq = params.perception_radius_sq;
+    int target_grid_cell_xpos = cell_column(boids[index].x);
+    int target_grid_cell_ypos = cell_row(boids[index].y);
 
     std::vector<int> neighbors;
 
@@ -32,15 +124,18 @@ std::tuple<std::vector<int>, long long> GridNeighborSearch::get_neighbors(const
     for (int other_grid_cell_Xoffset = -1; other_grid_cell_Xoffset <= 1; other_grid_cell_Xoffset++) {
         for (int other_grid_cell_Yoffset = -1; other_grid_cell_Yoffset <= 1; other_grid_cell_Yoffset++) {
             // get the hash for the neighboring cell (which contains boid indices that are within that cell)
-            long long cell_hash = hash_cell(target_grid_cell_xpos + other_grid_cell_Xoffset,
-                                               target_grid_cell_ypos + other_grid_cell_Yoffset);
-        
-            if (grid.count(cell_hash) == 0) {
+            // (plus the offset to its ghost image when it is across the wrap, zero otherwise)
+            CellImage cell = image_of_cell(target_grid_cell_xpos + other_grid_cell_Xoffset,
+                                           target_grid_cell_ypos + other_grid_cell_Yoffset);
+            const std::vector<int>* cell_list = find_cell(cell.hash);
+            if (!cell_list) {
                 continue; // no boids in this cell, we can skip it
             }    
             
             // the boids in the cell we are currently checking
-            const auto& cell_boids = grid[cell_hash];
+            const auto& cell_boids = *cell_list;
+            const float query_x = boid.x - cell.shift_x;
+            const float query_y = boid.y - cell.shift_y;
             
             // only iterate through the birds in the cell to check distance
             for (int boid_index_in_cell : cell_boids) {
@@ -50,8 +145,8 @@ std::tuple<std::vector<int>, long long> GridNeighborSearch::get_neighbors(const
                 const Boid& other_boid = boids[boid_index_in_cell];
 
                 // calculate squared distance
-                float dx = other_boid.x - boid.x;
-                float dy = other_boid.y - boid.y;
+                float dx = other_boid.x - query_x;
+                float dy = other_boid.y - query_y;
                 float distance_sq = dx*dx + dy*dy;
 
                 if (distance_sq <= perception_radius_sq) {
@@ -64,3 +159,220 @@ std::tuple<std::vector<int>, long long> GridNeighborSearch::get_neighbors(const
 
 }
 
+
+
+bool GridNeighborSearch::accumulate_neighbor_sums(const std::vector<Boid>& boids, int index, SimulationParams params, NeighborSums& sums) {
+    if (!params.far_field_enabled) {
+        return false;
+    }
+
+    const Boid& boid = boids[index];
+    const float perception_radius_sq = params.perception_radius_sq;
+    int target_grid_cell_xpos = cell_column(boid.x);
+    int target_grid_cell_ypos = cell_row(boid.y);
+
+    // unlike get_neighbors (3x3), cover the whole perception radius however many cells that takes
+    int reach_x = static_cast<int>(std::ceil(params.perception_radius * inv_cell_width));
+    int reach_y = static_cast<int>(std::ceil(params.perception_radius * inv_cell_height));
+
+    for (int other_grid_cell_Xoffset = -reach_x; other_grid_cell_Xoffset <= reach_x; other_grid_cell_Xoffset++) {
+        for (int other_grid_cell_Yoffset = -reach_y; other_grid_cell_Yoffset <= reach_y; other_grid_cell_Yoffset++) {
+            int cell_x = target_grid_cell_xpos + other_grid_cell_Xoffset;
+            int cell_y = target_grid_cell_ypos + other_grid_cell_Yoffset;
+
+            // closest and furthest point of the cell from the boid (where the cell is as seen from the boid, 
+            // possibly a ghost image across the wrap)
+            float cell_left = cell_x * cell_width, cell_right = cell_left + cell_width;
+            float cell_top = cell_y * cell_height, cell_bottom = cell_top + cell_height;
+            float near_dx = std::max(std::max(cell_left - boid.x, boid.x - cell_right), 0.0f);
+            float near_dy = std::max(std::max(cell_top - boid.y, boid.y - cell_bottom), 0.0f);
+            if (near_dx*near_dx + near_dy*near_dy > perception_radius_sq) {
+                continue; // the whole cell is out of range
+            }
+            float far_dx = std::max(boid.x - cell_left, cell_right - boid.x);
+            float far_dy = std::max(boid.y - cell_top, cell_bottom - boid.y);
+            bool fully_inside = (far_dx*far_dx + far_dy*far_dy <= perception_radius_sq);
+            bool near_cell = std::abs(other_grid_cell_Xoffset) <= params.far_field_near_cells &&
+                             std::abs(other_grid_cell_Yoffset) <= params.far_field_near_cells;
+
+            CellImage cell = image_of_cell(cell_x, cell_y);
+
+            // ================= FAR CELL: ADD THE AGGREGATE =================
+            if (fully_inside && !near_cell) {
+                const CellAggregate* aggregate_entry = find_aggregate(cell.hash);
+                if (!aggregate_entry) {
+                    continue; // no boids in this cell
+                }
+                const CellAggregate& aggregate = *aggregate_entry;
+                sums.checked_candidates++;
+                sums.count += aggregate.count;
+                sums.align_x += aggregate.sum_vx;
+                sums.align_y += aggregate.sum_vy;
+                sums.coh_x += aggregate.sum_x + aggregate.count * cell.shift_x;
+                sums.coh_y += aggregate.sum_y + aggregate.count * cell.shift_y;
+
+                // separation from the cell's center of mass (these boids are far away so their push is small anyway)
+                float dx = boid.x - (aggregate.sum_x / aggregate.count + cell.shift_x);
+                float dy = boid.y - (aggregate.sum_y / aggregate.count + cell.shift_y);
+                float distance_sq = dx*dx + dy*dy;
+                if (distance_sq < 0.0001f) distance_sq = 0.0001f; // prevent division by zero
+                sums.sep_x += aggregate.count * dx / distance_sq;
+                sums.sep_y += aggregate.count * dy / distance_sq;
+                continue;
+            }
+
+            // ================= NEAR / BOUNDARY CELL: EXACT =================
+            const std::vector<int>* cell_list = find_cell(cell.hash);
+            if (!cell_list) {
+                continue; // no boids in this cell
+            }
+            for (int boid_index_in_cell : *cell_list) {
+                if (boid_index_in_cell == index) continue; // skip self
+                sums.checked_candidates++;
+
+                const Boid& other_boid = boids[boid_index_in_cell];
+                float other_x = other_boid.x + cell.shift_x;
+                float other_y = other_boid.y + cell.shift_y;
+                float dx = boid.x - other_x;
+                float dy = boid.y - other_y;
+                float distance_sq = dx*dx + dy*dy;
+                if (distance_sq > perception_radius_sq) continue;
+
+                sums.count++;
+                sums.align_x += other_boid.vx;
+                sums.align_y += other_boid.vy;
+                sums.coh_x += other_x;
+                sums.coh_y += other_y;
+                if (distance_sq < 0.0001f) distance_sq = 0.0001f; // prevent division by zero
+                sums.sep_x += dx / distance_sq;
+                sums.sep_y += dy / distance_sq;
+            }
+        }
+    }
+    return true;
+}
+
+
+
+// adds the contribution of one pair (a, b) within the perception radius to both boids' sums
+// (b is seen at b + shift by a, and a at a - shift by b, the shift is only non-zero across the wrap)
+static inline void add_pair(const Boid& a, const Boid& b, float shift_x, float shift_y, float distance_sq, NeighborSums& sums_a, NeighborSums& sums_b) {
+    sums_a.count++;
+    sums_b.count++;
+
+    // alignment / cohesion: each boid sees the other's velocity and position
+    sums_a.align_x += b.vx;  sums_a.align_y += b.vy;
+    sums_b.align_x += a.vx;  sums_b.align_y += a.vy;
+    sums_a.coh_x += b.x + shift_x;   sums_a.coh_y += b.y + shift_y;
+    sums_b.coh_x += a.x - shift_x;   sums_b.coh_y += a.y - shift_y;
+
+    // separation: equal and opposite inverse-square push
+    if (distance_sq < 0.0001f) distance_sq = 0.0001f; // prevent division by zero
+    float push_x = (a.x - (b.x + shift_x)) / distance_sq;
+    float push_y = (a.y - (b.y + shift_y)) / distance_sq;
+    sums_a.sep_x += push_x;  sums_a.sep_y += push_y;
+    sums_b.sep_x -= push_x;  sums_b.sep_y -= push_y;
+}
+
+
+bool GridNeighborSearch::accumulate_all_neighbor_sums(const std::vector<Boid>& boids, SimulationParams params, std::vector<NeighborSums>& sums) {
+    if (!params.symmetric_pairs_enabled) {
+        return false;
+    }
+
+    sums.assign(boids.size(), NeighborSums());
+    const float perception_radius_sq = params.perception_radius_sq;
+
+    // ================= CELL COLORING =================
+    /* 
+    the half stencil of cell (x, y) is itself plus (x+1, y), (x-1, y+1), (x, y+1), (x+1, y+1), so a cell 
+    only ever writes to boids in columns x-1..x+1 and rows y..y+1. cells with the same (x mod 3, y mod 2) 
+    can therefore never write to the same boid and run in parallel without atomics, the 6 colors run 
+    one after the other. 
+    with periodic boundaries the columns / rows wrap, so the ones left over after the last full group 
+    of 3 columns (2 rows) each get a color class of their own (at most 5 x 3 = 15 colors)
+    */
+    int column_classes = 3, row_classes = 2;
+    int full_columns = 0, full_rows = 0;
+    if (periodic) {
+        full_columns = columns - columns % 3;
+        full_rows = rows - rows % 2;
+        column_classes = 3 + columns % 3;
+        row_classes = 2 + rows % 2;
+    }
+    auto column_class = [&](int x) { return (!periodic || x < full_columns) ? ((x % 3) + 3) % 3 : 3 + (x - full_columns); };
+    auto row_class = [&](int y) { return (!periodic || y < full_rows) ? ((y % 2) + 2) % 2 : 2 + (y - full_rows); };
+
+    const int num_colors = column_classes * row_classes;
+    std::vector<std::vector<std::pair<int, int>>> colored_cells(num_colors);
+    for (const GridBand& band : bands) {
+        for (const auto& cell : band.cells) {
+            int cell_x = static_cast<int>(cell.first >> 32);
+            int cell_y = static_cast<int>(static_cast<unsigned int>(cell.first & 0xffffffffLL));
+            int color = column_class(cell_x) * row_classes + row_class(cell_y);
+            colored_cells[color].push_back({cell_x, cell_y});
+        }
+    }
+
+    // forward half of the 3x3 stencil (the other half is covered when those cells visit this one)
+    const int forward_offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    #pragma omp parallel if(params.parallelism_enabled)
+    {
+        for (int color = 0; color < num_colors; color++) {
+            const std::vector<std::pair<int, int>>& cells = colored_cells[color];
+
+            // (implicit barrier at the end of each color)
+            #pragma omp for schedule(dynamic, 8)
+            for (int c = 0; c < static_cast<int>(cells.size()); c++) {
+                int cell_x = cells[c].first;
+                int cell_y = cells[c].second;
+                const std::vector<int>& cell_boids = *find_cell(hash_cell(cell_x, cell_y));
+
+                // pairs inside the cell itself (a < b so each one is visited once)
+                for (size_t a = 0; a < cell_boids.size(); a++) {
+                    int index_a = cell_boids[a];
+                    const Boid& boid_a = boids[index_a];
+                    for (size_t b = a + 1; b < cell_boids.size(); b++) {
+                        int index_b = cell_boids[b];
+                        const Boid& boid_b = boids[index_b];
+                        sums[index_a].checked_candidates++;
+
+                        float dx = boid_a.x - boid_b.x;
+                        float dy = boid_a.y - boid_b.y;
+                        float distance_sq = dx*dx + dy*dy;
+                        if (distance_sq <= perception_radius_sq) {
+                            add_pair(boid_a, boid_b, 0.0f, 0.0f, distance_sq, sums[index_a], sums[index_b]);
+                        }
+                    }
+                }
+
+                // pairs with the forward neighbor cells (ghost images across the wrap when periodic)
+                for (const auto& offset : forward_offsets) {
+                    CellImage other = image_of_cell(cell_x + offset[0], cell_y + offset[1]);
+                    const std::vector<int>* other_cell = find_cell(other.hash);
+                    if (!other_cell) {
+                        continue; // no boids in this cell
+                    }
+                    for (int index_a : cell_boids) {
+                        const Boid& boid_a = boids[index_a];
+                        const float query_x = boid_a.x - other.shift_x;
+                        const float query_y = boid_a.y - other.shift_y;
+                        for (int index_b : *other_cell) {
+                            const Boid& boid_b = boids[index_b];
+                            sums[index_a].checked_candidates++;
+
+                            float dx = query_x - boid_b.x;
+                            float dy = query_y - boid_b.y;
+                            float distance_sq = dx*dx + dy*dy;
+                            if (distance_sq <= perception_radius_sq) {
+                                add_pair(boid_a, boid_b, other.shift_x, other.shift_y, distance_sq, sums[index_a], sums[index_b]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
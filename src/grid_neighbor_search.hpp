@@ -3,6 +3,13 @@ Grid Neighbor Search
 - Performance: ???? (I think O(N log N) ?)
 - Checks and compares distance from one boid to every other boid in it's own grid cell 
 and the neighboring grid cells in the simulation 
+- periodic boundaries: the cell size is stretched a little so a whole number of cells covers the world, 
+then cells past the edge wrap around to the other side. every cell visited across the wrap comes with the 
+offset (+-world size) that moves its boids next to the query boid (a ghost copy of the cell that is never 
+stored), added once per candidate like a zero offset everywhere else, so edge boids cost the same as 
+interior ones
+- cells are kept in horizontal bands of cell rows (a single band unless the task graph executor builds 
+it band by band, see begin_block_build), a cell is looked up in the band its row belongs to
 */
 
 
@@ -11,6 +18,7 @@ and the neighboring grid cells in the simulation
 #include "simulation_config.hpp"
 #include <unordered_map>
 #include <cmath>
+#include <algorithm>
 using namespace std;
 
 
@@ -20,14 +28,89 @@ class GridNeighborSearch : public NeighborSearch {
     public:
         
         // handles building the grid data before neighbors can be queried
-        void build(const std::vector<Boid>& boids) override;
-        std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids, int index) override;
+        void build(const std::vector<Boid>& boids, SimulationParams params) override;
+        std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids, int index, SimulationParams params) override;
 
-    private:
-        std::unordered_map<long long, std::vector<int>> grid; 
-        // map from cell hash to list of boid indices
+        // far-field approximation (only when params.far_field_enabled): cells fully inside the perception 
+        // radius add their aggregates in O(1), cells near the boid or on the edge of the radius are scanned exactly
+        bool accumulate_neighbor_sums(const std::vector<Boid>& boids, int index, SimulationParams params, NeighborSums& sums) override;
+
+        // symmetric pair traversal (only when params.symmetric_pairs_enabled): every pair of boids is tested 
+        // once (half stencil) and both boids' sums are updated from that one test
+        bool accumulate_all_neighbor_sums(const std::vector<Boid>& boids, SimulationParams params, std::vector<NeighborSums>& sums) override;
+
+        // blocks are bands of cell rows, a query reads the rows its stencil covers
+        int begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) override;
+        int block_of(int boid_index, const Boid& boid) const override;
+        void build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) override;
+        int block_reach(SimulationParams params) const override;
+
+    protected:
+        // per cell totals, only filled in when the far-field approximation is enabled
+        struct CellAggregate {
+            int count = 0;
+            float sum_x = 0.0f, sum_y = 0.0f;       // position sum
+            float sum_vx = 0.0f, sum_vy = 0.0f;     // velocity sum
+        };
+
+        struct GridBand {
+            std::unordered_map<long long, std::vector<int>> cells;         // map from cell hash to list of boid indices
+            std::unordered_map<long long, CellAggregate> aggregates;       // far-field only
+        };
+        std::vector<GridBand> bands;
+        int rows_per_band = 1;                      // (only used with more than one band)
+
+        // cell geometry of the last build (the requested cell size unless periodic)
+        bool periodic = false;
+        int columns = 0, rows = 0;                  // cells covering the world (periodic only)
+        float cell_width = 1.0f, cell_height = 1.0f;
+        float inv_cell_width = 1.0f, inv_cell_height = 1.0f;
+        float world_width = 0.0f, world_height = 0.0f;
+
+        void set_geometry(const SimulationParams& params);
+        void insert_boid(GridBand& band, const std::vector<Boid>& boids, int index);
+        void build_aggregates(GridBand& band, const std::vector<Boid>& boids);
+
+        int band_of_row(int gy) const {
+            if (bands.size() == 1) return 0;
+            return std::max(0, std::min(gy / rows_per_band, static_cast<int>(bands.size()) - 1));
+        }
+        // boids of a cell (nullptr if it is empty)
+        const std::vector<int>* find_cell(long long hash) const {
+            const auto& cells = bands[band_of_row(static_cast<int>(static_cast<unsigned int>(hash & 0xffffffffLL)))].cells;
+            auto cell_it = cells.find(hash);
+            return cell_it == cells.end() ? nullptr : &cell_it->second;
+        }
+        const CellAggregate* find_aggregate(long long hash) const {
+            const auto& aggregates = bands[band_of_row(static_cast<int>(static_cast<unsigned int>(hash & 0xffffffffLL)))].aggregates;
+            auto aggregate_it = aggregates.find(hash);
+            return aggregate_it == aggregates.end() ? nullptr : &aggregate_it->second;
+        }
 
         long long hash_cell(int gx, int gy) const {
             return (static_cast<long long>(gx) << 32) | static_cast<unsigned int>(gy);
         }
+
+        int cell_column(float x) const {
+            int gx = static_cast<int>(x * inv_cell_width);
+            return periodic ? std::min(gx, columns - 1) : gx;
+        }
+        int cell_row(float y) const {
+            int gy = static_cast<int>(y * inv_cell_height);
+            return periodic ? std::min(gy, rows - 1) : gy;
+        }
+
+        // a cell as the query sees it: the cell that is actually stored (wrapped when periodic) and the 
+        // offset that moves its boids to where cell (gx, gy) would be
+        struct CellImage {
+            long long hash;
+            float shift_x, shift_y;
+        };
+        CellImage image_of_cell(int gx, int gy) const {
+            if (!periodic) return {hash_cell(gx, gy), 0.0f, 0.0f};
+            int wrapped_x = ((gx % columns) + columns) % columns;
+            int wrapped_y = ((gy % rows) + rows) % rows;
+            return {hash_cell(wrapped_x, wrapped_y), static_cast<float>((gx - wrapped_x) / columns) * world_width, 
+                    static_cast<float>((gy - wrapped_y) / rows) * world_height};
+        }
 };
\ No newline at end of file
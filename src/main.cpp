@@ -5,143 +5,53 @@
 #include "simulation.hpp"
 #include "naiive_neighbor_search.hpp"
 #include "grid_neighbor_search.hpp"
-
+#include "topological_neighbor_search.hpp"
+#include "perf_counters.hpp"
+#include "stats_reporter.hpp"
+#include "obstacle_field.hpp"
+#include "adaptive_search.hpp"
+#include "time_stepper.hpp"
+
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 using namespace std;
 
+// order the searches are registered with the adaptive controller
+const int ADAPTIVE_NAIIVE = 0;
+const int ADAPTIVE_GRID = 1;
 
-SimulationConfig last_simulation_config = {};
-
-
-void print_simulation_controls_and_state() {
-    // // clear console (works on Windows)
-    system("cls");
-    // std::cout << "\033[H\033[J";   // Move cursor home + clear screen (fast, no flicker)
-
-    std::cout << "============================================================= \n";
-    std::cout << "                    Boid Simulation Controls                  \n";
-    std::cout << "============================================================= \n";
-    std::cout << " Play/Pause                                                   \n";
-    std::cout << "     [ P ]                                                    \n";
-    std::cout << " Show/Hide UI                                                 \n";
-    std::cout << "     [ Q ]                                                    \n";
-    std::cout << " Grid Toggle                                                  \n";
-    std::cout << "     [ W ]                                                    \n";
-    std::cout << " Toggle Neighbor Search Type (Naiive/Grid)                    \n";
-    std::cout << "     [ E ]                                                    \n";
-    std::cout << " Reset Simulation                                             \n";
-    std::cout << "     [ SPACE ]                                                \n";
-    std::cout<< " Quit Simulation                                               \n";
-    std::cout << "     [ ESC ]                                                  \n";
-    std::cout << "=============== Modify Configuration Values===================\n";
-    std::cout << "                 [Increase / Decrease]                        \n";
-    std::cout << " Grid Cell Size                                               \n";
-    std::cout << "     [ J / M ]                                                \n";
-    std::cout << " Boids Speed                                                  \n";
-    std::cout << "     [ + / - ]                                                \n";
-    std::cout << " Boids Count                                                  \n";
-    std::cout << "     [ G / B ]                                                \n";
-    std::cout << " Perception Radius                                            \n";
-    std::cout << "     [ A / Z ]                                                \n";
-    // std::cout << "Behavior Weights:                                            \n";
-    std::cout << " Alignment   Cohesion   Separation                            \n";
-    std::cout << " [ S / X ]   [ D / C ]   [ F / V ]                            \n";
-    std::cout << "============================================================= \n";
-
-    if (simulation_config.SIMULATION_TYPE_GRID){
-        std::cout << ("   NEIGHBOR SEARCH TYPE: [GRID]  ");
-    } else {
-        std::cout << ("   NEIGHBOR SEARCH TYPE: [NAIIVE]");
-    }
+// obstacle field samples at most (OBSTACLE_FIELD_RESOLUTION is raised for worlds that would need more)
+const float MAX_OBSTACLE_FIELD_SAMPLES = 4000000.0f;
 
-    if (simulation_config.PARALLELISM_ENABLED){
-        std::cout << ("   PARALLELISM: [ENABLED] \n\n");
-    } else {
-        std::cout << ("   PARALLELISM: [DISABLED]\n\n");
-    }
-
-    if (simulation_config.PAUSED){
-        std::cout << ("   STATE: [PAUSED] ");
-    } else {
-        std::cout << ("   STATE: [RUNNING]");
-    }
-    
-    if (simulation_config.SHOW_STATS){
-        std::cout << ("   STATS: [VISIBLE]");
-    } else {
-        std::cout << ("   STATS: [HIDDEN] ");
-    }
-    if (simulation_config.SHOW_GRID){
-        std::cout << ("   GRID: [VISIBLE]\n");
-    } else {
-        std::cout << ("   GRID: [HIDDEN] \n");
-    }
 
-    std::cout << "=============================================================                  \n";
-    std::cout << "                    SIMULATION STATE                                           \n";
-    std::cout << "=============================================================                  \n";
-    // if (simulation_config.PARALLELISM_ENABLED){
-    std::cout << "Number of Threads........" << simulation_config.PARALLELISM_NUM_THREADS << "   \n";
-    // }
-    std::cout << "Number of Boids........." << simulation_config.NUM_BOIDS << "                  \n";
-    std::cout << "Boid Speed.............." << simulation_config.SPEED << "x                     \n";
-    std::cout << "Perception Radius......." << simulation_config.PERCEPTION_RADIUS << "          \n\n";
-
-    std::cout << "Alignment Weight........" << simulation_config.ALIGNMENT_WEIGHT << "           \n";
-    std::cout << "Cohesion Weight........." << simulation_config.COHESION_WEIGHT << "            \n";
-    std::cout << "Separation Weight......." << simulation_config.SEPARATION_WEIGHT << "          \n\n";
-
-    std::cout << "Grid Cell Size.........." << simulation_config.GRID_CELL_SIZE << "             \n";
-    std::cout << "=============================================================                  \n";
-
-    std::cout << "                         STATS                                            \n";
-    std::cout << "=============================================================                  \n";
-    std::cout << "FPS....................." << simulation_stats.fps << "                    \n\n";
-
-    std::cout << "Last Frame Time........." << simulation_stats.frame_time_ms << " ms       \n";
-    std::cout << "Update Time............." << simulation_stats.update_time_ms << " ms   (" << simulation_stats.percent_update_time << "%)      \n";
-    std::cout << "Render Time............." << simulation_stats.render_time_ms << " ms   (" << simulation_stats.percent_render_time << "%)      \n\n";
-
-    std::cout << "Grid Map Build Time....." << simulation_stats.grid_map_hash_time_ms << " ms    \n";               // time taken to build the grid map (aka which boids are in which grid cell)
-    std::cout << "Get Neighbors Time......" << simulation_stats.get_neighbors_calc_time_ms << " ms    \n\n";          // time taken to get neighbors for all boids (whether checking ALL other boids or only those hashed into surrounding grid cells)
-    
-    // std::cout << "Total Neighbor Checks..." << simulation_stats.total_neighbor_checks << "  \n";                    // total number of neighbor checks this frame ??
-    std::cout << "Avg Checked Neighbors..." << simulation_stats.avg_checked_neighbors << "   \n";                   // average number of boids checked to find neighbors
-    std::cout << "Avg Neighbors/Boid......" << simulation_stats.avg_neighbors << "          \n";                    // average number of neighbors per boid (those within perception radius)
-    std::cout << "=============================================================             \n";
+// random position in [0, extent) (rand() % extent can't reach past RAND_MAX, only 32767 on some platforms)
+float random_coordinate(int extent) {
+    return static_cast<float>(rand() / (RAND_MAX + 1.0) * extent);
 }
 
-void maybe_print_state(Uint64& last_print) {
-    // check if any values in simulation_config have changed 
-    // or if no print in the last 3 seconds
-    Uint32 current_time = SDL_GetTicks();
-    if ((simulation_config != last_simulation_config) || (current_time - last_print > 2000)) {
-        print_simulation_controls_and_state();
-        // update last known config
-        last_simulation_config = simulation_config;
-        last_print = current_time;
-    }
-}
 
-void reset_simulation(SimulationState& state) {
-    // clear out all boids and reconstruct the array
-    state.boids.clear();
+void reset_simulation(SimulationState& state, TimeStepper& time_stepper) {
+    // clear out all boids (and their ids) and refill the pool
+    state.clear_boids();
     state.boids.reserve(simulation_config.NUM_BOIDS);
 
     // re-initialize boids with random positions and velocities
     for (int i = 0; i < simulation_config.NUM_BOIDS; i++) {
         Boid bird; 
-        // random position within window bounds
-        bird.x = rand() % simulation_config.WINDOW_WIDTH;
-        bird.y = rand() % simulation_config.WINDOW_HEIGHT;
+        // random position within world bounds
+        bird.x = random_coordinate(simulation_config.get_world_width());
+        bird.y = random_coordinate(simulation_config.get_world_height());
         // random velocity between -0.5 and 0.5
         bird.vx = ((rand() % 100) / 100.0f) - 0.5f;
         bird.vy = ((rand() % 100) / 100.0f) - 0.5f;
         // add bird 
-        state.boids.push_back(bird);
+        state.spawn(bird);
         // make sure simulation is not paused 
         simulation_config.PAUSED = false;
     }
+    // the leftover time and the previous step belong to the old flock
+    time_stepper.reset();
 
     // reset any stats 
     simulation_stats.frame_time_ms = 0.0f;
@@ -155,69 +65,176 @@ void reset_simulation(SimulationState& state) {
     simulation_stats.percent_update_time = 0.0f;
     simulation_stats.percent_render_time = 0.0f;
     simulation_stats.get_neighbors_calc_time_ms = 0.0f;
-    print_simulation_controls_and_state();
+    simulation_stats.build_perf = PerfSample();
+    simulation_stats.update_perf = PerfSample();
+    simulation_stats.render_perf = PerfSample();
+    simulation_stats.lod_skipped_updates = 0;
+    simulation_stats.lod_skipped_fraction = 0.0f;
+    stats_reporter.request_refresh();
+}
+
+
+// a couple of walls and rocks (plus one attractor) so there is something to steer around out of the box
+void add_default_obstacles(ObstacleField& obstacle_field) {
+    float width = static_cast<float>(simulation_config.get_world_width());
+    float height = static_cast<float>(simulation_config.get_world_height());
+    obstacle_field.add_circle(width * 0.30f, height * 0.35f, 40.0f);
+    obstacle_field.add_circle(width * 0.70f, height * 0.65f, 55.0f);
+    // slanted wall
+    obstacle_field.add_polygon({width * 0.45f, height * 0.10f, width * 0.48f, height * 0.08f,
+                                width * 0.60f, height * 0.38f, width * 0.57f, height * 0.40f});
+    obstacle_field.add_circle(width * 0.20f, height * 0.75f, 12.0f, true);
+}
+
+// loads a .bmp as one bitmap obstacle covering the world (bright pixels are solid)
+bool load_obstacle_bitmap(ObstacleField& obstacle_field, const char* path) {
+    if (!path || !path[0]) return false;
+    SDL_Surface* loaded = SDL_LoadBMP(path);
+    if (!loaded) {
+        std::cout << "Could not load obstacle bitmap " << path << "\n";
+        return false;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface) return false;
+
+    std::vector<unsigned char> mask(surface->w * surface->h);
+    SDL_LockSurface(surface);
+    for (int y = 0; y < surface->h; y++) {
+        const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < surface->w; x++) {
+            Uint32 pixel = row[x];
+            int brightness = (((pixel >> 16) & 0xFF) + ((pixel >> 8) & 0xFF) + (pixel & 0xFF)) / 3;
+            mask[y * surface->w + x] = brightness > 127;
+        }
+    }
+    SDL_UnlockSurface(surface);
+
+    // stretch the bitmap over the world width
+    float scale = static_cast<float>(simulation_config.get_world_width()) / surface->w;
+    obstacle_field.add_bitmap(mask, surface->w, surface->h, 0.0f, 0.0f, scale);
+    SDL_FreeSurface(surface);
+    return true;
 }
 
 
 void handle_input(const SDL_Event& event, SimulationState& state, Uint32& last_time, Simulation& sim, NeighborSearch*& neighbor_search,
                   NaiiveNeighborSearch& naiive_neighbor_search,
-                  GridNeighborSearch& grid_neighbor_search) {
+                  GridNeighborSearch& grid_neighbor_search,
+                  TopologicalNeighborSearch& topological_neighbor_search,
+                  ObstacleField& obstacle_field,
+                  AdaptiveSearchController& adaptive_search,
+                  Renderer& renderer,
+                  TimeStepper& time_stepper) {
+    // ================= OBSTACLE EDITING =================
+    // [ LEFT CLICK ] - add a rock (or remove the shape under the cursor)
+    // [ RIGHT CLICK ] - add an attractor (or remove the shape under the cursor)
+    if (event.type == SDL_MOUSEBUTTONDOWN) {
+        float x, y;
+        renderer.screen_to_world(static_cast<float>(event.button.x), static_cast<float>(event.button.y), x, y);
+        int hit = obstacle_field.find_obstacle(x, y);
+        if (hit >= 0) {
+            obstacle_field.remove_obstacle(hit);
+        } else if (event.button.button == SDL_BUTTON_LEFT) {
+            obstacle_field.add_circle(x, y, 30.0f);
+        } else if (event.button.button == SDL_BUTTON_RIGHT) {
+            obstacle_field.add_circle(x, y, 12.0f, true);
+        }
+        simulation_config.OBSTACLES_ENABLED = true;
+        return;
+    }
+
+    // ================= CAMERA =================
+    // [ MOUSE WHEEL ] - zoom in / out around the cursor
+    if (event.type == SDL_MOUSEWHEEL) {
+        int mouse_x, mouse_y;
+        SDL_GetMouseState(&mouse_x, &mouse_y);
+        float factor = std::pow(simulation_config.CAMERA_ZOOM_STEP, static_cast<float>(event.wheel.y));
+        renderer.zoom_at(factor, static_cast<float>(mouse_x), static_cast<float>(mouse_y));
+        return;
+    }
+
     if (event.type == SDL_KEYDOWN) {
         switch (event.key.keysym.sym) {
             // ================= CONFIGURATION PRESETS =================
             /* 
-            the following presets will only affect the number of boids, speed, perception radius, 
-            alignment, cohesion, and separation weights */
+            the presets themselves live in apply_preset (simulation_config.cpp) so the 
+            benchmarks can use the exact same values */
             // [ 0 ] reset to default config
+            // [ 1 ] tight flock (high cohesion, medium separation)
+            // [ 2 ] chaotic scatter (high separation, low cohesion)
+            // [ 3 ] smooth schooling (high alighnment, medium cohesion, low separation)
+            // [ 4 ] max load (high number of boids, high speed, medium all weights)
             case SDLK_0:
-                simulation_config = SimulationConfig(); // reset to default config
-                reset_simulation(state);
-                last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
-                break;
-            // [ 1 ] tight flock (high cohesion, medium separation) (flocks stick strongly together)
             case SDLK_1:
-                simulation_config.NUM_BOIDS = 1000;
-                simulation_config.SPEED = 5.0f;
-                simulation_config.PERCEPTION_RADIUS = 45.0f;
-                simulation_config.ALIGNMENT_WEIGHT = 0.3f;
-                simulation_config.COHESION_WEIGHT = 0.2f;
-                simulation_config.SEPARATION_WEIGHT = 1.0f;
-                reset_simulation(state);
-                last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
-                break;
-            // [ 2 ] chaotic scatter (high separation, low cohesion) (boids avoid each other strongly, resulting in scattered movement)
             case SDLK_2:
-                simulation_config.NUM_BOIDS = 1000;
-                simulation_config.SPEED = 7.0f;
-                simulation_config.PERCEPTION_RADIUS = 30.0f;
-                simulation_config.ALIGNMENT_WEIGHT = 0.2f;
-                simulation_config.COHESION_WEIGHT = 0.05f;
-                simulation_config.SEPARATION_WEIGHT = 2.0f;
-                reset_simulation(state);
-                last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
-                break;
-            // [ 3 ] smooth schooling (high alighnment, medium cohesion, low separation) (boids move smoothly in the same direction)
             case SDLK_3:
-                simulation_config.NUM_BOIDS = 1000;
-                simulation_config.SPEED = 4.0f;
-                simulation_config.PERCEPTION_RADIUS = 50.0f;
-                simulation_config.ALIGNMENT_WEIGHT = 0.5f;
-                simulation_config.COHESION_WEIGHT = 0.15f;
-                simulation_config.SEPARATION_WEIGHT = 0.5f;
-                reset_simulation(state);
-                last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
-                break;
-            // [ 4 ] max load (high number of boids, high speed, medium all weights) (tests performance under heavy load)
             case SDLK_4:
-                simulation_config.NUM_BOIDS = 5000;
-                simulation_config.SPEED = 20.0f;
-                simulation_config.PERCEPTION_RADIUS = 60.0f;
-                simulation_config.ALIGNMENT_WEIGHT = 0.25f;
-                simulation_config.COHESION_WEIGHT = 0.1f;
-                simulation_config.SEPARATION_WEIGHT = 1.5f;
-                reset_simulation(state);
+                apply_preset(simulation_config, event.key.keysym.sym - SDLK_0);
+                reset_simulation(state, time_stepper);
                 last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
                 break;
+            // ================= TOGGLE TEMPORAL LOD =================
+            // [ L ] - toggle temporal level of detail
+            case SDLK_l:
+                simulation_config.LOD_ENABLED = !simulation_config.LOD_ENABLED;
+                state.lod.clear(); // start from a clean classification
+                break;
+            // ================= TOGGLE OBSTACLES =================
+            // [ H ] - toggle obstacles / attractors
+            case SDLK_h:
+                simulation_config.OBSTACLES_ENABLED = !simulation_config.OBSTACLES_ENABLED;
+                break;
+            // ================= TOGGLE PERIODIC BOUNDARIES =================
+            // [ TAB ] - toggle looking for neighbors across the window edges
+            case SDLK_TAB:
+                simulation_config.PERIODIC_BOUNDARIES = !simulation_config.PERIODIC_BOUNDARIES;
+                break;
+            // ================= TOGGLE TASK GRAPH EXECUTOR =================
+            // [ F2 ] - toggle running parallel steps as a task graph (off = the OpenMP regions)
+            case SDLK_F2:
+                simulation_config.TASK_GRAPH_ENABLED = !simulation_config.TASK_GRAPH_ENABLED;
+                break;
+            // ================= TOGGLE CURSOR QUERY =================
+            // [ F3 ] - toggle highlighting the boids within the perception radius of the mouse
+            case SDLK_F3:
+                simulation_config.CURSOR_QUERY_ENABLED = !simulation_config.CURSOR_QUERY_ENABLED;
+                break;
+            // ================= TOGGLE FIXED TIMESTEP =================
+            // [ F4 ] - toggle fixed physics steps (sub-stepping + render interpolation) vs one step per frame
+            case SDLK_F4:
+                simulation_config.FIXED_TIMESTEP_ENABLED = !simulation_config.FIXED_TIMESTEP_ENABLED;
+                break;
+            // ================= CAMERA =================
+            // [ ARROWS ] - pan the view
+            case SDLK_LEFT:
+                renderer.pan(-simulation_config.CAMERA_PAN_STEP * simulation_config.WINDOW_WIDTH, 0.0f);
+                break;
+            case SDLK_RIGHT:
+                renderer.pan(simulation_config.CAMERA_PAN_STEP * simulation_config.WINDOW_WIDTH, 0.0f);
+                break;
+            case SDLK_UP:
+                renderer.pan(0.0f, -simulation_config.CAMERA_PAN_STEP * simulation_config.WINDOW_HEIGHT);
+                break;
+            case SDLK_DOWN:
+                renderer.pan(0.0f, simulation_config.CAMERA_PAN_STEP * simulation_config.WINDOW_HEIGHT);
+                break;
+            // [ PAGE UP / PAGE DOWN ] - zoom in / out around the middle of the window
+            case SDLK_PAGEUP:
+                renderer.zoom_at(simulation_config.CAMERA_ZOOM_STEP, simulation_config.WINDOW_WIDTH / 2.0f, simulation_config.WINDOW_HEIGHT / 2.0f);
+                break;
+            case SDLK_PAGEDOWN:
+                renderer.zoom_at(1.0f / simulation_config.CAMERA_ZOOM_STEP, simulation_config.WINDOW_WIDTH / 2.0f, simulation_config.WINDOW_HEIGHT / 2.0f);
+                break;
+            // [ HOME ] - show the whole world
+            case SDLK_HOME:
+                renderer.reset_camera();
+                break;
+            // ================= TOGGLE HARDWARE COUNTERS =================
+            // [ K ] - toggle hardware performance counters
+            case SDLK_k:
+                simulation_config.PERF_COUNTERS_ENABLED = !simulation_config.PERF_COUNTERS_ENABLED;
+                break;
             // ================= TOGGLE PARALLELISM =================
             // [ O ] - toggle parallelism
             case SDLK_o:
@@ -238,8 +255,50 @@ void handle_input(const SDL_Event& event, SimulationState& state, Uint32& last_t
                     simulation_config.SHOW_GRID = false; // disable grid display when using naiive search
                     simulation_config.BOID_COLOR = {255, 255, 255, 255}; // white boids for naiive search
                 }
+                simulation_config.TOPOLOGICAL_ENABLED = false; // [ E ] always goes back to the metric (radius) searches
+                simulation_config.ADAPTIVE_SEARCH_ENABLED = false; // picking a search by hand turns the adaptive selection off
                 sim.change_neighbor_search_type(neighbor_search);
                 break;
+            // ================= ADAPTIVE SEARCH SELECTION =================
+            // [ I ] - toggle automatic naiive / grid selection
+            case SDLK_i:
+                simulation_config.ADAPTIVE_SEARCH_ENABLED = !simulation_config.ADAPTIVE_SEARCH_ENABLED;
+                // start from whatever search is selected right now
+                adaptive_search.reset(simulation_config.SIMULATION_TYPE_GRID ? ADAPTIVE_GRID : ADAPTIVE_NAIIVE);
+                break;
+            // ================= FAR-FIELD APPROXIMATION =================
+            // [ N ] - toggle far-field cell aggregates (only used by the grid search)
+            case SDLK_n:
+                simulation_config.FAR_FIELD_ENABLED = !simulation_config.FAR_FIELD_ENABLED;
+                break;
+            // ================= SYMMETRIC PAIR TRAVERSAL =================
+            // [ R ] - toggle symmetric (half stencil) pair traversal (only used by the grid search)
+            case SDLK_r:
+                simulation_config.SYMMETRIC_PAIRS_ENABLED = !simulation_config.SYMMETRIC_PAIRS_ENABLED;
+                break;
+            // ================= TOPOLOGICAL NEIGHBORS =================
+            // [ T ] - toggle topological (k nearest) neighbor search
+            case SDLK_t:
+                simulation_config.TOPOLOGICAL_ENABLED = !simulation_config.TOPOLOGICAL_ENABLED;
+                if (simulation_config.TOPOLOGICAL_ENABLED) {
+                    neighbor_search = &topological_neighbor_search;
+                } else if (simulation_config.SIMULATION_TYPE_GRID) {
+                    neighbor_search = &grid_neighbor_search;
+                } else {
+                    neighbor_search = &naiive_neighbor_search;
+                }
+                // (the adaptive selection pauses while topological is on and resumes from the metric search)
+                adaptive_search.reset(simulation_config.SIMULATION_TYPE_GRID ? ADAPTIVE_GRID : ADAPTIVE_NAIIVE);
+                sim.change_neighbor_search_type(neighbor_search);
+                break;
+            // [ Y ] - increase k (max 16)
+            case SDLK_y:
+                simulation_config.TOPOLOGICAL_K = std::min(TopologicalNeighborSearch::MAX_K, simulation_config.TOPOLOGICAL_K + 1);
+                break;
+            // [ U ] - decrease k (min 1)
+            case SDLK_u:
+                simulation_config.TOPOLOGICAL_K = std::max(1, simulation_config.TOPOLOGICAL_K - 1);
+                break;
             // ================= PAUSE/UNPAUSE TOGGLE =================
             // [ P ] - pause/unpause      
             case SDLK_p:                     
@@ -267,7 +326,7 @@ void handle_input(const SDL_Event& event, SimulationState& state, Uint32& last_t
                 break;
             // [ J ] - increase grid cell size
             case SDLK_j:                     
-                simulation_config.GRID_CELL_SIZE = std::min(simulation_config.GRID_CELL_SIZE + simulation_config.GRID_CELL_SIZE_STEP, simulation_config.WINDOW_HEIGHT / 2.0f);
+                simulation_config.GRID_CELL_SIZE = std::min(simulation_config.GRID_CELL_SIZE + simulation_config.GRID_CELL_SIZE_STEP, simulation_config.get_world_height() / 2.0f);
                 break;
             // [ M ] - decrease grid cell size (min 5)
             case SDLK_m:                     
@@ -276,7 +335,7 @@ void handle_input(const SDL_Event& event, SimulationState& state, Uint32& last_t
             // ================= RESET SIMULATION =================
             // [ SPACE ] - reset simulation 
             case SDLK_SPACE:
-                reset_simulation(state);
+                reset_simulation(state, time_stepper);
                 last_time = SDL_GetTicks(); // reset last time to prevent large dt jump
                 break;
             // ================= SPEED CONTROLS =================
@@ -331,21 +390,22 @@ void handle_input(const SDL_Event& event, SimulationState& state, Uint32& last_t
                 simulation_config.NUM_BOIDS += simulation_config.NUM_BOIDS_STEP; 
                 for (int i = 0; i < simulation_config.NUM_BOIDS_STEP; i++) {
                     Boid bird; 
-                    // random position within window bounds
-                    bird.x = rand() % simulation_config.WINDOW_WIDTH;
-                    bird.y = rand() % simulation_config.WINDOW_HEIGHT;
+                    // random position within world bounds
+                    bird.x = random_coordinate(simulation_config.get_world_width());
+                    bird.y = random_coordinate(simulation_config.get_world_height());
                     // random velocity between -0.5 and 0.5
                     bird.vx = ((rand() % 100) / 100.0f) - 0.5f;
                     bird.vy = ((rand() % 100) / 100.0f) - 0.5f;
-                    // add bird 
-                    state.boids.push_back(bird); 
+                    // add bird (reuses a dead slot if there is one)
+                    state.spawn(bird); 
                 }
                 break;
             // [ B ] - decrease number of boids
             case SDLK_b:
                 simulation_config.NUM_BOIDS = std::max(1, simulation_config.NUM_BOIDS - simulation_config.NUM_BOIDS_STEP); 
-                if (state.boids.size() > simulation_config.NUM_BOIDS) {
-                    state.boids.resize(simulation_config.NUM_BOIDS); 
+                // kill the newest boids (from the back of the pool), the slots are compacted later by the simulation
+                for (int slot = static_cast<int>(state.boids.size()) - 1; slot >= 0 && state.num_live() > simulation_config.NUM_BOIDS; slot--) {
+                    state.kill_slot(slot);
                 }
                 break;
             
@@ -374,37 +434,76 @@ int main() {
     std::cout << "Randomizing Boid Start Positions...\n" ;
     for (int i = 0; i < simulation_config.NUM_BOIDS; i++) {
         Boid bird; 
-        // random position within window bounds
-        bird.x = rand() % simulation_config.WINDOW_WIDTH;
-        bird.y = rand() % simulation_config.WINDOW_HEIGHT;
+        // random position within world bounds
+        bird.x = random_coordinate(simulation_config.get_world_width());
+        bird.y = random_coordinate(simulation_config.get_world_height());
         // random velocity between -0.5 and 0.5
         bird.vx = ((rand() % 100) / 100.0f) - 0.5f;
         bird.vy = ((rand() % 100) / 100.0f) - 0.5f;
         // add bird 
-        state.boids.push_back(bird);
+        state.spawn(bird);
     }
     std::cout << "Done\n" ;
 
     // create neighbor search algorithm
     NaiiveNeighborSearch naiive_neighbor_search;
     GridNeighborSearch grid_neighbor_search;
+    TopologicalNeighborSearch topological_neighbor_search;
     // default to naiive search
     NeighborSearch* neighbor_search = &naiive_neighbor_search;
     Simulation sim(neighbor_search);
 
+    // persistent worker pool for the task graph steps (created once, the workers sleep while idle), the 
+    // renderer builds its triangles on it as soon as each block of boids is updated
+    TaskExecutor executor;
+    sim.set_executor(&executor);
+    sim.set_block_output(&renderer);
+
+    // each frame that has a reader publishes a snapshot of the flock here, anything outside the simulation 
+    // (like the cursor highlight below) queries that instead of the neighbor search's own grid
+    SpatialIndex spatial_index;
+    sim.set_spatial_index(&spatial_index);
+    SpatialReader cursor_reader(spatial_index);
+    std::vector<SpatialHit> cursor_hits;
+    // (the renderer draws from the snapshots too whenever the window doesn't show the whole world 1:1)
+    SpatialReader render_reader(spatial_index);
+
+    // splits each frame into fixed physics steps when FIXED_TIMESTEP_ENABLED
+    TimeStepper time_stepper;
+
+    // times naiive against grid every few hundred frames and keeps the cheaper one
+    AdaptiveSearchController adaptive_search;
+    adaptive_search.add_candidate("naiive", &naiive_neighbor_search);   // ADAPTIVE_NAIIVE
+    adaptive_search.add_candidate("grid", &grid_neighbor_search);       // ADAPTIVE_GRID
+    adaptive_search.set_log_file(simulation_config.ADAPTIVE_SEARCH_LOG);
+
+    // bake the obstacles / attractors (only rebaked locally when one is added, moved or removed)
+    std::cout << "Baking Obstacle Field...\n" ;
+    ObstacleField obstacle_field;
+    float world_width = static_cast<float>(simulation_config.get_world_width());
+    float world_height = static_cast<float>(simulation_config.get_world_height());
+    // (a big world gets a coarser field, the samples would not fit in memory otherwise)
+    float field_resolution = std::max(simulation_config.OBSTACLE_FIELD_RESOLUTION, std::sqrt(world_width * world_height / MAX_OBSTACLE_FIELD_SAMPLES));
+    obstacle_field.init(world_width, world_height, field_resolution, simulation_config.OBSTACLE_AVOID_RANGE, simulation_config.ATTRACTOR_RANGE);
+    if (!load_obstacle_bitmap(obstacle_field, simulation_config.OBSTACLE_BITMAP)) {
+        add_default_obstacles(obstacle_field);
+    }
+    sim.set_obstacle_field(&obstacle_field);
+    std::cout << "Done\n" ;
+
     // main loop
     bool running = true;
     SDL_Event event;
     Uint32 last = SDL_GetTicks();
-    Uint64 last_print_time = SDL_GetTicks();
     bool pause_single_frame = false;
 
 
     std::cout << "\n\nStarting Simulation...\n" ;
-    print_simulation_controls_and_state();
+    // console view + metrics file are handled on their own thread
+    stats_reporter.start(simulation_config.METRICS_FILE);
     while (running) {
-        // update and maybe print state if changed
-        maybe_print_state(last_print_time);
+        // hand the reporter the latest stats/config (just a copy, the printing happens elsewhere)
+        stats_reporter.publish(simulation_stats, simulation_config);
 
         // handle events
         while (SDL_PollEvent(&event)) { 
@@ -413,12 +512,27 @@ int main() {
                 running = false;
             }
             // handle other input
-            handle_input(event, state, last, sim, neighbor_search, naiive_neighbor_search, grid_neighbor_search);
+            handle_input(event, state, last, sim, neighbor_search, naiive_neighbor_search, grid_neighbor_search, topological_neighbor_search, obstacle_field, adaptive_search, renderer, time_stepper);
+            // (redraw the paused frame after any input, e.g. the camera moved)
+            if (event.type == SDL_KEYDOWN || event.type == SDL_MOUSEWHEEL || event.type == SDL_MOUSEBUTTONDOWN) {
+                pause_single_frame = false;
+            }
         }
 
         if (simulation_config.PAUSED) {
             if (!pause_single_frame) {
-                renderer.render(state.boids, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR);
+                // (the last published snapshot can be from before the camera view was needed, so publish the paused flock)
+                if (!renderer.camera_is_identity()) sim.publish_snapshot(state, SimulationParams::from_config(simulation_config), simulation_stats);
+                const SpatialSnapshot* snapshot = renderer.camera_is_identity() ? nullptr : render_reader.acquire();
+                if (snapshot) {
+                    renderer.render_view(*snapshot, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR, nullptr,
+                                         simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+                } else {
+                    renderer.render(state.boids, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR, 
+                                    state.has_dead_slots() ? &state.alive : nullptr,
+                                    simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+                }
+                render_reader.release();
                 pause_single_frame = true;
             }
             // SDL_Delay(10); // sleep to reduce CPU usage when paused
@@ -440,15 +554,93 @@ int main() {
 
         // ------------- Simultation Update Start (Calcs) -------------
         Uint64 update_start_time = SDL_GetPerformanceCounter();
-        sim.update(state, dt);
+        // with the camera away from the whole world 1:1 the renderer culls against the snapshot instead, 
+        // building triangles for every boid in the task graph would be wasted
+        bool camera_view = !renderer.camera_is_identity();
+        if (simulation_config.FIXED_TIMESTEP_ENABLED) {
+            // the renderer draws interpolated positions, so the task graph doesn't need to build its triangles
+            sim.set_block_output(nullptr);
+            time_stepper.advance(sim, state, dt, SimulationParams::from_config(simulation_config), simulation_stats);
+        } else {
+            sim.set_block_output(camera_view ? nullptr : &renderer);
+            sim.update(state, dt);
+        }
+        // one snapshot per frame (after the last substep), and none at all while nothing reads them
+        if (simulation_config.CURSOR_QUERY_ENABLED || camera_view) {
+            sim.publish_snapshot(state, SimulationParams::from_config(simulation_config), simulation_stats);
+        } else {
+            simulation_stats.snapshot_publish_time_ms = 0.0f;
+        }
         Uint64 update_end_time = SDL_GetPerformanceCounter();
         simulation_stats.update_time_ms = (update_end_time - update_start_time) * 1000.0f / SDL_GetPerformanceFrequency();
         // ------------- Simultation Update End (Calcs) -------------
 
+        // ------------- Adaptive Search Selection -------------
+        if (simulation_config.ADAPTIVE_SEARCH_ENABLED && !simulation_config.TOPOLOGICAL_ENABLED) {
+            NeighborSearch* next_search = adaptive_search.on_frame(simulation_stats, simulation_config);
+            if (next_search != neighbor_search) {
+                neighbor_search = next_search;
+                sim.change_neighbor_search_type(neighbor_search);
+            }
+            // the config (and boid color) follow the search that was decided on, not the one being probed
+            bool grid_active = adaptive_search.get_active() == ADAPTIVE_GRID;
+            if (grid_active != simulation_config.SIMULATION_TYPE_GRID) {
+                simulation_config.SIMULATION_TYPE_GRID = grid_active;
+                if (grid_active) {
+                    simulation_config.BOID_COLOR = {38, 43, 214, 255}; // blue boids for grid search
+                } else {
+                    simulation_config.BOID_COLOR = {255, 255, 255, 255}; // white boids for naiive search
+                }
+            }
+        }
+
+        // ------------- Cursor Query -------------
+        if (simulation_config.CURSOR_QUERY_ENABLED) {
+            int mouse_x, mouse_y;
+            SDL_GetMouseState(&mouse_x, &mouse_y);
+            float cursor_x, cursor_y;
+            renderer.screen_to_world(static_cast<float>(mouse_x), static_cast<float>(mouse_y), cursor_x, cursor_y);
+            // (the hits are copies, so the snapshot can be released right away)
+            if (const SpatialSnapshot* snapshot = cursor_reader.acquire()) {
+                snapshot->query_radius(cursor_x, cursor_y, simulation_config.PERCEPTION_RADIUS, cursor_hits);
+            }
+            cursor_reader.release();
+            renderer.set_highlight(&cursor_hits);
+        } else {
+            renderer.set_highlight(nullptr);
+        }
+
         // ------------- Render Start -------------
+        PerfSample render_perf_start;
+        if (simulation_config.PERF_COUNTERS_ENABLED) render_perf_start = read_thread_counters();
         Uint64 render_start_time = SDL_GetPerformanceCounter();
-        renderer.render(state.boids, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR);
+        const SpatialSnapshot* view_snapshot = camera_view ? render_reader.acquire() : nullptr;
+        if (view_snapshot) {
+            // only what is in view (interpolated when running fixed steps), see Renderer::render_view
+            const std::vector<Boid>* positions = simulation_config.FIXED_TIMESTEP_ENABLED ? 
+                                                 &time_stepper.interpolated(state, SimulationParams::from_config(simulation_config)) : nullptr;
+            renderer.render_view(*view_snapshot, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR, positions,
+                                 simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+        } else if (simulation_config.FIXED_TIMESTEP_ENABLED) {
+            // in between the last two physics steps
+            renderer.render(time_stepper.interpolated(state, SimulationParams::from_config(simulation_config)), 
+                            simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR, 
+                            state.has_dead_slots() ? &state.alive : nullptr,
+                            simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+        } else if (sim.last_update_used_task_graph()) {
+            // the triangles were already built by the step's graph, only the submission is left
+            renderer.render_blocks(simulation_config.BACKGROUND_COLOR, simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+        } else {
+            renderer.render(state.boids, simulation_config.BACKGROUND_COLOR, simulation_config.BOID_COLOR, 
+                            state.has_dead_slots() ? &state.alive : nullptr,
+                            simulation_config.OBSTACLES_ENABLED ? &obstacle_field : nullptr);
+        }
+        render_reader.release();
         Uint64 render_end_time = SDL_GetPerformanceCounter();
+        simulation_stats.camera_zoom = renderer.get_zoom();
+        simulation_stats.rendered_boids = camera_view ? renderer.get_drawn_boids() : state.num_live();
+        simulation_stats.splat_cells = camera_view ? renderer.get_splat_cells() : 0;
+        if (simulation_config.PERF_COUNTERS_ENABLED) simulation_stats.render_perf = read_thread_counters() - render_perf_start;
         simulation_stats.render_time_ms = (render_end_time - render_start_time) * 1000.0f / SDL_GetPerformanceFrequency();
         // ------------- Render End -------------
 
@@ -464,8 +656,10 @@ int main() {
         // ===================== FPS CALCULATION START ================
         simulation_stats.fps = 1000.0f / simulation_stats.frame_time_ms;
         // ===================== FPS CALCULATION END ================
+        stats_reporter.push_frame({simulation_stats.frame_time_ms, simulation_stats.update_time_ms, simulation_stats.render_time_ms});
     }
     // cleanup
+    stats_reporter.stop();
     renderer.cleanup();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "naiive_neighbor_search.hpp"
+#include "flock_kernels.hpp"
+#include <algorithm>
+#include <omp.h>
+
+
+void NaiiveNeighborSearch::build(const std::vector<Boid>& boids, SimulationParams params) {
+    // the streaming version does not require any precomputation, the tiled one tests its query blocks lazily
+    if (tiled) {
+        prepare_tiles(boids);
+    }
+}
+
+
+// ================= TILED ALL-PAIRS =================
+/* 
+every block of QUERY_BLOCK boids walks the candidates one CANDIDATE_TILE at a time, so each tile is 
+loaded from memory once per block instead of once per boid. tiles are visited in index order, so every 
+neighbor list comes out sorted exactly like the streaming version's */
+void NaiiveNeighborSearch::prepare_tiles(const std::vector<Boid>& boids) {
+    int n = static_cast<int>(boids.size());
+    xs.resize(n);
+    ys.resize(n);
+    live_boids = 0;
+    for (int i = 0; i < n; i++) {
+        // dead pool slots are moved out of reach of every query instead of being branched on
+        bool live = is_alive(i);
+        xs[i] = live ? boids[i].x : 1e30f;
+        ys[i] = live ? boids[i].y : 1e30f;
+        live_boids += live;
+    }
+    if (neighbor_lists.size() != static_cast<size_t>(n)) neighbor_lists.resize(n);
+
+    // every query block has to be tested again
+    int query_blocks = (n + QUERY_BLOCK - 1) / QUERY_BLOCK;
+    if (query_blocks > query_block_capacity) {
+        query_block_state.reset(new std::atomic<unsigned char>[query_blocks]);
+        query_block_capacity = query_blocks;
+    }
+    for (int block = 0; block < query_blocks; block++) {
+        query_block_state[block].store(QUERY_PENDING, std::memory_order_relaxed);
+    }
+}
+
+
+// the list of one boid, testing its query block first if nobody has yet. a query that finds the block being 
+// tested by another thread tests just its own boid into own_list instead of waiting (the OpenMP loop hands out 
+// consecutive boids, so waiting would serialize the threads on one block at a time)
+const std::vector<int>& NaiiveNeighborSearch::tiled_neighbors(const SimulationParams& params, int boid_index, std::vector<int>& own_list) {
+    std::atomic<unsigned char>& state = query_block_state[boid_index / QUERY_BLOCK];
+    unsigned char expected = QUERY_PENDING;
+    if (state.load(std::memory_order_acquire) == QUERY_DONE) {
+        return neighbor_lists[boid_index];
+    }
+    if (state.compare_exchange_strong(expected, QUERY_FILLING, std::memory_order_acq_rel)) {
+        int query_begin = (boid_index / QUERY_BLOCK) * QUERY_BLOCK;
+        int query_end = std::min(static_cast<int>(xs.size()), query_begin + QUERY_BLOCK);
+        test_query_block(params, query_begin, query_end, &neighbor_lists[query_begin]);
+        state.store(QUERY_DONE, std::memory_order_release);
+        return neighbor_lists[boid_index];
+    }
+    if (expected == QUERY_DONE) {
+        return neighbor_lists[boid_index];
+    }
+    test_query_block(params, boid_index, boid_index + 1, &own_list);
+    return own_list;
+}
+
+
+// neighbor lists for the query boids [query_begin, query_end) (at most QUERY_BLOCK of them), the list of 
+// query boid q goes to lists[q - query_begin]
+void NaiiveNeighborSearch::test_query_block(const SimulationParams& params, int query_begin, int query_end, std::vector<int>* lists) {
+    int n = static_cast<int>(xs.size());
+    const float perception_radius_sq = params.perception_radius_sq;
+    // periodic boundaries: distances are taken to the closest image (picked once per tile, the loops 
+    // themselves stay branch free)
+    const float wrap_width = params.periodic_boundaries ? params.world_width : 0.0f;
+    const float wrap_height = params.periodic_boundaries ? params.world_height : 0.0f;
+    const float* x = xs.data();
+    const float* y = ys.data();
+    unsigned char in_range[CANDIDATE_TILE];
+
+    for (int q = query_begin; q < query_end; q++) lists[q - query_begin].clear();
+
+    for (int tile_begin = 0; tile_begin < n; tile_begin += CANDIDATE_TILE) {
+        int tile_size = std::min(CANDIDATE_TILE, n - tile_begin);
+        const float* tile_x = x + tile_begin;
+        const float* tile_y = y + tile_begin;
+
+        for (int q = query_begin; q < query_end; q++) {
+            const float qx = x[q], qy = y[q];
+
+            // branch free distance test over the whole tile (vectorizes)
+            if (wrap_width > 0.0f) {
+                #pragma omp simd
+                for (int c = 0; c < tile_size; c++) {
+                    float dx = minimum_image_length(tile_x[c] - qx, wrap_width);
+                    float dy = minimum_image_length(tile_y[c] - qy, wrap_height);
+                    in_range[c] = (dx*dx + dy*dy <= perception_radius_sq);
+                }
+            } else {
+                #pragma omp simd
+                for (int c = 0; c < tile_size; c++) {
+                    float dx = tile_x[c] - qx;
+                    float dy = tile_y[c] - qy;
+                    in_range[c] = (dx*dx + dy*dy <= perception_radius_sq);
+                }
+            }
+
+            std::vector<int>& neighbors = lists[q - query_begin];
+            for (int c = 0; c < tile_size; c++) {
+                if (in_range[c] && tile_begin + c != q) neighbors.push_back(tile_begin + c);
+            }
+        }
+    }
+}
+
+
+// ================= BLOCK BUILD =================
+// blocks are runs of consecutive boid indices (a whole number of query blocks each, so two update tasks 
+// never share a query block). a boid's neighbor list is all its query ever reads, so every block only 
+// depends on itself (reach 0)
+int NaiiveNeighborSearch::begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) {
+    if (!tiled) return 1;
+    prepare_tiles(boids);
+    int n = static_cast<int>(boids.size());
+    int query_blocks = std::max(1, (n + QUERY_BLOCK - 1) / QUERY_BLOCK);
+    int query_blocks_per_block = (query_blocks + std::max(1, max_blocks) - 1) / std::max(1, max_blocks);
+    block_size = query_blocks_per_block * QUERY_BLOCK;
+    return (query_blocks + query_blocks_per_block - 1) / query_blocks_per_block;
+}
+
+
+int NaiiveNeighborSearch::block_of(int boid_index, const Boid& boid) const {
+    return tiled ? boid_index / block_size : 0;
+}
+
+
+void NaiiveNeighborSearch::build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) {
+    // nothing to do ahead of the queries, begin_block_build() already copied the positions
+}
+
+
+std::tuple<std::vector<int>, long long> NaiiveNeighborSearch::get_neighbors(const std::vector<Boid>& boids, 
+                                                                            int boid_index,
+                                                                            SimulationParams params) {
+    if (tiled) {
+        // every other live boid is tested once for the boid's query block
+        std::vector<int> own_list;
+        return {tiled_neighbors(params, boid_index, own_list), live_boids - 1};
+    }
+
+    std::vector<int> neighbors;
+    const Boid& boid = boids[boid_index];
+    const float wrap_width = params.periodic_boundaries ? params.world_width : 0.0f;
+    const float wrap_height = params.periodic_boundaries ? params.world_height : 0.0f;
+    long long checked_candidates = 0; // reset count
+
+    // for every other boid, check if it's within perception radius
+    for (int i = 0; i < boids.size(); ++i) {
+          if (i == boid_index) continue; // skip self
+          if (!is_alive(i)) continue;    // skip dead pool slots
+
+          checked_candidates++;
+
+          // calculate distance 
+          // (closest image with periodic boundaries, a zero sized world never wraps)
+          float dx = minimum_image(boids[i].x - boid.x, wrap_width);
+          float dy = minimum_image(boids[i].y - boid.y, wrap_height);
+          float distance = dx*dx + dy*dy; // squared distance
+          if (distance <= params.perception_radius_sq) {
+              neighbors.push_back(i); // if within perception radius, add to neighbors
+          }
+    }
+    return {neighbors, checked_candidates};
+}
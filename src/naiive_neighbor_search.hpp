@@ -2,6 +2,14 @@
 Naiive Neighbor Search 
 - Performance: O(N^2)
 - Checks and compares distance from one boid to every other boid in the simulation 
+- tiled (default): build() only copies the positions into x / y arrays. the first get_neighbors() 
+  for a block of query boids runs the all-pairs test for the whole block against tiles of candidates 
+  that stay in L1 (the distance tests vectorize), the other boids of the block get their list from 
+  that. blocks nobody queries (e.g. only boids the LOD scheduler skipped) are never tested, and the 
+  cost shows up as query time like the streaming version's. the task graph executor splits the boids 
+  into runs of whole query blocks
+- streaming: the original version, every get_neighbors() call streams the whole boid array
+- periodic boundaries: every distance is taken to the closest image of the other boid (minimum image)
 */
 
 
@@ -9,37 +17,42 @@ Naiive Neighbor Search
 #include "neighbor_search.hpp"
 #include "simulation_config.hpp"
 #include "simulation_stats.hpp"
+#include <atomic>
 #include <cmath>
+#include <memory>
 using namespace std;
 
 
 
 class NaiiveNeighborSearch : public NeighborSearch {
     public:
-        void build(const std::vector<Boid>& boids) override {
-            // Naiive neighbor search does not require any precomputation
-        }
+        static const int QUERY_BLOCK = 64;          // query boids that share one pass over a tile
+        static const int CANDIDATE_TILE = 1024;     // candidates per tile (8 KB of x / y, stays in L1)
+
+        explicit NaiiveNeighborSearch(bool tiled = true) : tiled(tiled) {}
+
+        void build(const std::vector<Boid>& boids, SimulationParams params) override;
 
         std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids, 
-                                        int boid_index) override {
-            std::vector<int> neighbors;
-            const Boid& boid = boids[boid_index];
-            long long checked_candidates = 0; // reset count
-
-            // for every other boid, check if it's within perception radius
-            for (int i = 0; i < boids.size(); ++i) {
-                  if (i == boid_index) continue; // skip self
-
-                  checked_candidates++;
-
-                  // calculate distance 
-                  float dx = boids[i].x - boid.x;
-                  float dy = boids[i].y - boid.y;
-                  float distance = dx*dx + dy*dy; // squared distance
-                  if (distance <= simulation_config.PERCEPTION_RADIUS * simulation_config.PERCEPTION_RADIUS) {
-                      neighbors.push_back(i); // if within perception radius, add to neighbors
-                  }
-            }
-            return {neighbors, checked_candidates};
-        }
+                                        int boid_index,
+                                        SimulationParams params) override;
+
+        int begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) override;
+        int block_of(int boid_index, const Boid& boid) const override;
+        void build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) override;
+
+    private:
+        bool tiled;
+        std::vector<float> xs, ys;                  // positions of the last build (dead slots pushed far away)
+        std::vector<std::vector<int>> neighbor_lists;
+        // per query block: QUERY_PENDING -> QUERY_FILLING (one thread tests the block) -> QUERY_DONE
+        enum QueryBlockState : unsigned char { QUERY_PENDING = 0, QUERY_FILLING, QUERY_DONE };
+        std::unique_ptr<std::atomic<unsigned char>[]> query_block_state;
+        int query_block_capacity = 0;
+        long long live_boids = 0;
+        int block_size = QUERY_BLOCK;               // boids per block of the last begin_block_build()
+
+        void prepare_tiles(const std::vector<Boid>& boids);
+        const std::vector<int>& tiled_neighbors(const SimulationParams& params, int boid_index, std::vector<int>& own_list);
+        void test_query_block(const SimulationParams& params, int query_begin, int query_end, std::vector<int>* lists);
 };
\ No newline at end of file
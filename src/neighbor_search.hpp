@@ -6,19 +6,85 @@ handles the general interface for neighbor search algorithms
 
 #pragma once 
 #include <vector>
+#include <tuple>
 #include "boid.hpp"
+#include "simulation_params.hpp"
 using namespace std;
 
 
+// summed up neighbor terms for one boid (what the steering in update_void needs)
+struct NeighborSums {
+    float align_x = 0.0f, align_y = 0.0f;   // sum of neighbor velocities
+    float coh_x = 0.0f, coh_y = 0.0f;       // sum of neighbor positions
+    float sep_x = 0.0f, sep_y = 0.0f;       // sum of inverse-square separation pushes
+    long long count = 0;                    // number of neighbors that went into the sums
+    long long checked_candidates = 0;
+};
+
+
 class NeighborSearch {
     public:
         virtual ~NeighborSearch() = default; 
         long long last_checked_candidates = 0;
 
+        // which boid slots are live (SimulationState::alive), nullptr = every slot is live. 
+        // set by the simulation before build(), searches never return dead slots as neighbors
+        void set_alive_mask(const std::vector<unsigned char>* mask) { alive_mask = mask; }
+        bool is_alive(int boid_index) const { return !alive_mask || (*alive_mask)[boid_index]; }
+
         // each derived class will need to implement a search for the boids nearby a given boid
+        // (params is the read-only snapshot for the current step)
         virtual std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids, 
-                                                                      int boid_index) = 0;
+                                                                      int boid_index,
+                                                                      SimulationParams params) = 0;
 
         // called once per simulation step to update grids 
-        virtual void build(const std::vector<Boid>& boids) = 0;
+        virtual void build(const std::vector<Boid>& boids, SimulationParams params) = 0;
+
+        // optional: fill in the neighbor sums directly (e.g. with far-field approximations) instead of 
+        // returning a list of neighbors. returns false if the search doesn't support it
+        virtual bool accumulate_neighbor_sums(const std::vector<Boid>& boids, int boid_index, 
+                                              SimulationParams params, NeighborSums& sums) {
+            return false;
+        }
+
+        // optional: fill in the neighbor sums for every boid in one pass (e.g. visiting each pair only once). 
+        // sums is resized to boids.size(). returns false if the search doesn't support it
+        virtual bool accumulate_all_neighbor_sums(const std::vector<Boid>& boids, SimulationParams params, 
+                                                  std::vector<NeighborSums>& sums) {
+            return false;
+        }
+
+        // whether get_neighbors returns every boid within params.perception_radius (false for searches that 
+        // pick neighbors some other way, like the k nearest). only those can be cached (cached_neighbor_search.hpp)
+        virtual bool is_radius_search() const {
+            return true;
+        }
+
+        // ================= BLOCK BUILD (task graph executor) =================
+        /* 
+        the build split into blocks that can be built on different threads, so a block of boids can start 
+        its update as soon as the blocks its queries read are built, instead of waiting for the whole build
+         - begin_block_build() runs first (alone), sets up whatever the blocks share and returns how many 
+           blocks there are (at most max_blocks)
+         - block_of() says which block a boid belongs to, every block is built and updated from its members 
+           (its live boids, in index order)
+         - build_block() can then run for all blocks at the same time
+         - a query for a boid in block b only reads blocks b - reach .. b + reach (block_reach)
+        the default is a single block that is built with build() */
+        virtual int begin_block_build(const std::vector<Boid>& boids, SimulationParams params, int max_blocks) {
+            return 1;
+        }
+        virtual int block_of(int boid_index, const Boid& boid) const {
+            return 0;
+        }
+        virtual void build_block(const std::vector<Boid>& boids, SimulationParams params, int block, const std::vector<int>& members) {
+            build(boids, params);
+        }
+        virtual int block_reach(SimulationParams params) const {
+            return 0;
+        }
+
+    protected:
+        const std::vector<unsigned char>* alive_mask = nullptr;
 };
\ No newline at end of file
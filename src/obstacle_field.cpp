@@ -0,0 +1,352 @@
+#include "obstacle_field.hpp"
+#include <algorithm>
+#include <omp.h>
+
+
+// regions with fewer samples than this are rebaked on the calling thread
+static const int PARALLEL_REBAKE_MIN_SAMPLES = 4096;
+
+
+// ================= SIGNED DISTANCE PER SHAPE =================
+// signed distance from (px, py) to the shape (negative = inside), gx / gy = unit direction away from it
+
+static float circle_distance(const Obstacle& obstacle, float px, float py, float& gx, float& gy) {
+    float dx = px - obstacle.x;
+    float dy = py - obstacle.y;
+    float length = std::sqrt(dx*dx + dy*dy);
+    if (length < 1e-6f) {
+        gx = 1.0f; gy = 0.0f;
+    } else {
+        gx = dx / length; gy = dy / length;
+    }
+    return length - obstacle.radius;
+}
+
+static float polygon_distance(const Obstacle& obstacle, float px, float py, float& gx, float& gy) {
+    const std::vector<float>& points = obstacle.points;
+    int count = static_cast<int>(points.size() / 2);
+    float x = px - obstacle.x;
+    float y = py - obstacle.y;
+
+    float best_distance_sq = 1e30f;
+    float closest_x = x, closest_y = y;
+    bool inside = false;
+    for (int a = 0, b = count - 1; a < count; b = a++) {
+        float ax = points[2*a], ay = points[2*a + 1];
+        float bx = points[2*b], by = points[2*b + 1];
+
+        // closest point on the edge
+        float ex = bx - ax, ey = by - ay;
+        float length_sq = ex*ex + ey*ey;
+        float t = length_sq > 0.0f ? ((x - ax) * ex + (y - ay) * ey) / length_sq : 0.0f;
+        t = std::min(1.0f, std::max(0.0f, t));
+        float cx = ax + ex * t, cy = ay + ey * t;
+        float distance_sq = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        if (distance_sq < best_distance_sq) {
+            best_distance_sq = distance_sq;
+            closest_x = cx;
+            closest_y = cy;
+        }
+
+        // crossing number test for inside / outside
+        if ((ay > y) != (by > y) && x < ax + (bx - ax) * (y - ay) / (by - ay)) {
+            inside = !inside;
+        }
+    }
+
+    float distance = std::sqrt(best_distance_sq);
+    float sign = inside ? -1.0f : 1.0f;
+    if (distance < 1e-6f) {
+        gx = 1.0f; gy = 0.0f;
+    } else {
+        gx = (x - closest_x) / distance * sign;
+        gy = (y - closest_y) / distance * sign;
+    }
+    return distance * sign;
+}
+
+// bilinear lookup into the bitmap's own distance field (in padded pixel coordinates)
+static float bitmap_local_distance(const Obstacle& obstacle, float u, float v) {
+    int max_u = obstacle.sdf_width - 1, max_v = obstacle.sdf_height - 1;
+    u = std::min(static_cast<float>(max_u), std::max(0.0f, u));
+    v = std::min(static_cast<float>(max_v), std::max(0.0f, v));
+    int u0 = std::min(max_u - 1, static_cast<int>(u));
+    int v0 = std::min(max_v - 1, static_cast<int>(v));
+    float tu = u - u0, tv = v - v0;
+    const float* row0 = &obstacle.local_sdf[v0 * obstacle.sdf_width];
+    const float* row1 = row0 + obstacle.sdf_width;
+    return (row0[u0] * (1.0f - tu) + row0[u0 + 1] * tu) * (1.0f - tv) + (row1[u0] * (1.0f - tu) + row1[u0 + 1] * tu) * tv;
+}
+
+static float bitmap_distance(const Obstacle& obstacle, float px, float py, float& gx, float& gy) {
+    // pixel k of the bitmap is centered at k + 0.5 and sits at index k + pad in the padded field
+    float u = (px - obstacle.x) / obstacle.sdf_scale + obstacle.sdf_pad - 0.5f;
+    float v = (py - obstacle.y) / obstacle.sdf_scale + obstacle.sdf_pad - 0.5f;
+    float distance = bitmap_local_distance(obstacle, u, v);
+
+    // central differences for the direction
+    float dx = bitmap_local_distance(obstacle, u + 1.0f, v) - bitmap_local_distance(obstacle, u - 1.0f, v);
+    float dy = bitmap_local_distance(obstacle, u, v + 1.0f) - bitmap_local_distance(obstacle, u, v - 1.0f);
+    float length = std::sqrt(dx*dx + dy*dy);
+    if (length < 1e-6f) {
+        gx = 1.0f; gy = 0.0f;
+    } else {
+        gx = dx / length; gy = dy / length;
+    }
+    return distance;
+}
+
+static float shape_distance(const Obstacle& obstacle, float px, float py, float& gx, float& gy) {
+    switch (obstacle.shape) {
+        case ObstacleShape::CIRCLE:  return circle_distance(obstacle, px, py, gx, gy);
+        case ObstacleShape::POLYGON: return polygon_distance(obstacle, px, py, gx, gy);
+        default:                     return bitmap_distance(obstacle, px, py, gx, gy);
+    }
+}
+
+
+// ================= BITMAP DISTANCE TRANSFORM =================
+/*
+8SSEDT: every pixel keeps the offset to its nearest seed pixel, two sweeps (down then up) pull
+better offsets in from the already visited neighbours. distances come out in pixels */
+static void distance_transform(const std::vector<unsigned char>& seeds, int width, int height, std::vector<float>& distances) {
+    const int far_away = 1 << 14;
+    std::vector<int> offset_x(width * height), offset_y(width * height);
+    for (int i = 0; i < width * height; i++) {
+        offset_x[i] = seeds[i] ? 0 : far_away;
+        offset_y[i] = seeds[i] ? 0 : far_away;
+    }
+
+    auto length_sq = [](int x, int y) { return static_cast<long long>(x) * x + static_cast<long long>(y) * y; };
+    auto compare = [&](int x, int y, int dx, int dy) {
+        int nx = x + dx, ny = y + dy;
+        if (nx < 0 || ny < 0 || nx >= width || ny >= height) return;
+        int i = y * width + x, n = ny * width + nx;
+        int candidate_x = offset_x[n] + dx, candidate_y = offset_y[n] + dy;
+        if (length_sq(candidate_x, candidate_y) < length_sq(offset_x[i], offset_y[i])) {
+            offset_x[i] = candidate_x;
+            offset_y[i] = candidate_y;
+        }
+    };
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            compare(x, y, -1, 0); compare(x, y, 0, -1); compare(x, y, -1, -1); compare(x, y, 1, -1);
+        }
+        for (int x = width - 1; x >= 0; x--) compare(x, y, 1, 0);
+    }
+    for (int y = height - 1; y >= 0; y--) {
+        for (int x = width - 1; x >= 0; x--) {
+            compare(x, y, 1, 0); compare(x, y, 0, 1); compare(x, y, -1, 1); compare(x, y, 1, 1);
+        }
+        for (int x = 0; x < width; x++) compare(x, y, -1, 0);
+    }
+
+    distances.resize(width * height);
+    for (int i = 0; i < width * height; i++) {
+        distances[i] = std::sqrt(static_cast<float>(length_sq(offset_x[i], offset_y[i])));
+    }
+}
+
+
+// ================= SETUP =================
+void ObstacleField::init(float width, float height, float field_resolution, float obstacle_reach, float attractor_reach) {
+    world_width = width;
+    world_height = height;
+    resolution = std::max(1.0f, field_resolution);
+    inv_resolution = 1.0f / resolution;
+    obstacle_range = obstacle_reach;
+    attractor_range = attractor_reach;
+    columns = static_cast<int>(std::ceil(world_width * inv_resolution)) + 1;
+    rows = static_cast<int>(std::ceil(world_height * inv_resolution)) + 1;
+    obstacles.clear();
+    rebake(0.0f, 0.0f, world_width, world_height);
+}
+
+void ObstacleField::clear() {
+    obstacles.clear();
+    rebake(0.0f, 0.0f, world_width, world_height);
+}
+
+
+int ObstacleField::add(Obstacle obstacle) {
+    obstacle.id = next_id++;
+    obstacles.push_back(std::move(obstacle));
+    rebake_around(obstacles.back());
+    return obstacles.back().id;
+}
+
+int ObstacleField::add_circle(float x, float y, float radius, bool attractor) {
+    Obstacle obstacle;
+    obstacle.shape = ObstacleShape::CIRCLE;
+    obstacle.attractor = attractor;
+    obstacle.x = x;
+    obstacle.y = y;
+    obstacle.radius = radius;
+    obstacle.min_x = obstacle.min_y = -radius;
+    obstacle.max_x = obstacle.max_y = radius;
+    return add(std::move(obstacle));
+}
+
+int ObstacleField::add_polygon(const std::vector<float>& points, bool attractor) {
+    if (points.size() < 6) return -1;
+    Obstacle obstacle;
+    obstacle.shape = ObstacleShape::POLYGON;
+    obstacle.attractor = attractor;
+    // store the points relative to the first vertex so the polygon can be moved like the other shapes
+    obstacle.x = points[0];
+    obstacle.y = points[1];
+    obstacle.min_x = obstacle.min_y = 1e30f;
+    obstacle.max_x = obstacle.max_y = -1e30f;
+    for (size_t p = 0; p + 1 < points.size(); p += 2) {
+        float x = points[p] - obstacle.x, y = points[p + 1] - obstacle.y;
+        obstacle.points.push_back(x);
+        obstacle.points.push_back(y);
+        obstacle.min_x = std::min(obstacle.min_x, x);
+        obstacle.min_y = std::min(obstacle.min_y, y);
+        obstacle.max_x = std::max(obstacle.max_x, x);
+        obstacle.max_y = std::max(obstacle.max_y, y);
+    }
+    return add(std::move(obstacle));
+}
+
+int ObstacleField::add_bitmap(const std::vector<unsigned char>& mask, int width, int height, float x, float y, float scale, bool attractor) {
+    if (width <= 0 || height <= 0 || mask.size() < static_cast<size_t>(width) * height || scale <= 0.0f) return -1;
+    Obstacle obstacle;
+    obstacle.shape = ObstacleShape::BITMAP;
+    obstacle.attractor = attractor;
+    obstacle.x = x;
+    obstacle.y = y;
+    obstacle.sdf_scale = scale;
+    obstacle.min_x = obstacle.min_y = 0.0f;
+    obstacle.max_x = width * scale;
+    obstacle.max_y = height * scale;
+
+    // pad the bitmap so the field still falls off smoothly outside of it
+    int pad = static_cast<int>(std::ceil(range_of(obstacle) / scale)) + 1;
+    int padded_width = width + 2 * pad, padded_height = height + 2 * pad;
+    std::vector<unsigned char> solid(padded_width * padded_height, 0), empty(padded_width * padded_height, 1);
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            if (!mask[row * width + column]) continue;
+            int i = (row + pad) * padded_width + column + pad;
+            solid[i] = 1;
+            empty[i] = 0;
+        }
+    }
+    std::vector<float> outside, inside;
+    distance_transform(solid, padded_width, padded_height, outside);
+    distance_transform(empty, padded_width, padded_height, inside);
+
+    // pixel centers are half a pixel away from the actual edge
+    obstacle.local_sdf.resize(padded_width * padded_height);
+    for (int i = 0; i < padded_width * padded_height; i++) {
+        float distance = solid[i] ? -(inside[i] - 0.5f) : (outside[i] - 0.5f);
+        obstacle.local_sdf[i] = distance * scale;
+    }
+    obstacle.sdf_width = padded_width;
+    obstacle.sdf_height = padded_height;
+    obstacle.sdf_pad = pad;
+    return add(std::move(obstacle));
+}
+
+
+int ObstacleField::index_of(int id) const {
+    for (int i = 0; i < static_cast<int>(obstacles.size()); i++) {
+        if (obstacles[i].id == id) return i;
+    }
+    return -1;
+}
+
+bool ObstacleField::move_obstacle(int id, float x, float y) {
+    int index = index_of(id);
+    if (index < 0) return false;
+    Obstacle old_position = obstacles[index];
+    obstacles[index].x = x;
+    obstacles[index].y = y;
+    // whatever the shape used to reach and whatever it reaches now
+    rebake_around(old_position);
+    rebake_around(obstacles[index]);
+    return true;
+}
+
+bool ObstacleField::remove_obstacle(int id) {
+    int index = index_of(id);
+    if (index < 0) return false;
+    Obstacle removed = std::move(obstacles[index]);
+    obstacles.erase(obstacles.begin() + index);
+    rebake_around(removed);
+    return true;
+}
+
+int ObstacleField::find_obstacle(float x, float y) const {
+    // last added is on top
+    for (int i = static_cast<int>(obstacles.size()) - 1; i >= 0; i--) {
+        float gx, gy;
+        if (shape_distance(obstacles[i], x, y, gx, gy) <= 0.0f) return obstacles[i].id;
+    }
+    return -1;
+}
+
+
+// ================= BAKING =================
+void ObstacleField::rebake_around(const Obstacle& obstacle) {
+    float range = range_of(obstacle);
+    rebake(obstacle.x + obstacle.min_x - range, obstacle.y + obstacle.min_y - range,
+           obstacle.x + obstacle.max_x + range, obstacle.y + obstacle.max_y + range);
+}
+
+void ObstacleField::rebake(float min_x, float min_y, float max_x, float max_y) {
+    if (samples.size() != static_cast<size_t>(columns) * rows) {
+        samples.assign(static_cast<size_t>(columns) * rows, FieldSample{obstacle_range, 0.0f, 0.0f, attractor_range, 0.0f, 0.0f});
+    }
+    int first_column = std::max(0, static_cast<int>(std::floor(min_x * inv_resolution)));
+    int first_row = std::max(0, static_cast<int>(std::floor(min_y * inv_resolution)));
+    int last_column = std::min(columns - 1, static_cast<int>(std::ceil(max_x * inv_resolution)));
+    int last_row = std::min(rows - 1, static_cast<int>(std::ceil(max_y * inv_resolution)));
+    if (first_column > last_column || first_row > last_row) {
+        rebaked_samples = 0;
+        return;
+    }
+
+    // only shapes that can reach into this region need to be looked at
+    std::vector<const Obstacle*> nearby;
+    for (const Obstacle& obstacle : obstacles) {
+        float range = range_of(obstacle);
+        if (obstacle.x + obstacle.max_x + range < min_x || obstacle.x + obstacle.min_x - range > max_x ||
+            obstacle.y + obstacle.max_y + range < min_y || obstacle.y + obstacle.min_y - range > max_y) continue;
+        nearby.push_back(&obstacle);
+    }
+
+    long long region_samples = static_cast<long long>(last_column - first_column + 1) * (last_row - first_row + 1);
+    #pragma omp parallel for schedule(static) if(region_samples >= PARALLEL_REBAKE_MIN_SAMPLES)
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            float px = column * resolution;
+            float py = row * resolution;
+            FieldSample sample = {obstacle_range, 0.0f, 0.0f, attractor_range, 0.0f, 0.0f};
+
+            // union of all shapes = the closest one wins
+            for (const Obstacle* obstacle : nearby) {
+                float range = range_of(*obstacle);
+                if (px < obstacle->x + obstacle->min_x - range || px > obstacle->x + obstacle->max_x + range ||
+                    py < obstacle->y + obstacle->min_y - range || py > obstacle->y + obstacle->max_y + range) continue;
+                float gx, gy;
+                float distance = shape_distance(*obstacle, px, py, gx, gy);
+                if (obstacle->attractor) {
+                    if (distance < sample.attractor_distance) {
+                        sample.attractor_distance = distance;
+                        sample.attractor_gx = gx;
+                        sample.attractor_gy = gy;
+                    }
+                } else if (distance < sample.obstacle_distance) {
+                    sample.obstacle_distance = distance;
+                    sample.obstacle_gx = gx;
+                    sample.obstacle_gy = gy;
+                }
+            }
+            samples[row * columns + column] = sample;
+        }
+    }
+    rebaked_samples = region_samples;
+}
@@ -0,0 +1,127 @@
+/*
+obstacles and attractors baked into a sampled signed distance field
+- shapes (circles, polygons, bitmaps) are turned into one regular grid of samples covering the world,
+  every sample stores the signed distance to the closest obstacle (negative = inside) and the direction
+  away from it, plus the same for the closest attractor
+- the update kernel only ever does one bilinear lookup per boid (sample()), no matter how many
+  obstacles there are
+- distances are clamped to the obstacle / attractor range, so a shape can only change the samples in
+  its bounds grown by that range. adding, moving or removing a shape only rebakes that region
+- bitmaps get their own signed distance transform once when they are added, after that they are
+  rebaked like any other shape
+*/
+
+
+#pragma once
+#include <vector>
+#include <cmath>
+using namespace std;
+
+
+enum class ObstacleShape {
+    CIRCLE,
+    POLYGON,
+    BITMAP
+};
+
+struct Obstacle {
+    int id = -1;
+    ObstacleShape shape = ObstacleShape::CIRCLE;
+    bool attractor = false;             // pulls boids in instead of pushing them away
+    float x = 0.0f, y = 0.0f;           // circle center / offset of the polygon points and bitmap corner
+
+    float radius = 0.0f;                // circle
+    std::vector<float> points;          // polygon vertices relative to (x, y): x0, y0, x1, y1, ...
+
+    // bitmap: signed distance (world units) per pixel of the bitmap padded by the shape's range
+    int sdf_width = 0, sdf_height = 0;
+    int sdf_pad = 0;                    // padding pixels on every side
+    float sdf_scale = 1.0f;             // world units per bitmap pixel
+    std::vector<float> local_sdf;
+
+    // bounds relative to (x, y) (without the range)
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+};
+
+// one baked sample (also what a lookup returns, bilinearly interpolated)
+struct FieldSample {
+    float obstacle_distance;            // signed distance to the closest obstacle (clamped to the obstacle range)
+    float obstacle_gx, obstacle_gy;     // unit direction away from that obstacle
+    float attractor_distance;           // signed distance to the closest attractor (clamped to the attractor range)
+    float attractor_gx, attractor_gy;   // unit direction away from that attractor
+};
+
+
+class ObstacleField {
+    public:
+        // resolution = world units between samples, the ranges are how far the shapes reach
+        void init(float world_width, float world_height, float resolution, float obstacle_range, float attractor_range);
+
+        // ================= SHAPES =================
+        // each returns the id of the new shape (positions in world units)
+        int add_circle(float x, float y, float radius, bool attractor = false);
+        int add_polygon(const std::vector<float>& points, bool attractor = false);
+        // mask is width x height, row major, non-zero = solid. scale = world units per bitmap pixel
+        int add_bitmap(const std::vector<unsigned char>& mask, int width, int height, float x, float y, float scale, bool attractor = false);
+        bool move_obstacle(int id, float x, float y);
+        bool remove_obstacle(int id);
+        void clear();
+        // id of the shape covering (x, y), -1 if there is none
+        int find_obstacle(float x, float y) const;
+
+        bool empty() const { return obstacles.empty(); }
+        const std::vector<Obstacle>& get_obstacles() const { return obstacles; }
+        long long last_rebaked_samples() const { return rebaked_samples; }
+
+        // ================= LOOKUP =================
+        int get_columns() const { return columns; }
+        int get_rows() const { return rows; }
+        float get_resolution() const { return resolution; }
+        const FieldSample& at(int column, int row) const { return samples[row * columns + column]; }
+
+        // bilinear lookup, positions outside the world are clamped to its edge
+        FieldSample sample(float x, float y) const {
+            float fx = x * inv_resolution;
+            float fy = y * inv_resolution;
+            int column = static_cast<int>(fx);
+            int row = static_cast<int>(fy);
+            column = column < 0 ? 0 : (column > columns - 2 ? columns - 2 : column);
+            row = row < 0 ? 0 : (row > rows - 2 ? rows - 2 : row);
+            float tx = fx - column, ty = fy - row;
+            tx = tx < 0.0f ? 0.0f : (tx > 1.0f ? 1.0f : tx);
+            ty = ty < 0.0f ? 0.0f : (ty > 1.0f ? 1.0f : ty);
+
+            const FieldSample& s00 = samples[row * columns + column];
+            const FieldSample& s10 = samples[row * columns + column + 1];
+            const FieldSample& s01 = samples[(row + 1) * columns + column];
+            const FieldSample& s11 = samples[(row + 1) * columns + column + 1];
+            float w00 = (1.0f - tx) * (1.0f - ty), w10 = tx * (1.0f - ty), w01 = (1.0f - tx) * ty, w11 = tx * ty;
+
+            FieldSample result;
+            result.obstacle_distance = s00.obstacle_distance * w00 + s10.obstacle_distance * w10 + s01.obstacle_distance * w01 + s11.obstacle_distance * w11;
+            result.obstacle_gx = s00.obstacle_gx * w00 + s10.obstacle_gx * w10 + s01.obstacle_gx * w01 + s11.obstacle_gx * w11;
+            result.obstacle_gy = s00.obstacle_gy * w00 + s10.obstacle_gy * w10 + s01.obstacle_gy * w01 + s11.obstacle_gy * w11;
+            result.attractor_distance = s00.attractor_distance * w00 + s10.attractor_distance * w10 + s01.attractor_distance * w01 + s11.attractor_distance * w11;
+            result.attractor_gx = s00.attractor_gx * w00 + s10.attractor_gx * w10 + s01.attractor_gx * w01 + s11.attractor_gx * w11;
+            result.attractor_gy = s00.attractor_gy * w00 + s10.attractor_gy * w10 + s01.attractor_gy * w01 + s11.attractor_gy * w11;
+            return result;
+        }
+
+    private:
+        float world_width = 0.0f, world_height = 0.0f;
+        float resolution = 1.0f, inv_resolution = 1.0f;
+        float obstacle_range = 0.0f, attractor_range = 0.0f;
+        int columns = 0, rows = 0;
+        std::vector<FieldSample> samples;
+
+        std::vector<Obstacle> obstacles;
+        int next_id = 0;
+        long long rebaked_samples = 0;
+
+        float range_of(const Obstacle& obstacle) const { return obstacle.attractor ? attractor_range : obstacle_range; }
+        int add(Obstacle obstacle);
+        int index_of(int id) const;
+        // rebake every sample that the shape (in its current position) can reach
+        void rebake_around(const Obstacle& obstacle);
+        void rebake(float min_x, float min_y, float max_x, float max_y);
+};
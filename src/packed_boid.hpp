@@ -0,0 +1,99 @@
+/*
+16-bit fixed point boid storage (optional, for populations big enough that the update is limited by
+memory bandwidth rather than arithmetic)
+- positions are stored as fractions of the world size (0..65535 = 0..extent), velocities as fractions
+  of MAX_SPEED (-32767..32767), so a 2D boid takes 8 bytes instead of 16 (3D: 12 instead of 24)
+- the kernels never see the packed values: BoidCodec<D> decodes a boid into the normal float layout
+  (in registers), the kernels from flock_kernels.hpp run unchanged and the result is encoded again
+- resolution: extent / 65536 for positions (~0.012 px across an 800 px world), MAX_SPEED / 32767 for
+  velocities. encoding a position wraps modulo 65536, which is exactly the world wrap
+- FloatStorage / PackedStorage are the two storage policies FlockSimulation<D, Storage> can use
+*/
+
+
+#pragma once
+#include <cstdint>
+#include "flock_kernels.hpp"
+#include "simulation_params.hpp"
+
+
+template <int D>
+struct PackedBoid {
+    uint16_t position[D];               // position / extent * 65536 (wraps)
+    int16_t velocity[D];                // velocity / max_speed * 32767
+};
+
+
+template <int D>
+class BoidCodec {
+    public:
+        typedef typename BoidTraits<D>::type BoidType;
+
+        explicit BoidCodec(const SimulationParams& params) {
+            for (int a = 0; a < D; a++) {
+                float extent = world_extent(params, a);
+                from_position[a] = 65536.0f / extent;
+                to_position[a] = extent / 65536.0f;
+            }
+            from_velocity = 32767.0f / params.max_speed;
+            to_velocity = params.max_speed / 32767.0f;
+        }
+
+        float position(const PackedBoid<D>& packed, int axis) const {
+            return packed.position[axis] * to_position[axis];
+        }
+
+        BoidType decode(const PackedBoid<D>& packed) const {
+            typedef BoidTraits<D> T;
+            BoidType boid;
+            for (int a = 0; a < D; a++) {
+                T::position(boid, a) = packed.position[a] * to_position[a];
+                T::velocity(boid, a) = packed.velocity[a] * to_velocity;
+            }
+            return boid;
+        }
+
+        PackedBoid<D> encode(const BoidType& boid) const {
+            typedef BoidTraits<D> T;
+            PackedBoid<D> packed;
+            for (int a = 0; a < D; a++) {
+                // round to nearest, 65536 (= the far edge) wraps around to 0
+                float position = T::position(boid, a) * from_position[a] + 0.5f;
+                packed.position[a] = static_cast<uint16_t>(static_cast<int32_t>(position));
+
+                // speed is already limited to max_speed, the clamp only guards against rounding
+                float velocity = T::velocity(boid, a) * from_velocity;
+                velocity = velocity > 32767.0f ? 32767.0f : (velocity < -32767.0f ? -32767.0f : velocity);
+                packed.velocity[a] = static_cast<int16_t>(velocity + (velocity >= 0.0f ? 0.5f : -0.5f));
+            }
+            return packed;
+        }
+
+    private:
+        float from_position[D], to_position[D];
+        float from_velocity, to_velocity;
+};
+
+
+// ================= STORAGE POLICIES =================
+
+// plain floats (the codec is the identity and compiles away)
+template <int D>
+struct FloatStorage {
+    typedef typename BoidTraits<D>::type BoidType;
+    typedef BoidType stored_type;
+
+    struct Codec {
+        explicit Codec(const SimulationParams&) {}
+        float position(const BoidType& boid, int axis) const { return BoidTraits<D>::position(boid, axis); }
+        const BoidType& decode(const BoidType& boid) const { return boid; }
+        const BoidType& encode(const BoidType& boid) const { return boid; }
+    };
+};
+
+// 16-bit fixed point
+template <int D>
+struct PackedStorage {
+    typedef PackedBoid<D> stored_type;
+    typedef BoidCodec<D> Codec;
+};
@@ -0,0 +1,149 @@
+#include "perf_counters.hpp"
+#include <atomic>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+
+// unknown until a thread has actually counted something, failed sticks (one broken thread makes the sums meaningless)
+enum CounterState { COUNTERS_UNKNOWN = 0, COUNTERS_WORKING, COUNTERS_FAILED };
+static std::atomic<int> counter_state{COUNTERS_UNKNOWN};
+
+static void mark_counters_working() {
+    int expected = COUNTERS_UNKNOWN;
+    counter_state.compare_exchange_strong(expected, COUNTERS_WORKING, std::memory_order_relaxed);
+}
+
+static void mark_counters_failed() {
+    counter_state.store(COUNTERS_FAILED, std::memory_order_relaxed);
+}
+
+bool counters_available() {
+#ifdef __linux__
+    return counter_state.load(std::memory_order_relaxed) == COUNTERS_WORKING;
+#else
+    return false;
+#endif
+}
+
+
+#ifdef __linux__
+
+// order of the events in the group (and in the values read back)
+enum CounterSlot { CYCLES = 0, INSTRUCTIONS, LLC_MISSES, L1D_MISSES, BRANCH_MISSES, NUM_SLOTS };
+
+// one counter group per thread, opened the first time the thread reads its counters
+struct ThreadCounters {
+    bool tried = false;
+    int leader_fd = -1;
+    int fds[NUM_SLOTS] = {-1, -1, -1, -1, -1};
+    int group_position[NUM_SLOTS] = {-1, -1, -1, -1, -1};  // where each slot ends up in the group read (-1 = not supported)
+    int num_open = 0;
+
+    ~ThreadCounters() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+};
+
+static thread_local ThreadCounters thread_counters;
+
+
+static int open_counter(uint32_t type, uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;   // leader starts disabled, the rest follow the leader
+    attr.exclude_kernel = 1;                    // user space only (works with perf_event_paranoid = 2)
+    attr.exclude_hv = 1;
+    // the times tell how long the group was actually on the PMU (less than enabled when the kernel multiplexes it)
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1 -> count the calling thread on whatever cpu it runs
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+static void open_thread_counters(ThreadCounters& counters) {
+    counters.tried = true;
+
+    const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+                                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const uint32_t types[NUM_SLOTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    const uint64_t configs[NUM_SLOTS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                                         l1d_read_miss, PERF_COUNT_HW_BRANCH_MISSES};
+
+    // cycles is the group leader, without it there is nothing to measure
+    counters.leader_fd = open_counter(types[CYCLES], configs[CYCLES], -1);
+    if (counters.leader_fd < 0) {
+        mark_counters_failed();
+        return;
+    }
+    counters.fds[CYCLES] = counters.leader_fd;
+    counters.group_position[CYCLES] = counters.num_open++;
+
+    // the other events are optional, some CPUs / VMs don't expose all of them
+    for (int slot = INSTRUCTIONS; slot < NUM_SLOTS; slot++) {
+        int fd = open_counter(types[slot], configs[slot], counters.leader_fd);
+        if (fd >= 0) {
+            counters.fds[slot] = fd;
+            counters.group_position[slot] = counters.num_open++;
+        }
+    }
+
+    ioctl(counters.leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters.leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfSample read_thread_counters() {
+    PerfSample sample;
+    ThreadCounters& counters = thread_counters;
+    if (!counters.tried) {
+        open_thread_counters(counters);
+    }
+    if (counters.leader_fd < 0) {
+        return sample;
+    }
+
+    // group read layout: { u64 nr; u64 time_enabled; u64 time_running; u64 values[nr]; }
+    uint64_t buffer[3 + NUM_SLOTS] = {};
+    if (read(counters.leader_fd, buffer, sizeof(buffer)) <= 0) {
+        return sample;
+    }
+    sample.time_enabled = buffer[1];
+    sample.time_running = buffer[2];
+    if (sample.time_running == 0) {
+        // enabled for a while but never scheduled (PMU taken by someone else, VM without a vPMU, ...)
+        // -> the values are all zero and would look like a perfect run
+        if (sample.time_enabled > 0) mark_counters_failed();
+        return sample;
+    }
+    mark_counters_working();
+
+    // raw counts, the multiplexing is only corrected per phase (see PerfSample::operator-)
+    auto value = [&](int slot) -> uint64_t {
+        int position = counters.group_position[slot];
+        return (position >= 0 && static_cast<uint64_t>(position) < buffer[0]) ? buffer[3 + position] : 0;
+    };
+    sample.cycles = value(CYCLES);
+    sample.instructions = value(INSTRUCTIONS);
+    sample.llc_misses = value(LLC_MISSES);
+    sample.l1d_misses = value(L1D_MISSES);
+    sample.branch_misses = value(BRANCH_MISSES);
+    return sample;
+}
+
+#else
+
+PerfSample read_thread_counters() {
+    return PerfSample();
+}
+
+#endif
@@ -0,0 +1,74 @@
+/* 
+optional hardware performance counters (Linux only, uses perf_event_open)
+- each thread that calls read_thread_counters() lazily opens its own counter group 
+  (cycles, instructions, LLC misses, L1D read misses, branch misses) for itself
+- counters run freely once opened, phases are measured by taking the difference of two reads
+- readings are raw, the difference of two readings is scaled by the phase's time_enabled / time_running 
+  (so the counts are estimates while the kernel multiplexes the group)
+- if the counters can't be opened (not Linux, perf_event_paranoid too strict, running in a 
+  container, ...) or never actually get scheduled, every read just returns zeros and 
+  counters_available() reports false
+*/
+
+
+#pragma once
+#include <cstdint>
+
+
+// difference of two counter readings (clamped, an unordered pair must not wrap around to ~1.8e19)
+inline uint64_t perf_delta(uint64_t later, uint64_t earlier) {
+    return later > earlier ? later - earlier : 0;
+}
+
+
+struct PerfSample {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+    uint64_t l1d_misses = 0;
+    uint64_t branch_misses = 0;
+    // how long the group was enabled / actually counting (ns), they only differ while it is multiplexed
+    uint64_t time_enabled = 0;
+    uint64_t time_running = 0;
+
+    PerfSample& operator+=(const PerfSample& other) {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        llc_misses += other.llc_misses;
+        l1d_misses += other.l1d_misses;
+        branch_misses += other.branch_misses;
+        time_enabled += other.time_enabled;
+        time_running += other.time_running;
+        return *this;
+    }
+
+    // one phase: the raw counts of two readings are subtracted and then extrapolated by the phase's own 
+    // enabled / running time (scaling the cumulative readings first isn't monotonic while multiplexed, the 
+    // later one can come out smaller). nothing counted during the phase = all zero
+    PerfSample operator-(const PerfSample& other) const {
+        PerfSample diff;
+        diff.time_enabled = perf_delta(time_enabled, other.time_enabled);
+        diff.time_running = perf_delta(time_running, other.time_running);
+        if (diff.time_running == 0) return diff;
+        double scale = static_cast<double>(diff.time_enabled) / static_cast<double>(diff.time_running);
+        diff.cycles = static_cast<uint64_t>(perf_delta(cycles, other.cycles) * scale);
+        diff.instructions = static_cast<uint64_t>(perf_delta(instructions, other.instructions) * scale);
+        diff.llc_misses = static_cast<uint64_t>(perf_delta(llc_misses, other.llc_misses) * scale);
+        diff.l1d_misses = static_cast<uint64_t>(perf_delta(l1d_misses, other.l1d_misses) * scale);
+        diff.branch_misses = static_cast<uint64_t>(perf_delta(branch_misses, other.branch_misses) * scale);
+        return diff;
+    }
+
+    // instructions per cycle (0 if nothing was counted)
+    float ipc() const {
+        return cycles > 0 ? static_cast<float>(instructions) / static_cast<float>(cycles) : 0.0f;
+    }
+};
+
+
+// current counter values for the calling thread (opens the counters on first use)
+PerfSample read_thread_counters();
+
+// true once a thread read counters that actually ran, false before that, once any thread failed 
+// to open or schedule its counters, or always when not on Linux
+bool counters_available();
@@ -2,9 +2,37 @@
 
 #include "simulation_config.hpp"
 #include "renderer.hpp"
+#include <algorithm>
 #include <cmath>
 
 
+// the config keeps its colors SDL free
+static SDL_Color to_sdl_color(RgbaColor color) {
+    return {color.r, color.g, color.b, color.a};
+}
+
+// the triangle of draw_boid (tip forward, two corners behind) as 3 vertices around (x, y), in screen pixels
+static void boid_triangle(SDL_Vertex* vertices, float x, float y, float vx, float vy, float size, SDL_Color color) {
+    float half = size / 2.0f;
+    const float corners[3][2] = {{0.0f, -size}, {-half, size}, {half, size}};
+    float angle = atan2(vy, vx) + M_PI / 2.0f; // add 90 degrees to point in direction of velocity
+    float cos_a = cos(angle);
+    float sin_a = sin(angle);
+    for (int corner = 0; corner < 3; corner++) {
+        SDL_Vertex& vertex = vertices[corner];
+        vertex.position.x = x + (corners[corner][0] * cos_a - corners[corner][1] * sin_a);
+        vertex.position.y = y + (corners[corner][0] * sin_a + corners[corner][1] * cos_a);
+        vertex.color = color;
+        vertex.tex_coord.x = vertex.tex_coord.y = 0.0f;
+    }
+}
+
+// boids keep a few pixels when zoomed out, until the density splat takes over
+static float screen_boid_size(float zoom) {
+    return std::max(simulation_config.BOID_TRIANGLE_SIZE * zoom, 2.0f);
+}
+
+
 bool Renderer::init(int width, int height) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0){
         return false;
@@ -25,11 +53,16 @@ bool Renderer::init(int width, int height) {
         return false; 
     }
 
+    window_width = width;
+    window_height = height;
+    clamp_camera();
+
     return true;
 }
 
 
-void Renderer::render(const std::vector<Boid>& boids, SDL_Color background_color, SDL_Color boid_color) {
+void Renderer::render(const std::vector<Boid>& boids, RgbaColor background_color, RgbaColor boid_color, 
+                      const std::vector<unsigned char>* alive, const ObstacleField* obstacles) {
     // clear screen
     SDL_SetRenderDrawColor(renderer, background_color.r, background_color.g, background_color.b, 255); // black background
     SDL_RenderClear(renderer);
@@ -50,18 +83,220 @@ void Renderer::render(const std::vector<Boid>& boids, SDL_Color background_color
         draw_grid();
     }
 
+    // draw obstacles / attractors if there are any
+    if (obstacles && !obstacles->empty()) {
+        draw_obstacles(*obstacles);
+    }
+
     // render boids as triangles
-    for (const Boid& boid : boids){
+    for (size_t i = 0; i < boids.size(); i++){
+        if (alive && !(*alive)[i]) continue; // dead pool slot
+        const Boid& boid = boids[i];
         float angle = atan2(boid.vy, boid.vx) + M_PI / 2.0f; // add 90 degrees to point in direction of velocity
-        SDL_Color color = boid_color; // use passed in boid color
+        SDL_Color color = to_sdl_color(boid_color); // use passed in boid color
         draw_boid(boid.x, boid.y, angle, color);
     }
+    draw_highlighted();
 
     // present the rendered frame
     SDL_RenderPresent(renderer);
 }
 
 
+// ================= TASK GRAPH RENDERING =================
+
+void Renderer::begin_blocks(int blocks) {
+    // (the lists keep their capacity from frame to frame)
+    if (static_cast<int>(block_vertices.size()) < blocks) block_vertices.resize(blocks);
+    active_blocks = blocks;
+}
+
+
+void Renderer::write_block(int block, const std::vector<Boid>& boids, const std::vector<int>& members) {
+    // the same triangle as draw_boid (tip forward, two corners behind), filled by the GPU instead of line by line
+    std::vector<SDL_Vertex>& vertices = block_vertices[block];
+    vertices.resize(members.size() * 3);
+    SDL_Color color = to_sdl_color(simulation_config.BOID_COLOR);
+    float size = screen_boid_size(zoom);
+
+    for (size_t m = 0; m < members.size(); m++) {
+        const Boid& boid = boids[members[m]];
+        boid_triangle(&vertices[m * 3], to_screen_x(boid.x), to_screen_y(boid.y), boid.vx, boid.vy, size, color);
+    }
+}
+
+
+void Renderer::render_blocks(RgbaColor background_color, const ObstacleField* obstacles) {
+    SDL_SetRenderDrawColor(renderer, background_color.r, background_color.g, background_color.b, 255);
+    SDL_RenderClear(renderer);
+
+    if (simulation_config.SHOW_GRID) {
+        draw_grid();
+    }
+    if (obstacles && !obstacles->empty()) {
+        draw_obstacles(*obstacles);
+    }
+
+    for (int block = 0; block < active_blocks; block++) {
+        const std::vector<SDL_Vertex>& vertices = block_vertices[block];
+        if (vertices.empty()) continue;
+        SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()), nullptr, 0);
+    }
+    draw_highlighted();
+
+    SDL_RenderPresent(renderer);
+}
+
+
+// ================= CAMERA VIEW RENDERING =================
+
+void Renderer::render_view(const SpatialSnapshot& snapshot, RgbaColor background_color, RgbaColor boid_color, 
+                           const std::vector<Boid>* positions, const ObstacleField* obstacles) {
+    clamp_camera();
+    SDL_SetRenderDrawColor(renderer, background_color.r, background_color.g, background_color.b, 255);
+    SDL_RenderClear(renderer);
+
+    if (simulation_config.SHOW_GRID) {
+        draw_grid();
+    }
+    if (obstacles && !obstacles->empty()) {
+        draw_obstacles(*obstacles);
+    }
+
+    // the part of the world in view
+    float min_x = std::max(0.0f, camera_x);
+    float min_y = std::max(0.0f, camera_y);
+    float max_x = std::min(snapshot.get_world_width(), camera_x + window_width / zoom);
+    float max_y = std::min(snapshot.get_world_height(), camera_y + window_height / zoom);
+
+    // cell counts first (cheap), they decide between boids and the splat
+    snapshot.query_cells(min_x, min_y, max_x, max_y, view_cells);
+    int visible = 0, densest = 0;
+    for (const SpatialCell& cell : view_cells) {
+        visible += cell.count;
+        densest = std::max(densest, cell.count);
+    }
+    drawn_boids = 0;
+    splat_cells = 0;
+
+    if (snapshot.get_cell_size() * zoom < simulation_config.DENSITY_SPLAT_CELL_PIXELS || 
+        visible > simulation_config.RENDER_MAX_VISIBLE_BOIDS) {
+        // ================= DENSITY SPLAT =================
+        // one quad per non-empty cell, from the background color (empty) to the boid color (densest cell in view)
+        view_vertices.resize(view_cells.size() * 6);
+        for (size_t c = 0; c < view_cells.size(); c++) {
+            const SpatialCell& cell = view_cells[c];
+            float t = std::sqrt(static_cast<float>(cell.count) / densest);
+            SDL_Color color = {static_cast<Uint8>(background_color.r + (boid_color.r - background_color.r) * t),
+                               static_cast<Uint8>(background_color.g + (boid_color.g - background_color.g) * t),
+                               static_cast<Uint8>(background_color.b + (boid_color.b - background_color.b) * t), 255};
+            float left = to_screen_x(cell.min_x), right = to_screen_x(cell.max_x);
+            float top = to_screen_y(cell.min_y), bottom = to_screen_y(cell.max_y);
+            const float corners[6][2] = {{left, top}, {right, top}, {right, bottom}, {left, top}, {right, bottom}, {left, bottom}};
+            for (int corner = 0; corner < 6; corner++) {
+                SDL_Vertex& vertex = view_vertices[c * 6 + corner];
+                vertex.position.x = corners[corner][0];
+                vertex.position.y = corners[corner][1];
+                vertex.color = color;
+                vertex.tex_coord.x = vertex.tex_coord.y = 0.0f;
+            }
+        }
+        splat_cells = static_cast<int>(view_cells.size());
+    } else {
+        // ================= BOIDS IN VIEW =================
+        // a boid just outside the view still reaches into it with its triangle (and interpolated positions 
+        // can be up to one step away from the snapshot's)
+        float size = screen_boid_size(zoom);
+        float margin = size * 2.0f / zoom;
+        if (positions) margin += simulation_config.MAX_SPEED * simulation_config.FIXED_STEP_SECONDS * simulation_config.SPEED;
+        snapshot.query_box(min_x - margin, min_y - margin, max_x + margin, max_y + margin, view_hits);
+
+        view_vertices.resize(view_hits.size() * 3);
+        for (size_t h = 0; h < view_hits.size(); h++) {
+            const SpatialHit& hit = view_hits[h];
+            const Boid& boid = (positions && hit.slot < static_cast<int>(positions->size())) ? (*positions)[hit.slot] : hit.boid;
+            boid_triangle(&view_vertices[h * 3], to_screen_x(boid.x), to_screen_y(boid.y), boid.vx, boid.vy, size, to_sdl_color(boid_color));
+        }
+        drawn_boids = static_cast<int>(view_hits.size());
+    }
+    if (!view_vertices.empty()) {
+        SDL_RenderGeometry(renderer, nullptr, view_vertices.data(), static_cast<int>(view_vertices.size()), nullptr, 0);
+    }
+    draw_highlighted();
+
+    SDL_RenderPresent(renderer);
+}
+
+
+// ================= CAMERA =================
+
+void Renderer::clamp_camera() {
+    float world_width = static_cast<float>(simulation_config.get_world_width());
+    float world_height = static_cast<float>(simulation_config.get_world_height());
+    if (window_width <= 0 || window_height <= 0 || world_width <= 0.0f || world_height <= 0.0f) return;
+
+    // zoomed out at most until the whole world fits (never past 1:1 for a world smaller than the window)
+    float fit = std::min(window_width / world_width, window_height / world_height);
+    float min_zoom = std::min(1.0f, fit);
+    float max_zoom = std::max(min_zoom, simulation_config.CAMERA_MAX_ZOOM);
+    zoom = std::max(min_zoom, std::min(zoom, max_zoom));
+
+    float view_width = window_width / zoom;
+    float view_height = window_height / zoom;
+    camera_x = view_width >= world_width ? (world_width - view_width) / 2.0f : std::max(0.0f, std::min(camera_x, world_width - view_width));
+    camera_y = view_height >= world_height ? (world_height - view_height) / 2.0f : std::max(0.0f, std::min(camera_y, world_height - view_height));
+}
+
+
+void Renderer::pan(float screen_dx, float screen_dy) {
+    camera_x += screen_dx / zoom;
+    camera_y += screen_dy / zoom;
+    clamp_camera();
+}
+
+
+void Renderer::zoom_at(float factor, float screen_x, float screen_y) {
+    float x, y;
+    screen_to_world(screen_x, screen_y, x, y);
+    zoom *= factor;
+    clamp_camera();
+    camera_x = x - screen_x / zoom;
+    camera_y = y - screen_y / zoom;
+    clamp_camera();
+}
+
+
+void Renderer::reset_camera() {
+    float world_width = static_cast<float>(simulation_config.get_world_width());
+    float world_height = static_cast<float>(simulation_config.get_world_height());
+    zoom = std::min(window_width / world_width, window_height / world_height);
+    camera_x = 0.0f;
+    camera_y = 0.0f;
+    clamp_camera();
+}
+
+
+void Renderer::screen_to_world(float screen_x, float screen_y, float& x, float& y) const {
+    x = camera_x + screen_x / zoom;
+    y = camera_y + screen_y / zoom;
+}
+
+
+bool Renderer::camera_is_identity() const {
+    return zoom == 1.0f && camera_x == 0.0f && camera_y == 0.0f &&
+           simulation_config.get_world_width() == window_width && simulation_config.get_world_height() == window_height;
+}
+
+
+void Renderer::draw_highlighted() {
+    if (!highlighted) return;
+    for (const SpatialHit& hit : *highlighted) {
+        float angle = atan2(hit.boid.vy, hit.boid.vx) + M_PI / 2.0f;
+        draw_boid(hit.boid.x, hit.boid.y, angle, to_sdl_color(simulation_config.HIGHLIGHT_COLOR));
+    }
+}
+
+
 void Renderer::cleanup() {
     if (renderer) {
         SDL_DestroyRenderer(renderer);
@@ -77,7 +312,10 @@ void Renderer::cleanup() {
 void Renderer::draw_boid(float x, float y, float angle, SDL_Color color) {
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
 
-    float size = simulation_config.BOID_TRIANGLE_SIZE;
+    // world position -> screen
+    x = to_screen_x(x);
+    y = to_screen_y(y);
+    float size = screen_boid_size(zoom);
     float half = size / 2.0f;
 
     // this is the first triangle tip (centered and pointing upwards)
@@ -125,16 +363,52 @@ void Renderer::draw_grid() {
     SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255); // dark gray grid lines
 
     float cell_size = simulation_config.GRID_CELL_SIZE;
-    int width = simulation_config.WINDOW_WIDTH;
-    int height = simulation_config.WINDOW_HEIGHT;
+    if (cell_size * zoom < 4.0f) return; // (the lines would cover the whole window)
+
+    // only the lines in view (and inside the world)
+    float left = std::max(0.0f, camera_x);
+    float top = std::max(0.0f, camera_y);
+    float right = std::min(static_cast<float>(simulation_config.get_world_width()), camera_x + window_width / zoom);
+    float bottom = std::min(static_cast<float>(simulation_config.get_world_height()), camera_y + window_height / zoom);
 
     // draw vertical lines
-    for (float x = 0; x <= width; x += cell_size) {
-        SDL_RenderDrawLine(renderer, x, 0, x, height);
+    for (int column = static_cast<int>(std::ceil(left / cell_size)); column * cell_size <= right; column++) {
+        float x = to_screen_x(column * cell_size);
+        SDL_RenderDrawLine(renderer, x, to_screen_y(top), x, to_screen_y(bottom));
     }
 
     // draw horizontal lines
-    for (float y = 0; y <= height; y += cell_size) {
-        SDL_RenderDrawLine(renderer, 0, y, width, y);
+    for (int row = static_cast<int>(std::ceil(top / cell_size)); row * cell_size <= bottom; row++) {
+        float y = to_screen_y(row * cell_size);
+        SDL_RenderDrawLine(renderer, to_screen_x(left), y, to_screen_x(right), y);
     }
+}
+
+void Renderer::draw_obstacles(const ObstacleField& field) {
+    // draws the baked field itself (what the boids actually feel), one square per sample inside a shape
+    // (only the samples in view, and only every stride-th one once samples get smaller than a pixel)
+    std::vector<SDL_Rect> obstacle_cells, attractor_cells;
+    float resolution = field.get_resolution();
+    int stride = std::max(1, static_cast<int>(1.0f / (resolution * zoom)));
+    int size = static_cast<int>(std::ceil(resolution * zoom * stride));
+    int first_column = std::max(0, static_cast<int>(camera_x / resolution) - 1);
+    int first_row = std::max(0, static_cast<int>(camera_y / resolution) - 1);
+    int last_column = std::min(field.get_columns() - 1, static_cast<int>((camera_x + window_width / zoom) / resolution) + 1);
+    int last_row = std::min(field.get_rows() - 1, static_cast<int>((camera_y + window_height / zoom) / resolution) + 1);
+    first_column -= first_column % stride;
+    first_row -= first_row % stride;
+    for (int row = first_row; row <= last_row; row += stride) {
+        for (int column = first_column; column <= last_column; column += stride) {
+            const FieldSample& sample = field.at(column, row);
+            SDL_Rect cell = {static_cast<int>(to_screen_x(column * resolution)) - size / 2, 
+                             static_cast<int>(to_screen_y(row * resolution)) - size / 2, size, size};
+            if (sample.obstacle_distance <= 0.0f) obstacle_cells.push_back(cell);
+            else if (sample.attractor_distance <= 0.0f) attractor_cells.push_back(cell);
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 110, 60, 60, 255); // dull red obstacles
+    if (!obstacle_cells.empty()) SDL_RenderFillRects(renderer, obstacle_cells.data(), static_cast<int>(obstacle_cells.size()));
+    SDL_SetRenderDrawColor(renderer, 50, 120, 60, 255); // green attractors
+    if (!attractor_cells.empty()) SDL_RenderFillRects(renderer, attractor_cells.data(), static_cast<int>(attractor_cells.size()));
 }
\ No newline at end of file
@@ -1,5 +1,15 @@
 /*
 handles rendering each step of the simulation 
+- render() draws straight from the boid array
+- when the simulation runs as a task graph, the renderer is its BlockOutput: the triangles of every 
+  block are built on the worker threads right after the block's update (write_block), and 
+  render_blocks() only has to submit them (one SDL_RenderGeometry call per block)
+- camera: the window shows the world from (camera_x, camera_y) at zoom pixels per world unit. as long as
+  that is the whole world 1:1 (camera_is_identity) the paths above draw in world coordinates as before.
+  otherwise render_view() draws from a SpatialSnapshot: it only asks the snapshot's grid for the cells
+  and boids in view, so the cost follows what is on screen rather than the population, and once the
+  cells get smaller than DENSITY_SPLAT_CELL_PIXELS (or too many boids are in view) it draws one shaded
+  quad per cell (a density splat) instead of the boids
 */
 
 
@@ -7,17 +17,78 @@ handles rendering each step of the simulation
 #include <vector>
 #include <SDL.h>
 #include "boid.hpp"
+#include "obstacle_field.hpp"
+#include "simulation_config.hpp"
+#include "simulation.hpp"
+#include "spatial_index.hpp"
 
-class Renderer {
+class Renderer : public BlockOutput {
     private:
         SDL_Window* window = nullptr;
         SDL_Renderer* renderer = nullptr;
 
+        // triangles (3 vertices per boid) written by write_block, one list per block
+        std::vector<std::vector<SDL_Vertex>> block_vertices;
+        int active_blocks = 0;
+
+        // boids drawn again on top in HIGHLIGHT_COLOR (results of a spatial query), nullptr = none
+        const std::vector<SpatialHit>* highlighted = nullptr;
+        void draw_highlighted();
+
+        // ================= CAMERA =================
+        // world = camera + screen / zoom
+        int window_width = 0, window_height = 0;
+        float camera_x = 0.0f, camera_y = 0.0f;
+        float zoom = 1.0f;
+        // zoom in [whole world fits the window, CAMERA_MAX_ZOOM], the view stays inside the world (a world
+        // smaller than the view is centered)
+        void clamp_camera();
+        float to_screen_x(float x) const { return (x - camera_x) * zoom; }
+        float to_screen_y(float y) const { return (y - camera_y) * zoom; }
+
+        // render_view scratch (kept between frames)
+        std::vector<SpatialCell> view_cells;
+        std::vector<SpatialHit> view_hits;
+        std::vector<SDL_Vertex> view_vertices;
+        int drawn_boids = 0;
+        int splat_cells = 0;
+
     public:
         bool init(int width, int height);
-        void render(const std::vector<Boid>& boids, SDL_Color background_color, SDL_Color boid_color);
+        // alive = optional per-slot live mask from the boid pool (dead slots aren't drawn)
+        // obstacles = optional obstacle field (drawn underneath the boids)
+        void render(const std::vector<Boid>& boids, RgbaColor background_color, RgbaColor boid_color, 
+                    const std::vector<unsigned char>* alive = nullptr, const ObstacleField* obstacles = nullptr);
+        // draws the triangles the last task graph step wrote (see BlockOutput)
+        void render_blocks(RgbaColor background_color, const ObstacleField* obstacles = nullptr);
+        // draws the part of the snapshot in view (or its density splat). positions = optional boids to draw
+        // instead of the snapshot's own (indexed by slot, like the interpolated boids of a TimeStepper)
+        void render_view(const SpatialSnapshot& snapshot, RgbaColor background_color, RgbaColor boid_color, 
+                         const std::vector<Boid>* positions = nullptr, const ObstacleField* obstacles = nullptr);
+        // boids the last render_view drew, and the cells it splatted instead (0 unless zoomed far out)
+        int get_drawn_boids() const { return drawn_boids; }
+        int get_splat_cells() const { return splat_cells; }
+
+        // ================= CAMERA =================
+        // screen pixels, the view moves by that much
+        void pan(float screen_dx, float screen_dy);
+        // zooms by factor keeping the world point under (screen_x, screen_y) where it is
+        void zoom_at(float factor, float screen_x, float screen_y);
+        // back to the whole world, as large as fits the window
+        void reset_camera();
+        void screen_to_world(float screen_x, float screen_y, float& x, float& y) const;
+        float get_zoom() const { return zoom; }
+        // whether the window shows exactly the whole world at zoom 1 (then the simulation's coordinates are
+        // the screen's and the plain render paths can be used)
+        bool camera_is_identity() const;
+        void set_highlight(const std::vector<SpatialHit>* hits) {
+            highlighted = hits;
+        }
+        void begin_blocks(int blocks) override;
+        void write_block(int block, const std::vector<Boid>& boids, const std::vector<int>& members) override;
         void draw_boid(float x, float y, float angle, SDL_Color color);
         void draw_grid();
+        void draw_obstacles(const ObstacleField& field);
         void cleanup();
 
 };
\ No newline at end of file
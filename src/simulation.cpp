@@ -4,128 +4,157 @@
 #include "simulation.hpp"
 #include "simulation_config.hpp"
 #include "simulation_stats.hpp"
+#include "perf_counters.hpp"
+#include "flock_kernels.hpp"
+#include "timing.hpp"
 #include <cmath>
-#include <SDL.h>
+#include <algorithm>
 #include <iostream>
 
-static void limit_speed(Boid& boid) {
-    float speed = std::sqrt(boid.vx * boid.vx + boid.vy * boid.vy);
-    if (speed > simulation_config.MAX_SPEED) {
-        boid.vx = (boid.vx / speed) * simulation_config.MAX_SPEED;
-        boid.vy = (boid.vy / speed) * simulation_config.MAX_SPEED;
+// ================= TEMPORAL LOD =================
+/* 
+a boid can skip its neighbor search + steering this frame (and just keep flying straight) if
+ - it was isolated or barely steering at its last full update
+ - its last full update was less than lod_interval frames ago (hard bound on how stale it can get)
+ - it hasn't drifted more than lod_max_drift since then (so its neighborhood can't have changed much)
+ - it isn't within reach of an obstacle or attractor (field = nullptr when obstacles are off), a skipped 
+   boid doesn't steer so it would fly straight into a wall
+*/
+static bool lod_can_skip(const BoidLod& lod, const Boid& boid, const SimulationParams& params, const ObstacleField* field) {
+    if (!lod.low_activity || lod.frames_since_full + 1 >= params.lod_interval) {
+        return false;
     }
+    float dx = boid.x - lod.anchor_x;
+    float dy = boid.y - lod.anchor_y;
+    if (dx*dx + dy*dy >= params.lod_max_drift_sq) {
+        return false;
+    }
+    if (field) {
+        FieldSample sample = field->sample(boid.x, boid.y);
+        if (sample.obstacle_distance < params.obstacle_avoid_range || sample.attractor_distance < params.attractor_range) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// called after a full update to decide how the boid is treated for the next frames
+static void lod_classify(BoidLod& lod, const Boid& old_boid, const Boid& new_boid, long long neighbors_found, const SimulationParams& params) {
+    float steer_x = new_boid.vx - old_boid.vx;
+    float steer_y = new_boid.vy - old_boid.vy;
+    bool isolated = neighbors_found <= params.lod_neighbor_threshold;
+    bool stable = (steer_x*steer_x + steer_y*steer_y) <= params.lod_steer_threshold_sq;
+
+    lod.low_activity = isolated || stable;
+    lod.frames_since_full = 0;
+    lod.anchor_x = new_boid.x;
+    lod.anchor_y = new_boid.y;
+}
+
+// (re)creates the per-boid LOD data when the population changed (both the OpenMP and the task graph path). 
+// new entries start as active (so they get a full update first) with staggered counters so low activity 
+// boids don't all refresh on the same frame
+static void lod_resize(std::vector<BoidLod>& lod, size_t num_boids, const SimulationParams& params) {
+    if (!params.lod_enabled || lod.size() == num_boids) return;
+    size_t old_size = std::min(lod.size(), num_boids);
+    lod.resize(num_boids);
+    for (size_t i = old_size; i < lod.size(); i++) {
+        lod[i] = BoidLod();
+        lod[i].frames_since_full = static_cast<unsigned char>(i % params.lod_interval);
+    }
+}
+
+// position-only integration for boids skipped by the LOD scheduler
+static void integrate_position(int i, const std::vector<Boid>& boids, std::vector<Boid>& new_boids, float dt, const SimulationParams& params) {
+    new_boids[i].x = boids[i].x + boids[i].vx * dt;
+    new_boids[i].y = boids[i].y + boids[i].vy * dt;
+    wrap_position<2>(new_boids[i], params);
 }
 
+
 // will return three values: total checked candidates, total neighbors found, time taken for get neighbors caclculation
- std::tuple<long long, long long, float> Simulation::update_void(int i, const std::vector<Boid>& boids, std::vector<Boid>& new_boids, float dt) {
+ std::tuple<long long, long long, float> Simulation::update_void(int i, const std::vector<Boid>& boids, std::vector<Boid>& new_boids, float dt, SimulationParams params,
+                                                                   const NeighborSums* precomputed_sums) {
     const Boid& boid = boids[i];   
     long long checked_candidates = 0;
     long long neighbors_found = 0;
 
     // ================= GET NEIGHBORS START =================
-    Uint64 ns_start_time = SDL_GetPerformanceCounter();
-    std::tuple<std::vector<int>, long long> answers = neighbor_search->get_neighbors(boids, i);
-    Uint64 ns_end_time = SDL_GetPerformanceCounter();
-    std::vector<int> neighbors = std::get<0>(answers);
-    checked_candidates = std::get<1>(answers);
-    float get_neighbors_calc_time_ms = (ns_end_time - ns_start_time) * 1000.0f / SDL_GetPerformanceFrequency();
-    // simulation_stats.get_neighbors_calc_time_ms = (ns_end_time - ns_start_time) * 1000.0f / SDL_GetPerformanceFrequency();
+    double ns_start_time = steady_now_ms();
+    // the summed up neighbor terms either come precomputed (symmetric pair pass), straight from the search 
+    // (far-field mode, whole cells inside the perception radius are added as aggregates), or we get the 
+    // list of neighbors and sum them up below
+    NeighborSums neighbor_sums;
+    bool have_sums = false;
+    if (precomputed_sums) {
+        neighbor_sums = *precomputed_sums;
+        have_sums = true;
+    } else if (params.far_field_enabled) {
+        have_sums = neighbor_search->accumulate_neighbor_sums(boids, i, params, neighbor_sums);
+    }
+    std::vector<int> neighbors;
+    if (!have_sums) {
+        std::tuple<std::vector<int>, long long> answers = neighbor_search->get_neighbors(boids, i, params);
+        neighbors = std::move(std::get<0>(answers));
+        checked_candidates = std::get<1>(answers);
+    } else {
+        checked_candidates = neighbor_sums.checked_candidates;
+    }
+    double ns_end_time = steady_now_ms();
+    float get_neighbors_calc_time_ms = static_cast<float>(ns_end_time - ns_start_time);
+    // simulation_stats.get_neighbors_calc_time_ms = static_cast<float>(ns_end_time - ns_start_time);
     // ================= GET NEIGHBORS END =================
 
     // track total neighbor checks and found neighbors
-    checked_candidates = checked_candidates;
-    neighbors_found = neighbors.size();
+    neighbors_found = have_sums ? neighbor_sums.count : neighbors.size();
     
 
-    // initial steering shifts 
-    float steer_x = 0.0f;
-    float steer_y = 0.0f;
-
-    // only compute steering according to other boids IF there are neighbors
-    if (!neighbors.empty()) {
-        // (alignment, cohesion, separation)
-        float align_x = 0.0f, align_y = 0.0f;
-        float coh_x = 0.0f, coh_y = 0.0f;
-        float sep_x = 0.0f, sep_y = 0.0f;
+    // ================= STEERING (alignment, cohesion, separation) =================
+    // (the dimension generic kernels from flock_kernels.hpp, D = 2 compiles to the plain x / y math)
+    FlockSums<2> sums;
+    sums.align[0] = neighbor_sums.align_x; sums.align[1] = neighbor_sums.align_y;
+    sums.coh[0] = neighbor_sums.coh_x;     sums.coh[1] = neighbor_sums.coh_y;
+    sums.sep[0] = neighbor_sums.sep_x;     sums.sep[1] = neighbor_sums.sep_y;
 
-        // for each neighbor (that is close enough to affect this boid), calculate how much the boid 
-        // should be steered
+    // for each neighbor (that is close enough to affect this boid), add it to the sums
+    // (with periodic boundaries a neighbor may be across the wrap, so its closest image is used)
+    if (params.periodic_boundaries) {
+        for (int neighbor_index : neighbors) {
+            if (neighbor_index == i) continue;
+            accumulate_neighbor<2, true>(sums, boid, boids[neighbor_index], &params);
+        }
+    } else {
         for (int neighbor_index : neighbors) {
             // skip self (shouldn't ever run bc we handled this in neighbor search, but just as a sanity check)
             if (neighbor_index == i) continue; 
-
-            const Boid& neighbor = boids[neighbor_index];
-
-            // calc alignment 
-            align_x += neighbor.vx;
-            align_y += neighbor.vy;
-
-            // calc cohesion
-            coh_x += neighbor.x;
-            coh_y += neighbor.y;
-
-            // separation pt1 - calc separation
-            float dx = boid.x - neighbor.x;
-            float dy = boid.y - neighbor.y;
-
-            // separation pt2 - use inverse square distance for stronger repulsion when closer
-            float distance_sq = dx*dx + dy*dy;
-            if (distance_sq < 0.0001f) distance_sq = 0.0001f; // prevent division by zero
-            // apply inverse-square separation (stronger repulsion when closer, like magnets)
-            sep_x += dx / distance_sq;
-            sep_y += dy / distance_sq;
-
+            accumulate_neighbor<2>(sums, boid, boids[neighbor_index]);
         }
+    }
 
-        int num_neighbors = neighbors.size();
-
-        if (num_neighbors > 0) { // to avoid dividing by zero
-            // calc the average alignment considering all neighbors
-            align_x /= num_neighbors;
-            align_y /= num_neighbors;
-
-            // calc the average cohestion considering all neighbors
-            coh_x /= num_neighbors;
-            coh_y /= num_neighbors;
-            // move towards the average position of neighbors
-            coh_x -= boid.x;
-            coh_y -= boid.y;
+    float steer[2];
+    flock_steering<2>(sums, neighbors_found, boid, params, steer);
+    float& steer_x = steer[0];
+    float& steer_y = steer[1];
+
+    // ================= OBSTACLES / ATTRACTORS =================
+    // one lookup into the baked distance field, however many obstacles there are
+    if (params.obstacles_enabled && obstacle_field && !obstacle_field->empty()) {
+        FieldSample field = obstacle_field->sample(boid.x, boid.y);
+        if (field.obstacle_distance < params.obstacle_avoid_range) {
+            // push away along the gradient, harder the closer we get (and hardest once inside)
+            float push = std::min(2.0f, 1.0f - field.obstacle_distance * params.inv_obstacle_avoid_range);
+            steer_x += field.obstacle_gx * push * params.obstacle_weight;
+            steer_y += field.obstacle_gy * push * params.obstacle_weight;
+        }
+        if (field.attractor_distance < params.attractor_range && field.attractor_distance > 0.0f) {
+            // pull in (against the gradient), stops at the attractor's edge
+            steer_x -= field.attractor_gx * params.attractor_weight;
+            steer_y -= field.attractor_gy * params.attractor_weight;
         }
-
-        // Apply weights
-        steer_x += (align_x - boid.vx) * simulation_config.ALIGNMENT_WEIGHT;
-        steer_y += (align_y - boid.vy) * simulation_config.ALIGNMENT_WEIGHT;
-
-        steer_x += (coh_x) * simulation_config.COHESION_WEIGHT;
-        steer_y += (coh_y) * simulation_config.COHESION_WEIGHT;
-
-        steer_x += (sep_x) * simulation_config.SEPARATION_WEIGHT;
-        steer_y += (sep_y) * simulation_config.SEPARATION_WEIGHT;
     }
 
-    // add steering onto existing velocity
-    new_boids[i].vx = boid.vx + steer_x;
-    new_boids[i].vy = boid.vy + steer_y;
-
-    limit_speed(new_boids[i]);
-
-    // update position based on new velocity
-    new_boids[i].x += new_boids[i].vx * dt;
-    new_boids[i].y += new_boids[i].vy * dt;
-
-    // wrap around screen edges
-    if (new_boids[i].x < 0) {                               // if to left of screen, wrap to right
-        new_boids[i].x += simulation_config.WINDOW_WIDTH;
-    }
-    if (new_boids[i].x >= simulation_config.WINDOW_WIDTH) { // if to right of screen, wrap to left
-        new_boids[i].x -= simulation_config.WINDOW_WIDTH;
-    }
-    if (new_boids[i].y < 0) {                               // if above screen, wrap to bottom
-        new_boids[i].y += simulation_config.WINDOW_HEIGHT;
-    }
-    if (new_boids[i].y >= simulation_config.WINDOW_HEIGHT) { // if below screen, wrap to top
-        new_boids[i].y -= simulation_config.WINDOW_HEIGHT;
-    }
+    // add steering onto existing velocity, limit the speed, move and wrap around the screen
+    integrate<2>(new_boids[i], boid, steer, dt, params);
 
     return {checked_candidates, neighbors_found, get_neighbors_calc_time_ms};
 }
@@ -138,76 +167,384 @@ void Simulation::update(SimulationState& state, float dt) {
     //     omp_set_num_threads(1);
     // }
 
+    // take a read-only snapshot of the config for this step. anything changed by handle_input 
+    // (or anywhere else) is picked up at the start of the next step, never halfway through one
+    update(state, dt, SimulationParams::from_config(simulation_config), simulation_stats);
+}
+
+
+void Simulation::update(SimulationState& state, float dt, const SimulationParams params, SimulationStats& stats) {
+    // pack the boid pool back together once enough boids have been killed
+    if (state.needs_compaction()) state.compact(params.parallelism_enabled);
+
+    // persistent workers + one graph per step, unless the symmetric pair pass is on (see simulation.hpp)
+    used_task_graph = executor && params.parallelism_enabled && params.task_graph_enabled && 
+                      !(params.symmetric_pairs_enabled && !params.far_field_enabled);
+    if (used_task_graph) {
+        update_task_graph(state, dt, params, stats);
+        return;
+    }
+
     std::vector<Boid> boids = state.boids;
+    // dead pool slots are skipped everywhere below (no mask at all while every slot is live)
+    const bool has_dead_slots = state.has_dead_slots();
+    const unsigned char* alive = has_dead_slots ? state.alive.data() : nullptr;
+    neighbor_search->set_alive_mask(has_dead_slots ? &state.alive : nullptr);
 
     
     // ================= CALCULATE NEIGHBORS START =================
-    Uint64 start_time = SDL_GetPerformanceCounter();
-    neighbor_search->build(boids);
-    Uint64 end_time = SDL_GetPerformanceCounter();
-    simulation_stats.grid_map_hash_time_ms = (end_time - start_time) * 1000.0f / SDL_GetPerformanceFrequency();
+    PerfSample build_perf_start;
+    if (params.perf_counters_enabled) build_perf_start = read_thread_counters();
+    double start_time = steady_now_ms();
+    neighbor_search->build(boids, params);
+    double end_time = steady_now_ms();
+    stats.grid_map_hash_time_ms = static_cast<float>(end_time - start_time);
+    if (params.perf_counters_enabled) stats.build_perf = read_thread_counters() - build_perf_start;
     // ================= CALCULATE NEIGHBORS END =================
 
     std::vector<Boid> new_boids = boids; // copy current boids to update to prevent weird results
     long long total_checked_candidates = 0;
     long long total_neighbors_found = 0;
     float temp_get_neighbors_time = 0.0f;
+    PerfSample update_perf; // summed over all threads
+
+    // ================= SYMMETRIC PAIR PASS =================
+    // (far-field takes precedence, it needs the per-boid traversal)
+    const NeighborSums* all_sums = nullptr;
+    if (params.symmetric_pairs_enabled && !params.far_field_enabled) {
+        double pairs_start_time = steady_now_ms();
+        if (neighbor_search->accumulate_all_neighbor_sums(boids, params, pair_sums)) {
+            all_sums = pair_sums.data();
+        }
+        double pairs_end_time = steady_now_ms();
+        // counted as neighbor search time (summed over threads like the per-boid path)
+        int pair_threads = params.parallelism_enabled ? omp_get_max_threads() : 1;
+        temp_get_neighbors_time += static_cast<float>(pairs_end_time - pairs_start_time) * pair_threads;
+    }
 
+    // ================= LOD SETUP =================
+    std::vector<BoidLod>& lod = state.lod;
+    long long lod_skipped = 0;
+    // skipped boids don't steer, so the scheduler has to check the obstacle field first (if it's in use)
+    const ObstacleField* lod_field = (params.obstacles_enabled && obstacle_field && !obstacle_field->empty()) ? obstacle_field : nullptr;
+    lod_resize(lod, boids.size(), params);
 
-    if (simulation_config.PARALLELISM_ENABLED) {
+
+    if (params.parallelism_enabled) {
+        // record number of threads used (outside of the parallel region so the workers never write shared state)
+        stats.num_threads = omp_get_max_threads();
         #pragma omp parallel 
         {
             // ================ PARALLEL VERSION START ================
-            // record number of threads used
-            #pragma omp master 
-            simulation_config.PARALLELISM_NUM_THREADS = omp_get_num_threads();
+            // each worker reads its own counters (they are opened per thread)
+            PerfSample thread_perf_start;
+            if (params.perf_counters_enabled) thread_perf_start = read_thread_counters();
+
             // for each boid, compute the new velocity based on neighbors (we can split this computation across threads)
-            #pragma omp for schedule(dynamic) reduction(+:total_checked_candidates) reduction(+:total_neighbors_found) reduction(+:temp_get_neighbors_time)
+            // (nowait so the counters below don't include time spent waiting on other threads, the 
+            //  reductions are still complete once the parallel region ends)
+            #pragma omp for schedule(dynamic) reduction(+:total_checked_candidates) reduction(+:total_neighbors_found) reduction(+:temp_get_neighbors_time) reduction(+:lod_skipped) nowait
             for (int i = 0; i < boids.size(); i++) {
-                // long long checked = 0;
-                // long long found = 0;
-                std::tuple<long long, long long, float> answers = update_void(i, boids, new_boids, dt);
+                if (alive && !alive[i]) continue;
+                // low activity boids only get their position integrated on most frames
+                if (params.lod_enabled && lod_can_skip(lod[i], boids[i], params, lod_field)) {
+                    integrate_position(i, boids, new_boids, dt, params);
+                    lod[i].frames_since_full++;
+                    lod_skipped++;
+                    continue;
+                }
+
+                std::tuple<long long, long long, float> answers = update_void(i, boids, new_boids, dt, params, all_sums ? &all_sums[i] : nullptr);
                 // we quickly add to totals using reductions instead of direcctly modifying shared variables
                 total_checked_candidates += std::get<0>(answers);
                 total_neighbors_found += std::get<1>(answers);
                 temp_get_neighbors_time += std::get<2>(answers);
+
+                if (params.lod_enabled) lod_classify(lod[i], boids[i], new_boids[i], std::get<1>(answers), params);
+            }
+
+            if (params.perf_counters_enabled) {
+                PerfSample thread_perf = read_thread_counters() - thread_perf_start;
+                #pragma omp critical
+                update_perf += thread_perf;
             }
             // ================ PARALLEL VERSION END ================
         }
-        simulation_stats.get_neighbors_calc_time_ms = temp_get_neighbors_time;
+        stats.get_neighbors_calc_time_ms = temp_get_neighbors_time;
     }
     else {
         // ================ SERIAL VERSION START ================
-        simulation_config.PARALLELISM_NUM_THREADS = 1;
-        simulation_stats.get_neighbors_calc_time_ms = 0.0f; // reset for each serial update, should only represent this frame's time
+        stats.num_threads = 1;
+        stats.get_neighbors_calc_time_ms = temp_get_neighbors_time; // reset for each serial update, should only represent this frame's time (+ the symmetric pair pass, if any)
+        PerfSample serial_perf_start;
+        if (params.perf_counters_enabled) serial_perf_start = read_thread_counters();
         // for each boid, compute the new velocity based on neighbors
         for (int i = 0; i < boids.size(); i++) {
-            // long long checked = 0; 
-            // long long found = 0;
+            if (alive && !alive[i]) continue;
+            // low activity boids only get their position integrated on most frames
+            if (params.lod_enabled && lod_can_skip(lod[i], boids[i], params, lod_field)) {
+                integrate_position(i, boids, new_boids, dt, params);
+                lod[i].frames_since_full++;
+                lod_skipped++;
+                continue;
+            }
 
-            std::tuple<long long, long long, float> answers = update_void(i, boids, new_boids, dt);
+            std::tuple<long long, long long, float> answers = update_void(i, boids, new_boids, dt, params, all_sums ? &all_sums[i] : nullptr);
             // we can add to totals since this is serial and no reducations are used
             total_checked_candidates += std::get<0>(answers);
             total_neighbors_found += std::get<1>(answers);
-            simulation_stats.get_neighbors_calc_time_ms += std::get<2>(answers);
+            stats.get_neighbors_calc_time_ms += std::get<2>(answers);
+
+            if (params.lod_enabled) lod_classify(lod[i], boids[i], new_boids[i], std::get<1>(answers), params);
          }
+        if (params.perf_counters_enabled) update_perf = read_thread_counters() - serial_perf_start;
         // ================ SERIAL VERSION END ================
     }
 
     // after all boids updated, update stats
-    simulation_stats.total_checked_candidates = total_checked_candidates;
-    simulation_stats.total_neighbors_found = total_neighbors_found;
+    if (params.perf_counters_enabled) {
+        stats.update_perf = update_perf;
+        stats.perf_counters_available = counters_available();
+    }
+    stats.total_checked_candidates = total_checked_candidates;
+    stats.total_neighbors_found = total_neighbors_found;
+
+    // averages only cover the (live) boids that actually ran a neighbor search this frame
+    const int num_live = state.num_live();
+    float fully_updated = std::max(1.0f, static_cast<float>(num_live - lod_skipped));
+    stats.avg_checked_neighbors = static_cast<float>(total_checked_candidates) / fully_updated;
+    stats.avg_neighbors = static_cast<float>(total_neighbors_found) / fully_updated;
 
-    simulation_stats.avg_checked_neighbors = static_cast<float>(total_checked_candidates) / static_cast<float>(boids.size());
-    simulation_stats.avg_neighbors = static_cast<float>(total_neighbors_found) / static_cast<float>(boids.size());
+    stats.lod_skipped_updates = static_cast<int>(lod_skipped);
+    stats.lod_skipped_fraction = (num_live == 0) ? 0.0f : static_cast<float>(lod_skipped) / static_cast<float>(num_live);
 
     
     // update the simulation state with new boid positions and velocities
     state.boids = new_boids;
     // std::cout << " total_checked=" << total_checked_candidates
-    //       << " avg_checked=" << simulation_stats.avg_checked_neighbors
+    //       << " avg_checked=" << stats.avg_checked_neighbors
     //       << " total_neighbors=" << total_neighbors_found
-    //       << " avg_neighbors=" << simulation_stats.avg_neighbors
+    //       << " avg_neighbors=" << stats.avg_neighbors
     //       << "\n";
 
-}
\ No newline at end of file
+}
+
+
+
+// ================= SPATIAL INDEX =================
+
+void Simulation::publish_snapshot(const SimulationState& state, const SimulationParams& params, SimulationStats& stats) {
+    if (!spatial_index) {
+        stats.snapshot_publish_time_ms = 0.0f;
+        return;
+    }
+    // (never waits on the readers, see spatial_index.hpp)
+    double start_time = steady_now_ms();
+    spatial_index->publish(state, params);
+    double end_time = steady_now_ms();
+    stats.snapshot_publish_time_ms = static_cast<float>(end_time - start_time);
+    stats.snapshots_retired = spatial_index->get_retired_count();
+}
+
+
+
+// ================= TASK GRAPH STEP =================
+
+void Simulation::update_task_graph(SimulationState& state, float dt, const SimulationParams& params, SimulationStats& stats) {
+    const std::vector<Boid>& boids = state.boids;
+    const int n = static_cast<int>(boids.size());
+    const bool has_dead_slots = state.has_dead_slots();
+    neighbor_search->set_alive_mask(has_dead_slots ? &state.alive : nullptr);
+
+    frame.state = &state;
+    frame.stats = &stats;
+    frame.alive = has_dead_slots ? state.alive.data() : nullptr;
+    frame.params = params;
+    frame.task_params = params;
+    frame.task_params.parallelism_enabled = false;
+    frame.dt = dt;
+
+    // ================= SHAPE OF THIS STEP =================
+    // (begin_block_build is the only part of the build that isn't split up, it is tiny for every search)
+    const int threads = executor->get_num_threads();
+    double begin_start_time = steady_now_ms();
+    GraphShape shape;
+    shape.blocks = std::max(1, neighbor_search->begin_block_build(boids, frame.task_params, threads * BLOCKS_PER_THREAD));
+    shape.reach = neighbor_search->block_reach(frame.task_params);
+    shape.chunks = std::max(1, std::min(threads * CHUNKS_PER_THREAD, n));
+    shape.wrap = params.periodic_boundaries;
+    shape.output = (block_output != nullptr);
+    double begin_end_time = steady_now_ms();
+    frame.begin_time_ms = static_cast<float>(begin_end_time - begin_start_time);
+
+    if (!(shape == graph_shape) || frame_graph.size() == 0) {
+        build_frame_graph(shape);
+    }
+
+    lod_resize(state.lod, boids.size(), params);
+
+    next_boids.resize(n);
+    if (block_output) block_output->begin_blocks(shape.blocks);
+    executor->run(frame_graph);
+
+    // the updated boids become the current ones (the old buffer is reused next step)
+    state.boids.swap(next_boids);
+}
+
+
+void Simulation::build_frame_graph(const GraphShape& shape) {
+    graph_shape = shape;
+    frame_graph.clear();
+    chunk_members.assign(shape.chunks, std::vector<std::vector<int>>(shape.blocks));
+    block_members.resize(shape.blocks);
+    block_results.resize(shape.blocks);
+    chunk_times_ms.resize(shape.chunks);
+
+    std::vector<int> bins(shape.chunks), builds(shape.blocks), updates(shape.blocks);
+    for (int chunk = 0; chunk < shape.chunks; chunk++) {
+        bins[chunk] = frame_graph.add_task([this, chunk](int) { run_bin_task(chunk); });
+    }
+    for (int block = 0; block < shape.blocks; block++) {
+        builds[block] = frame_graph.add_task([this, block](int) { run_build_task(block); });
+        for (int bin : bins) frame_graph.add_dependency(builds[block], bin);
+    }
+
+    // a block's update waits for the blocks its queries can read (and nothing else)
+    for (int block = 0; block < shape.blocks; block++) {
+        updates[block] = frame_graph.add_task([this, block](int) { run_update_task(block); });
+        std::vector<int> inputs;
+        if (2 * shape.reach + 1 >= shape.blocks) {
+            for (int other = 0; other < shape.blocks; other++) inputs.push_back(other);
+        } else {
+            for (int offset = -shape.reach; offset <= shape.reach; offset++) {
+                int other = block + offset;
+                if (shape.wrap) other = (other + shape.blocks) % shape.blocks;
+                else if (other < 0 || other >= shape.blocks) continue;
+                inputs.push_back(other);
+            }
+        }
+        for (int other : inputs) frame_graph.add_dependency(updates[block], builds[other]);
+
+        if (shape.output) {
+            int output = frame_graph.add_task([this, block](int) {
+                block_output->write_block(block, next_boids, block_members[block]);
+            });
+            frame_graph.add_dependency(output, updates[block]);
+        }
+    }
+
+    int reduce = frame_graph.add_task([this](int) { run_reduce_task(); });
+    for (int update : updates) frame_graph.add_dependency(reduce, update);
+}
+
+
+void Simulation::run_bin_task(int chunk) {
+    double start_time = steady_now_ms();
+    const std::vector<Boid>& boids = frame.state->boids;
+    const int n = static_cast<int>(boids.size());
+    const int begin = static_cast<int>(static_cast<long long>(n) * chunk / graph_shape.chunks);
+    const int end = static_cast<int>(static_cast<long long>(n) * (chunk + 1) / graph_shape.chunks);
+
+    std::vector<std::vector<int>>& members = chunk_members[chunk];
+    for (std::vector<int>& list : members) list.clear();
+    for (int i = begin; i < end; i++) {
+        // dead slots keep their old values (like the OpenMP path) but are never binned
+        next_boids[i] = boids[i];
+        if (frame.alive && !frame.alive[i]) continue;
+        members[neighbor_search->block_of(i, boids[i])].push_back(i);
+    }
+    double end_time = steady_now_ms();
+    chunk_times_ms[chunk] = static_cast<float>(end_time - start_time);
+}
+
+
+void Simulation::run_build_task(int block) {
+    PerfSample perf_start;
+    if (frame.params.perf_counters_enabled) perf_start = read_thread_counters();
+    double start_time = steady_now_ms();
+
+    // chunks are in index order, so the block's members come out in index order too
+    std::vector<int>& members = block_members[block];
+    members.clear();
+    for (const std::vector<std::vector<int>>& chunk : chunk_members) {
+        members.insert(members.end(), chunk[block].begin(), chunk[block].end());
+    }
+    neighbor_search->build_block(frame.state->boids, frame.task_params, block, members);
+
+    double end_time = steady_now_ms();
+    BlockResult& result = block_results[block];
+    result = BlockResult();
+    result.build_time_ms = static_cast<float>(end_time - start_time);
+    if (frame.params.perf_counters_enabled) result.build_perf = read_thread_counters() - perf_start;
+}
+
+
+void Simulation::run_update_task(int block) {
+    // (the task is already one worker, the searches must not open OpenMP teams inside it)
+    const SimulationParams& params = frame.task_params;
+    const std::vector<Boid>& boids = frame.state->boids;
+    std::vector<BoidLod>& lod = frame.state->lod;
+    BlockResult& result = block_results[block];
+    const ObstacleField* lod_field = (params.obstacles_enabled && obstacle_field && !obstacle_field->empty()) ? obstacle_field : nullptr;
+
+    PerfSample perf_start;
+    if (params.perf_counters_enabled) perf_start = read_thread_counters();
+    for (int i : block_members[block]) {
+        // low activity boids only get their position integrated on most frames
+        if (params.lod_enabled && lod_can_skip(lod[i], boids[i], params, lod_field)) {
+            integrate_position(i, boids, next_boids, frame.dt, params);
+            lod[i].frames_since_full++;
+            result.lod_skipped++;
+            continue;
+        }
+
+        std::tuple<long long, long long, float> answers = update_void(i, boids, next_boids, frame.dt, params);
+        result.checked_candidates += std::get<0>(answers);
+        result.neighbors_found += std::get<1>(answers);
+        result.neighbor_time_ms += std::get<2>(answers);
+
+        if (params.lod_enabled) lod_classify(lod[i], boids[i], next_boids[i], std::get<1>(answers), params);
+    }
+    if (params.perf_counters_enabled) result.update_perf = read_thread_counters() - perf_start;
+}
+
+
+void Simulation::run_reduce_task() {
+    SimulationStats& stats = *frame.stats;
+    const int threads = executor->get_num_threads();
+    long long total_checked_candidates = 0;
+    long long total_neighbors_found = 0;
+    long long lod_skipped = 0;
+    float neighbor_time_ms = 0.0f;
+    float build_time_ms = frame.begin_time_ms * threads;
+    PerfSample build_perf, update_perf;
+    for (float chunk_time : chunk_times_ms) build_time_ms += chunk_time;
+    for (const BlockResult& result : block_results) {
+        total_checked_candidates += result.checked_candidates;
+        total_neighbors_found += result.neighbors_found;
+        lod_skipped += result.lod_skipped;
+        neighbor_time_ms += result.neighbor_time_ms;
+        build_time_ms += result.build_time_ms;
+        build_perf += result.build_perf;
+        update_perf += result.update_perf;
+    }
+
+    // there is no separate build phase any more, the build time is the build tasks' share of the workers
+    stats.num_threads = threads;
+    stats.grid_map_hash_time_ms = build_time_ms / threads;
+    stats.get_neighbors_calc_time_ms = neighbor_time_ms;
+    if (frame.params.perf_counters_enabled) {
+        stats.build_perf = build_perf;
+        stats.update_perf = update_perf;
+        stats.perf_counters_available = counters_available();
+    }
+    stats.total_checked_candidates = total_checked_candidates;
+    stats.total_neighbors_found = total_neighbors_found;
+
+    const int num_live = frame.state->num_live();
+    float fully_updated = std::max(1.0f, static_cast<float>(num_live - lod_skipped));
+    stats.avg_checked_neighbors = static_cast<float>(total_checked_candidates) / fully_updated;
+    stats.avg_neighbors = static_cast<float>(total_neighbors_found) / fully_updated;
+    stats.lod_skipped_updates = static_cast<int>(lod_skipped);
+    stats.lod_skipped_fraction = (num_live == 0) ? 0.0f : static_cast<float>(lod_skipped) / static_cast<float>(num_live);
+}
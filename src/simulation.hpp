@@ -4,12 +4,30 @@
 #pragma once
 #include "simulation_state.hpp"
 #include "neighbor_search.hpp"
+#include "simulation_params.hpp"
+#include "simulation_stats.hpp"
+#include "obstacle_field.hpp"
+#include "perf_counters.hpp"
+#include "task_graph.hpp"
+#include "spatial_index.hpp"
 #include <list>
 using namespace std;
 
 enum class NeighborSearchType {
     NAIIVE,
-    GRID
+    GRID,
+    TOPOLOGICAL
+};
+
+// receives every block of freshly updated boids while the rest of the frame is still running 
+// (the renderer uses it to build its vertex data on the worker threads of the task graph)
+class BlockOutput {
+    public:
+        virtual ~BlockOutput() = default;
+        // called before the frame's graph starts (on the thread that called update)
+        virtual void begin_blocks(int blocks) = 0;
+        // once per block, from whichever worker ran its update (different blocks run at the same time)
+        virtual void write_block(int block, const std::vector<Boid>& boids, const std::vector<int>& members) = 0;
 };
 
 class Simulation {
@@ -18,13 +36,116 @@ class Simulation {
         NeighborSearchType neighbor_search_type = NeighborSearchType::NAIIVE; // will default to Naiive search first
         NeighborSearch* neighbor_search = nullptr;
 
+        // reused between steps by the symmetric pair traversal (one entry per boid)
+        std::vector<NeighborSums> pair_sums;
+
+        // optional obstacles / attractors (only read during update)
+        const ObstacleField* obstacle_field = nullptr;
+
+        // optional spatial index, publish_snapshot() hands it a snapshot of the boids (see spatial_index.hpp)
+        SpatialIndex* spatial_index = nullptr;
+
+        // ================= TASK GRAPH EXECUTOR =================
+        /* 
+        with an executor set (and parallelism + TASK_GRAPH_ENABLED on) a step runs as one graph on the 
+        executor's persistent workers instead of separate OpenMP regions:
+            bin[chunk]   copy a chunk of boids and sort its live boids into the search's blocks
+            build[block] build the block (after every bin)
+            update[block] steer + integrate the block's boids, as soon as the blocks its queries read 
+                         (block +- reach) are built
+            output[block] hand the updated block to the BlockOutput (render vertices)
+            reduce       sum up the per-block stats (after every update)
+        the graph only depends on its shape (blocks, chunks, reach, ...), so it is built once and 
+        reused until that changes. the symmetric pair pass is a whole-flock pass with barriers of its 
+        own and keeps using the OpenMP path */
+        static const int BLOCKS_PER_THREAD = 4;     // more blocks = earlier start + better balance, but more tasks
+        static const int CHUNKS_PER_THREAD = 2;
+
+        TaskExecutor* executor = nullptr;
+        BlockOutput* block_output = nullptr;
+        bool used_task_graph = false;
+
+        struct GraphShape {
+            int blocks = 0, chunks = 0, reach = 0;
+            bool wrap = false, output = false;
+            bool operator==(const GraphShape& other) const {
+                return blocks == other.blocks && chunks == other.chunks && reach == other.reach && 
+                       wrap == other.wrap && output == other.output;
+            }
+        };
+        // per block results, summed up by the reduce task
+        struct BlockResult {
+            long long checked_candidates = 0;
+            long long neighbors_found = 0;
+            long long lod_skipped = 0;
+            float neighbor_time_ms = 0.0f;          // summed update_void neighbor time
+            float build_time_ms = 0.0f;             // bin / build task time
+            PerfSample build_perf, update_perf;
+        };
+        TaskGraph frame_graph;
+        GraphShape graph_shape;
+        std::vector<std::vector<std::vector<int>>> chunk_members;  // [chunk][block] live boids binned by that chunk
+        std::vector<std::vector<int>> block_members;               // [block] live boids (index order)
+        std::vector<BlockResult> block_results;
+        std::vector<float> chunk_times_ms;
+        std::vector<Boid> next_boids;
+
+        // what the current frame's tasks work on (set right before the graph runs)
+        struct FrameInputs {
+            SimulationState* state = nullptr;
+            SimulationStats* stats = nullptr;
+            const unsigned char* alive = nullptr;
+            SimulationParams params;
+            SimulationParams task_params;           // params with parallelism off (no OpenMP teams inside tasks)
+            float dt = 0.0f;
+            float begin_time_ms = 0.0f;
+        } frame;
+
+        void update_task_graph(SimulationState& state, float dt, const SimulationParams& params, SimulationStats& stats);
+        void build_frame_graph(const GraphShape& shape);
+        void run_bin_task(int chunk);
+        void run_build_task(int block);
+        void run_update_task(int block);
+        void run_reduce_task();
+
 
     public:
         Simulation(NeighborSearch* ns) : neighbor_search(ns) {}
         void change_neighbor_search_type(NeighborSearch* ns) {
             neighbor_search = ns;
         }
-        std::tuple<long long, long long, float> update_void(int index, const std::vector<Boid>& boids, std::vector<Boid>& new_boids, float dt);
+        NeighborSearch* get_neighbor_search() const {
+            return neighbor_search;
+        }
+        void set_obstacle_field(const ObstacleField* field) {
+            obstacle_field = field;
+        }
+        // index publish_snapshot() publishes to (nullptr = don't publish)
+        void set_spatial_index(SpatialIndex* index) {
+            spatial_index = index;
+        }
+        // copies the boids into a new snapshot of the spatial index. not done by update() itself, the caller 
+        // publishes once per frame (after the last substep) and only when some reader needs it
+        void publish_snapshot(const SimulationState& state, const SimulationParams& params, SimulationStats& stats);
+        // run the steps as a task graph on this executor (nullptr = OpenMP regions)
+        void set_executor(TaskExecutor* task_executor) {
+            executor = task_executor;
+        }
+        // optional receiver for each updated block (only called by the task graph path)
+        void set_block_output(BlockOutput* output) {
+            block_output = output;
+        }
+        // whether the last update ran as a task graph (so the block output saw every boid)
+        bool last_update_used_task_graph() const {
+            return used_task_graph;
+        }
+        // precomputed_sums: neighbor sums from a whole-flock pass (skips the per-boid neighbor search)
+        std::tuple<long long, long long, float> update_void(int index, const std::vector<Boid>& boids, std::vector<Boid>& new_boids, float dt, SimulationParams params,
+                                                            const NeighborSums* precomputed_sums = nullptr);
+        // steps the simulation using the global simulation_config / simulation_stats
         void update(SimulationState& state, float dt);
+        // steps the simulation with an explicit parameter snapshot and stats output (touches no globals, 
+        // so independent simulations can run side by side)
+        void update(SimulationState& state, float dt, const SimulationParams params, SimulationStats& stats);
 
 };
@@ -1,4 +1,113 @@
 #include "simulation_config.hpp"
 
+#include <stdexcept>
+#include <string>
+
 // define it in exactly one cpp file
 SimulationConfig simulation_config;
+
+
+bool apply_preset(SimulationConfig& config, int preset) {
+    /* 
+    the following presets will only affect the number of boids, speed, perception radius, 
+    alignment, cohesion, and separation weights */
+    switch (preset) {
+        // [ 0 ] default config
+        case 0:
+            config = SimulationConfig();
+            return true;
+        // [ 1 ] tight flock (high cohesion, medium separation) (flocks stick strongly together)
+        case 1:
+            config.NUM_BOIDS = 1000;
+            config.SPEED = 5.0f;
+            config.PERCEPTION_RADIUS = 45.0f;
+            config.ALIGNMENT_WEIGHT = 0.3f;
+            config.COHESION_WEIGHT = 0.2f;
+            config.SEPARATION_WEIGHT = 1.0f;
+            return true;
+        // [ 2 ] chaotic scatter (high separation, low cohesion) (boids avoid each other strongly, resulting in scattered movement)
+        case 2:
+            config.NUM_BOIDS = 1000;
+            config.SPEED = 7.0f;
+            config.PERCEPTION_RADIUS = 30.0f;
+            config.ALIGNMENT_WEIGHT = 0.2f;
+            config.COHESION_WEIGHT = 0.05f;
+            config.SEPARATION_WEIGHT = 2.0f;
+            return true;
+        // [ 3 ] smooth schooling (high alighnment, medium cohesion, low separation) (boids move smoothly in the same direction)
+        case 3:
+            config.NUM_BOIDS = 1000;
+            config.SPEED = 4.0f;
+            config.PERCEPTION_RADIUS = 50.0f;
+            config.ALIGNMENT_WEIGHT = 0.5f;
+            config.COHESION_WEIGHT = 0.15f;
+            config.SEPARATION_WEIGHT = 0.5f;
+            return true;
+        // [ 4 ] max load (high number of boids, high speed, medium all weights) (tests performance under heavy load)
+        case 4:
+            config.NUM_BOIDS = 5000;
+            config.SPEED = 20.0f;
+            config.PERCEPTION_RADIUS = 60.0f;
+            config.ALIGNMENT_WEIGHT = 0.25f;
+            config.COHESION_WEIGHT = 0.1f;
+            config.SEPARATION_WEIGHT = 1.5f;
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+// booleans only take 1 / 0 / true / false, anything else is an error instead of silently meaning false
+static bool parse_bool(const std::string& value) {
+    if (value == "1" || value == "true") return true;
+    if (value == "0" || value == "false") return false;
+    throw std::invalid_argument("not a boolean: " + value);
+}
+
+
+// sets one config field from its name (the same names as in SimulationConfig), returns false for unknown names
+// (throws std::invalid_argument / std::out_of_range if the value is not a number / boolean)
+bool set_config_field(SimulationConfig& config, const std::string& name, const std::string& value) {
+    if (name == "NUM_BOIDS")                 config.NUM_BOIDS = std::stoi(value);
+    else if (name == "SPEED")                config.SPEED = std::stof(value);
+    else if (name == "MAX_SPEED")            config.MAX_SPEED = std::stof(value);
+    else if (name == "PERCEPTION_RADIUS")    config.PERCEPTION_RADIUS = std::stof(value);
+    else if (name == "ALIGNMENT_WEIGHT")     config.ALIGNMENT_WEIGHT = std::stof(value);
+    else if (name == "COHESION_WEIGHT")      config.COHESION_WEIGHT = std::stof(value);
+    else if (name == "SEPARATION_WEIGHT")    config.SEPARATION_WEIGHT = std::stof(value);
+    else if (name == "GRID_CELL_SIZE")       config.GRID_CELL_SIZE = std::stof(value);
+    else if (name == "WINDOW_WIDTH")         config.WINDOW_WIDTH = std::stoi(value);
+    else if (name == "WINDOW_HEIGHT")        config.WINDOW_HEIGHT = std::stoi(value);
+    else if (name == "WORLD_WIDTH")          config.WORLD_WIDTH = std::stoi(value);
+    else if (name == "WORLD_HEIGHT")         config.WORLD_HEIGHT = std::stoi(value);
+    else if (name == "SIMULATION_TYPE_GRID") config.SIMULATION_TYPE_GRID = parse_bool(value);
+    else if (name == "TOPOLOGICAL_ENABLED")  config.TOPOLOGICAL_ENABLED = parse_bool(value);
+    else if (name == "TOPOLOGICAL_K")        config.TOPOLOGICAL_K = std::stoi(value);
+    else if (name == "SIMULATION_DIMENSIONS") config.SIMULATION_DIMENSIONS = std::stoi(value);
+    else if (name == "WORLD_DEPTH")          config.WORLD_DEPTH = std::stoi(value);
+    else if (name == "PERIODIC_BOUNDARIES")  config.PERIODIC_BOUNDARIES = parse_bool(value);
+    else if (name == "QUANTIZED_STORAGE")    config.QUANTIZED_STORAGE = parse_bool(value);
+    else if (name == "PARALLELISM_ENABLED")  config.PARALLELISM_ENABLED = parse_bool(value);
+    else if (name == "SYMMETRIC_PAIRS_ENABLED") config.SYMMETRIC_PAIRS_ENABLED = parse_bool(value);
+    else if (name == "FAR_FIELD_ENABLED")    config.FAR_FIELD_ENABLED = parse_bool(value);
+    else if (name == "FAR_FIELD_NEAR_CELLS") config.FAR_FIELD_NEAR_CELLS = std::stoi(value);
+    else if (name == "TOPOLOGICAL_MAX_RANGE") config.TOPOLOGICAL_MAX_RANGE = std::stof(value);
+    else if (name == "LOD_ENABLED")          config.LOD_ENABLED = parse_bool(value);
+    else if (name == "LOD_INTERVAL")         config.LOD_INTERVAL = std::stoi(value);
+    else if (name == "LOD_NEIGHBOR_THRESHOLD") config.LOD_NEIGHBOR_THRESHOLD = std::stoi(value);
+    else if (name == "LOD_STEER_THRESHOLD")  config.LOD_STEER_THRESHOLD = std::stof(value);
+    else if (name == "LOD_MAX_DRIFT")        config.LOD_MAX_DRIFT = std::stof(value);
+    else if (name == "FIXED_TIMESTEP_ENABLED") config.FIXED_TIMESTEP_ENABLED = parse_bool(value);
+    else if (name == "FIXED_STEP_SECONDS")   config.FIXED_STEP_SECONDS = std::stof(value);
+    else if (name == "STEP_DISTANCE_FRACTION") config.STEP_DISTANCE_FRACTION = std::stof(value);
+    else if (name == "MAX_SUBSTEPS")         config.MAX_SUBSTEPS = std::stoi(value);
+    else if (name == "CANDIDATE_CACHE_ENABLED") config.CANDIDATE_CACHE_ENABLED = parse_bool(value);
+    else if (name == "CANDIDATE_SKIN_FRACTION") config.CANDIDATE_SKIN_FRACTION = std::stof(value);
+    else if (name == "CANDIDATE_CACHE_MAX_STEPS") config.CANDIDATE_CACHE_MAX_STEPS = std::stoi(value);
+    else if (name == "TASK_GRAPH_ENABLED")   config.TASK_GRAPH_ENABLED = parse_bool(value);
+    else if (name == "ADAPTIVE_SEARCH_INTERVAL") config.ADAPTIVE_SEARCH_INTERVAL = std::stoi(value);
+    else if (name == "ADAPTIVE_SEARCH_HYSTERESIS") config.ADAPTIVE_SEARCH_HYSTERESIS = std::stof(value);
+    else return false;
+    return true;
+}
@@ -5,7 +5,13 @@ settings for the simulation
 
 
 #pragma once
-#include <SDL.h>
+#include <cstdint>
+#include <string>
+
+// plain RGBA color (same layout as SDL_Color, the renderer converts it), keeps SDL out of the core
+struct RgbaColor {
+    uint8_t r, g, b, a;
+};
 
 struct SimulationConfig {
 
@@ -37,8 +43,8 @@ struct SimulationConfig {
     int BOID_WIDTH = 4;                             // width of boid rectangle ** NOTE: to use, must modify renderer.cpp ** 
     int BOID_HEIGHT = 4;                            // height of boid rectangle ** NOTE: to use, must modify renderer.cpp ** 
 
-    SDL_Color BOID_COLOR = {255, 255, 255, 255};    // white color
-    SDL_Color BACKGROUND_COLOR = {0, 0, 0, 255};    // black backgrounds
+    RgbaColor BOID_COLOR = {255, 255, 255, 255};    // white color
+    RgbaColor BACKGROUND_COLOR = {0, 0, 0, 255};    // black backgrounds
 
     // triangle boid sizes 
     float BOID_TRIANGLE_SIZE = 5.0f;                // size of the triangle representing the boid
@@ -49,19 +55,109 @@ struct SimulationConfig {
     int WINDOW_WIDTH = 800;                         // width of simulation window
     int WINDOW_HEIGHT = 600;                        // height of simulation window    
 
+    // world size: boids wrap around at WORLD_WIDTH x WORLD_HEIGHT (0 = the window size). a bigger world is
+    // looked at through the renderer's camera, only the part in view is drawn (see renderer.hpp)
+    int WORLD_WIDTH = 0;                            // width of the simulated world (0 = WINDOW_WIDTH)
+    int WORLD_HEIGHT = 0;                           // height of the simulated world (0 = WINDOW_HEIGHT)
+    float CAMERA_PAN_STEP = 0.1f;                   // arrow keys move the view by this fraction of its size
+    float CAMERA_ZOOM_STEP = 1.25f;                 // zoom factor per mouse wheel notch / page key
+    float CAMERA_MAX_ZOOM = 8.0f;                   // pixels per world unit at most (at least: the whole world fits the window)
+    float DENSITY_SPLAT_CELL_PIXELS = 4.0f;         // grid cells smaller than this on screen are drawn as a density splat instead of boids
+    int RENDER_MAX_VISIBLE_BOIDS = 200000;          // more boids in view than this are drawn as a density splat too
+
+    // 3D runs (headless / batch only, the window always shows the 2D simulation)
+    int SIMULATION_DIMENSIONS = 2;                  // 2 or 3
+    int WORLD_DEPTH = 600;                          // depth of the world in 3D runs
+
     // grid parameters for neighbor search
     float GRID_CELL_SIZE = 60.0f;                   // size of each grid cell for spatial partitioning
     float GRID_CELL_SIZE_STEP = 5.0f;               // amount to increase/decrease grid cell size by
 
     bool SHOW_GRID = false;                         // whether to render the grid overlay
+    bool CURSOR_QUERY_ENABLED = false;              // highlight the boids around the mouse (spatial index query)
+    RgbaColor HIGHLIGHT_COLOR = {255, 196, 40, 255};    // amber color
     bool PAUSED = false;                            // whether the simulation is paused
     bool SHOW_STATS = false;                        // whether to show simulation stats on screen
 
+    // quantized storage (headless FlockSimulation runs only): positions / velocities kept as 16-bit fixed 
+    // point relative to the world size / MAX_SPEED, half the bytes per boid (see packed_boid.hpp)
+    bool QUANTIZED_STORAGE = false;                 // whether batch runs store boids as 16-bit fixed point
+
+    // periodic boundaries: boids already wrap around the world edges, with this on they also see (and
+    // flock with) boids across the wrap. SimulationParams::from_config clamps the perception radius, the
+    // topological range and radius + candidate skin to 0.499 * min(world width, world height) while it's on
+    // (on by default, which changes every preset's dynamics compared to runs from before it existed:
+    // boids near an edge now flock with the ones across it)
+    bool PERIODIC_BOUNDARIES = true;                // whether neighbor searches look across the world edges
+
     // false = Naiive, true = Grid
     bool SIMULATION_TYPE_GRID = false;              // whether to use grid-based neighbor search or naiive search
 
+    // adaptive search selection: naiive / grid are timed against each other and the cheaper one is used
+    // (see adaptive_search.hpp). picking a search by hand ([ E ] / [ T ]) turns it off
+    bool ADAPTIVE_SEARCH_ENABLED = true;            // whether to pick the neighbor search automatically
+    int ADAPTIVE_SEARCH_INTERVAL = 300;             // frames between two probes of the other searches
+    float ADAPTIVE_SEARCH_HYSTERESIS = 0.15f;       // only switch if the other search is at least this much cheaper (fraction)
+    const char* ADAPTIVE_SEARCH_LOG = "";           // optional file every decision is appended to, e.g. "boids_adaptive_search.log" (empty = off)
+
     bool PARALLELISM_ENABLED = false;               // whether to use parallelism for neighbor search and boid updates
     int PARALLELISM_NUM_THREADS = 4;                // number of threads to use when parallelism is enabled
+    // parallel steps run as one task graph on a persistent worker pool (build, update, stats and render 
+    // vertices of a block start as soon as their inputs are ready) instead of separate OpenMP regions
+    bool TASK_GRAPH_ENABLED = true;                 // whether parallel steps use the task graph executor
+
+    bool PERF_COUNTERS_ENABLED = false;             // whether to collect hardware performance counters (Linux only)
+    // set to a path (e.g. "boids_metrics.prom") to have the stats reporter rewrite a Prometheus text file there
+    // about once a second, point a node_exporter textfile collector at its directory to scrape it
+    const char* METRICS_FILE = "";                  // optional metrics file (empty = off)
+
+    // far-field approximation (grid search only): grid cells completely inside the perception radius are 
+    // added as a whole (count, position sum, velocity sum) instead of boid by boid
+    bool FAR_FIELD_ENABLED = false;                 // whether to use the cell aggregate approximation
+    int FAR_FIELD_NEAR_CELLS = 1;                   // cells within this many rings of the boid's cell are always exact (accuracy vs speed)
+
+    // symmetric pairs (grid search only): each pair of boids is tested once and updates both boids
+    bool SYMMETRIC_PAIRS_ENABLED = false;           // whether to use the half-stencil pair traversal
+
+    // topological neighbors (each boid reacts to its k nearest neighbors instead of everyone in the perception radius)
+    bool TOPOLOGICAL_ENABLED = false;               // whether to use the topological (k nearest) neighbor search
+    int TOPOLOGICAL_K = 7;                          // number of nearest neighbors each boid reacts to (max 16)
+    float TOPOLOGICAL_MAX_RANGE = 200.0f;           // neighbors further away than this are never considered
+
+    // temporal level of detail (low activity boids only get a full update every LOD_INTERVAL frames)
+    bool LOD_ENABLED = false;                       // whether to use the LOD scheduler
+    int LOD_INTERVAL = 4;                           // low activity boids are fully updated at least every N frames
+    int LOD_NEIGHBOR_THRESHOLD = 0;                 // boids with at most this many neighbors count as isolated
+    float LOD_STEER_THRESHOLD = 0.5f;               // boids steering less than this per frame count as stable
+    float LOD_MAX_DRIFT = 0.25f;                    // force a full update after moving this fraction of the perception radius
+
+    // fixed timestep (see time_stepper.hpp): every frame runs as many physics steps as its dt covers. a step 
+    // is FIXED_STEP_SECONDS long, or shorter when the fastest boid would otherwise move more than 
+    // STEP_DISTANCE_FRACTION of the perception radius / grid cell size in one step. rendering interpolates 
+    // between the last two steps
+    bool FIXED_TIMESTEP_ENABLED = false;            // whether to run fixed physics steps instead of one step per frame
+    float FIXED_STEP_SECONDS = 1.0f / 60.0f;        // longest physics step (real seconds, times SPEED in simulation time)
+    float STEP_DISTANCE_FRACTION = 0.25f;           // fastest boid moves at most this fraction of min(radius, cell size) per step
+    int MAX_SUBSTEPS = 8;                           // steps per frame at most (slow frames drop the rest instead of piling up)
+    // candidate cache (fixed timestep only): neighbors within the perception radius + a skin are gathered once and 
+    // reused by the following steps until some boid moved more than half the skin (see cached_neighbor_search.hpp)
+    bool CANDIDATE_CACHE_ENABLED = true;            // whether steps reuse cached neighbor candidates
+    float CANDIDATE_SKIN_FRACTION = 0.5f;           // skin as a fraction of the perception radius
+    int CANDIDATE_CACHE_MAX_STEPS = 16;             // candidates are gathered again at least every N steps
+
+    // obstacles and attractors (baked into a signed distance field, see obstacle_field.hpp)
+    bool OBSTACLES_ENABLED = false;                 // whether boids steer around obstacles / towards attractors
+    float OBSTACLE_FIELD_RESOLUTION = 8.0f;         // distance between field samples (smaller = sharper corners, slower rebakes)
+    float OBSTACLE_AVOID_RANGE = 40.0f;             // boids start turning away this far from an obstacle
+    float OBSTACLE_WEIGHT = 12.0f;                  // weight for obstacle avoidance
+    float ATTRACTOR_RANGE = 200.0f;                 // boids feel attractors from this far away
+    float ATTRACTOR_WEIGHT = 1.5f;                  // weight for attraction
+    const char* OBSTACLE_BITMAP = "";               // optional .bmp loaded as obstacles at startup (bright pixels = solid)
+
+
+    /* ================= WORLD SIZE ================= */
+    int get_world_width() const { return WORLD_WIDTH > 0 ? WORLD_WIDTH : WINDOW_WIDTH; }
+    int get_world_height() const { return WORLD_HEIGHT > 0 ? WORLD_HEIGHT : WINDOW_HEIGHT; }
 
 
     /* ================= COMPARISON OPERATORS ================= */
@@ -83,13 +179,29 @@ struct SimulationConfig {
                BOID_TRIANGLE_SIZE == other.BOID_TRIANGLE_SIZE &&
                WINDOW_WIDTH == other.WINDOW_WIDTH &&
                WINDOW_HEIGHT == other.WINDOW_HEIGHT &&
+               WORLD_WIDTH == other.WORLD_WIDTH &&
+               WORLD_HEIGHT == other.WORLD_HEIGHT &&
                GRID_CELL_SIZE == other.GRID_CELL_SIZE &&
                PAUSED == other.PAUSED &&
                SHOW_STATS == other.SHOW_STATS &&
                SHOW_GRID == other.SHOW_GRID && 
+               CURSOR_QUERY_ENABLED == other.CURSOR_QUERY_ENABLED && 
                SIMULATION_TYPE_GRID == other.SIMULATION_TYPE_GRID && 
+               PERIODIC_BOUNDARIES == other.PERIODIC_BOUNDARIES && 
+               ADAPTIVE_SEARCH_ENABLED == other.ADAPTIVE_SEARCH_ENABLED && 
                PARALLELISM_ENABLED == other.PARALLELISM_ENABLED && 
-               PARALLELISM_NUM_THREADS == other.PARALLELISM_NUM_THREADS;
+               PARALLELISM_NUM_THREADS == other.PARALLELISM_NUM_THREADS && 
+               TASK_GRAPH_ENABLED == other.TASK_GRAPH_ENABLED && 
+               PERF_COUNTERS_ENABLED == other.PERF_COUNTERS_ENABLED && 
+               LOD_ENABLED == other.LOD_ENABLED && 
+               FIXED_TIMESTEP_ENABLED == other.FIXED_TIMESTEP_ENABLED && 
+               CANDIDATE_CACHE_ENABLED == other.CANDIDATE_CACHE_ENABLED && 
+               TOPOLOGICAL_ENABLED == other.TOPOLOGICAL_ENABLED && 
+               TOPOLOGICAL_K == other.TOPOLOGICAL_K && 
+               FAR_FIELD_ENABLED == other.FAR_FIELD_ENABLED && 
+               FAR_FIELD_NEAR_CELLS == other.FAR_FIELD_NEAR_CELLS && 
+               SYMMETRIC_PAIRS_ENABLED == other.SYMMETRIC_PAIRS_ENABLED && 
+               OBSTACLES_ENABLED == other.OBSTACLES_ENABLED;
     }
 
     bool operator!=(const SimulationConfig& other) const {
@@ -97,5 +209,13 @@ struct SimulationConfig {
     }
 };
 
+// apply one of the built-in presets to a config (0 = defaults, 1-4 = the presets bound to the number keys)
+// returns false if the preset number is unknown
+bool apply_preset(SimulationConfig& config, int preset);
+
+// sets one config field from its name (the same names as in SimulationConfig, e.g. "PERCEPTION_RADIUS"),
+// returns false for unknown names (used by the batch config files and the C API)
+bool set_config_field(SimulationConfig& config, const std::string& name, const std::string& value);
+
 // Declare a single global instance (so other files can see it exists when they import this header file)
 extern SimulationConfig simulation_config;
\ No newline at end of file
@@ -0,0 +1,150 @@
+/* 
+immutable per-step snapshot of the physics parameters 
+- taken once at the start of every Simulation::update from the global simulation_config
+- passed by value into the neighbor search and steering kernels so the hot loops never 
+  touch the (mutable, shared) global config
+- also holds values that are derived from the config (squared radius, 1/cell size, etc.)
+*/
+
+
+#pragma once
+#include <algorithm>
+#include "simulation_config.hpp"
+
+
+struct SimulationParams {
+    // neighbor search
+    float perception_radius = 0.0f;
+    float perception_radius_sq = 0.0f;              // precomputed PERCEPTION_RADIUS^2
+    float grid_cell_size = 1.0f;
+    float inv_grid_cell_size = 1.0f;                // precomputed 1 / GRID_CELL_SIZE
+
+    // movement
+    float max_speed = 0.0f;
+    float max_speed_sq = 0.0f;                      // precomputed MAX_SPEED^2
+
+    // steering weights
+    float alignment_weight = 0.0f;
+    float cohesion_weight = 0.0f;
+    float separation_weight = 0.0f;
+
+    // world bounds (boids wrap around these)
+    float world_width = 0.0f;
+    float world_height = 0.0f;
+    float world_depth = 0.0f;                       // only used by 3D runs
+    bool periodic_boundaries = false;               // neighbors are also found across the wrap (minimum image)
+
+    bool parallelism_enabled = false;
+    bool task_graph_enabled = false;                // run parallel steps on the task graph executor (if there is one)
+    bool perf_counters_enabled = false;             // read hardware counters around each phase
+
+    // far-field approximation
+    bool far_field_enabled = false;
+    int far_field_near_cells = 1;
+
+    // symmetric pair traversal
+    bool symmetric_pairs_enabled = false;
+
+    // topological neighbors
+    int topological_k = 7;
+    float topological_max_range = 0.0f;
+    float topological_max_range_sq = 0.0f;          // precomputed TOPOLOGICAL_MAX_RANGE^2
+
+    // temporal level of detail
+    bool lod_enabled = false;
+    int lod_interval = 1;
+    int lod_neighbor_threshold = 0;
+    float lod_steer_threshold_sq = 0.0f;            // precomputed LOD_STEER_THRESHOLD^2
+    float lod_max_drift_sq = 0.0f;                  // precomputed (LOD_MAX_DRIFT * PERCEPTION_RADIUS)^2
+
+    // fixed timestep / sub-stepping (only read by TimeStepper, except steer_scale)
+    float fixed_step = 0.0f;                        // FIXED_STEP_SECONDS * SPEED (simulation time)
+    float step_distance_limit = 0.0f;               // STEP_DISTANCE_FRACTION * min(PERCEPTION_RADIUS, GRID_CELL_SIZE)
+    int max_substeps = 1;
+    float steer_scale = 1.0f;                       // steering is multiplied by this (step size / fixed_step for shortened steps)
+    bool candidate_cache_enabled = false;
+    float candidate_skin = 0.0f;                    // CANDIDATE_SKIN_FRACTION * PERCEPTION_RADIUS
+    int candidate_cache_max_steps = 1;
+
+    // obstacles / attractors
+    bool obstacles_enabled = false;
+    float obstacle_avoid_range = 0.0f;
+    float inv_obstacle_avoid_range = 0.0f;          // precomputed 1 / OBSTACLE_AVOID_RANGE
+    float obstacle_weight = 0.0f;
+    float attractor_range = 0.0f;
+    float attractor_weight = 0.0f;
+
+
+    // build a snapshot from a config (should only be called between steps)
+    static SimulationParams from_config(const SimulationConfig& config) {
+        SimulationParams params;
+        params.perception_radius = config.PERCEPTION_RADIUS;
+        params.perception_radius_sq = config.PERCEPTION_RADIUS * config.PERCEPTION_RADIUS;
+        params.grid_cell_size = config.GRID_CELL_SIZE;
+        params.inv_grid_cell_size = 1.0f / config.GRID_CELL_SIZE;
+
+        params.max_speed = config.MAX_SPEED;
+        params.max_speed_sq = config.MAX_SPEED * config.MAX_SPEED;
+
+        params.alignment_weight = config.ALIGNMENT_WEIGHT;
+        params.cohesion_weight = config.COHESION_WEIGHT;
+        params.separation_weight = config.SEPARATION_WEIGHT;
+
+        params.world_width = static_cast<float>(config.get_world_width());
+        params.world_height = static_cast<float>(config.get_world_height());
+        params.world_depth = static_cast<float>(config.WORLD_DEPTH);
+        params.periodic_boundaries = config.PERIODIC_BOUNDARIES;
+
+        params.parallelism_enabled = config.PARALLELISM_ENABLED;
+        params.task_graph_enabled = config.TASK_GRAPH_ENABLED;
+        params.perf_counters_enabled = config.PERF_COUNTERS_ENABLED;
+
+        params.far_field_enabled = config.FAR_FIELD_ENABLED;
+        params.far_field_near_cells = config.FAR_FIELD_NEAR_CELLS < 0 ? 0 : config.FAR_FIELD_NEAR_CELLS;
+
+        params.symmetric_pairs_enabled = config.SYMMETRIC_PAIRS_ENABLED;
+
+        params.topological_k = config.TOPOLOGICAL_K;
+        params.topological_max_range = config.TOPOLOGICAL_MAX_RANGE;
+        params.topological_max_range_sq = config.TOPOLOGICAL_MAX_RANGE * config.TOPOLOGICAL_MAX_RANGE;
+
+        params.lod_enabled = config.LOD_ENABLED && config.LOD_INTERVAL > 1;
+        params.lod_interval = config.LOD_INTERVAL < 1 ? 1 : (config.LOD_INTERVAL > 255 ? 255 : config.LOD_INTERVAL);
+        params.lod_neighbor_threshold = config.LOD_NEIGHBOR_THRESHOLD;
+        params.lod_steer_threshold_sq = config.LOD_STEER_THRESHOLD * config.LOD_STEER_THRESHOLD;
+        float max_drift = config.LOD_MAX_DRIFT * config.PERCEPTION_RADIUS;
+        params.lod_max_drift_sq = max_drift * max_drift;
+
+        params.fixed_step = config.FIXED_STEP_SECONDS * config.SPEED;
+        params.step_distance_limit = config.STEP_DISTANCE_FRACTION * std::min(config.PERCEPTION_RADIUS, config.GRID_CELL_SIZE);
+        params.max_substeps = config.MAX_SUBSTEPS < 1 ? 1 : config.MAX_SUBSTEPS;
+        params.candidate_cache_enabled = config.CANDIDATE_CACHE_ENABLED && config.CANDIDATE_SKIN_FRACTION > 0.0f;
+        params.candidate_skin = config.CANDIDATE_SKIN_FRACTION * config.PERCEPTION_RADIUS;
+        params.candidate_cache_max_steps = config.CANDIDATE_CACHE_MAX_STEPS < 1 ? 1 : config.CANDIDATE_CACHE_MAX_STEPS;
+
+        params.obstacles_enabled = config.OBSTACLES_ENABLED;
+        params.obstacle_avoid_range = config.OBSTACLE_AVOID_RANGE;
+        params.inv_obstacle_avoid_range = config.OBSTACLE_AVOID_RANGE > 0.0f ? 1.0f / config.OBSTACLE_AVOID_RANGE : 0.0f;
+        params.obstacle_weight = config.OBSTACLE_WEIGHT;
+        params.attractor_range = config.ATTRACTOR_RANGE;
+        params.attractor_weight = config.ATTRACTOR_WEIGHT;
+
+        // with wrapping, a search range of half the world or more would reach the same boid through two
+        // different wraps (and the minimum image offset would pick the wrong one), so keep every range
+        // (incl. the cache's radius + skin) just under half of the shorter side
+        if (params.periodic_boundaries) {
+            float max_range = 0.499f * std::min(params.world_width, params.world_height);
+            if (params.perception_radius > max_range) {
+                params.perception_radius = max_range;
+                params.perception_radius_sq = max_range * max_range;
+            }
+            if (params.topological_max_range > max_range) {
+                params.topological_max_range = max_range;
+                params.topological_max_range_sq = max_range * max_range;
+            }
+            params.candidate_skin = std::max(0.0f, std::min(params.candidate_skin, max_range - params.perception_radius));
+            params.candidate_cache_enabled = params.candidate_cache_enabled && params.candidate_skin > 0.0f;
+        }
+        return params;
+    }
+};
@@ -0,0 +1,190 @@
+#include "simulation_state.hpp"
+#include <omp.h>
+
+
+// once this many slots (and at least this share of them) are dead, compact() is worth it
+static const int COMPACT_MIN_DEAD = 64;
+static const float COMPACT_DEAD_FRACTION = 0.25f;
+
+static int id_index(BoidId id) {
+    return static_cast<int>(id & ((1ull << BOID_ID_INDEX_BITS) - 1));
+}
+
+static BoidId make_id(int index, uint32_t generation) {
+    return (static_cast<BoidId>(generation) << BOID_ID_INDEX_BITS) | static_cast<BoidId>(index);
+}
+
+
+void SimulationState::adopt_boids() {
+    if (alive.size() == boids.size()) return;
+
+    // anything already in boids becomes a live boid with the id of its slot
+    int n = static_cast<int>(boids.size());
+    alive.assign(n, 1);
+    slot_ids.resize(n);
+    id_slots.resize(n);
+    id_generations.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        slot_ids[i] = make_id(i, 0);
+        id_slots[i] = i;
+    }
+    free_slots.clear();
+    free_ids.clear();
+    live_count = n;
+}
+
+
+BoidId SimulationState::spawn(const Boid& boid) {
+    adopt_boids();
+
+    int index;
+    if (!free_ids.empty()) {
+        index = free_ids.front();
+        free_ids.pop_front();
+    } else {
+        index = static_cast<int>(id_slots.size());
+        id_slots.push_back(-1);
+        id_generations.push_back(0);
+    }
+
+    int slot;
+    if (!free_slots.empty()) {
+        // reuse a dead slot
+        slot = free_slots.back();
+        free_slots.pop_back();
+        boids[slot] = boid;
+        alive[slot] = 1;
+        if (slot < static_cast<int>(lod.size())) lod[slot] = BoidLod(); // full update first, like any new boid
+    } else {
+        slot = static_cast<int>(boids.size());
+        boids.push_back(boid);
+        alive.push_back(1);
+        slot_ids.push_back(INVALID_BOID_ID);
+    }
+
+    BoidId id = make_id(index, id_generations[index]);
+    slot_ids[slot] = id;
+    id_slots[index] = slot;
+    live_count++;
+    return id;
+}
+
+
+bool SimulationState::kill(BoidId id) {
+    int slot = slot_of(id);
+    if (slot < 0) return false;
+    kill_slot(slot);
+    return true;
+}
+
+void SimulationState::kill_slot(int slot) {
+    adopt_boids();
+    if (slot < 0 || slot >= static_cast<int>(boids.size()) || !alive[slot]) return;
+
+    int index = id_index(slot_ids[slot]);
+    id_slots[index] = -1;
+    id_generations[index]++;                // old handles to this id stop matching
+    free_ids.push_back(index);
+
+    alive[slot] = 0;
+    slot_ids[slot] = INVALID_BOID_ID;
+    free_slots.push_back(slot);
+    live_count--;
+}
+
+
+void SimulationState::clear_boids() {
+    boids.clear();
+    lod.clear();
+    alive.clear();
+    slot_ids.clear();
+    id_slots.clear();
+    id_generations.clear();
+    free_slots.clear();
+    free_ids.clear();
+    live_count = 0;
+}
+
+
+bool SimulationState::is_alive(BoidId id) const {
+    return slot_of(id) >= 0;
+}
+
+int SimulationState::slot_of(BoidId id) const {
+    if (id == INVALID_BOID_ID) return -1;
+    // boids that were never adopted by the pool have the id of their slot
+    if (alive.size() != boids.size()) return (id < boids.size()) ? static_cast<int>(id) : -1;
+
+    int index = id_index(id);
+    if (index >= static_cast<int>(id_slots.size()) || make_id(index, id_generations[index]) != id) return -1;
+    return id_slots[index];
+}
+
+int SimulationState::num_live() const {
+    return (alive.size() == boids.size()) ? live_count : static_cast<int>(boids.size());
+}
+
+bool SimulationState::has_dead_slots() const {
+    return num_live() != static_cast<int>(boids.size());
+}
+
+bool SimulationState::needs_compaction() const {
+    int dead = static_cast<int>(boids.size()) - num_live();
+    return dead >= COMPACT_MIN_DEAD && dead >= COMPACT_DEAD_FRACTION * boids.size();
+}
+
+
+// ================= COMPACTION =================
+/* 
+stable parallel compaction: every thread counts the live boids in its contiguous chunk of slots, a 
+prefix sum over those counts gives each chunk its output offset, then every thread copies its live 
+boids (and their LOD data) to their new slots and points their ids at them. the order of the live 
+boids doesn't change */
+void SimulationState::compact(bool parallel) {
+    if (!has_dead_slots()) return;
+
+    int n = static_cast<int>(boids.size());
+    bool move_lod = (lod.size() == boids.size());
+    std::vector<Boid> packed_boids(live_count);
+    std::vector<BoidId> packed_ids(live_count);
+    std::vector<BoidLod> packed_lod(move_lod ? live_count : 0);
+    std::vector<int> chunk_offsets;
+
+    #pragma omp parallel if(parallel)
+    {
+        int thread = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        int begin = static_cast<int>(static_cast<long long>(n) * thread / num_threads);
+        int end = static_cast<int>(static_cast<long long>(n) * (thread + 1) / num_threads);
+
+        #pragma omp single
+        chunk_offsets.assign(num_threads + 1, 0);
+
+        // count
+        int chunk_live = 0;
+        for (int i = begin; i < end; i++) chunk_live += alive[i];
+        chunk_offsets[thread + 1] = chunk_live;
+        #pragma omp barrier
+
+        // scan (tiny, one entry per thread)
+        #pragma omp single
+        for (int t = 1; t <= num_threads; t++) chunk_offsets[t] += chunk_offsets[t - 1];
+
+        // scatter (every live boid owns its id entry, so these writes never overlap)
+        int out = chunk_offsets[thread];
+        for (int i = begin; i < end; i++) {
+            if (!alive[i]) continue;
+            packed_boids[out] = boids[i];
+            packed_ids[out] = slot_ids[i];
+            if (move_lod) packed_lod[out] = lod[i];
+            id_slots[id_index(slot_ids[i])] = out;
+            out++;
+        }
+    }
+
+    boids.swap(packed_boids);
+    slot_ids.swap(packed_ids);
+    if (move_lod) lod.swap(packed_lod);
+    alive.assign(live_count, 1);
+    free_slots.clear();
+}
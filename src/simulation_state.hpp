@@ -4,14 +4,62 @@ represents the
 
 
 #pragma once
+#include <cstdint>
+#include <deque>
 #include <vector>
 #include "boid.hpp"
 #include "simulation_config.hpp"
 
 
 
+// per-boid bookkeeping for the temporal level-of-detail scheduler (same indices as boids)
+struct BoidLod {
+    unsigned char frames_since_full = 0;    // frames since the last full (neighbor search + steering) update
+    bool low_activity = false;              // isolated or barely steering at the last full update
+    float anchor_x = 0.0f, anchor_y = 0.0f; // position at the last full update
+};
+
+// stable handle for a pooled boid: low 32 bits index the id table, high 32 bits are a generation 
+// counter so a handle to a killed boid doesn't match whatever later reuses its id. freed id indices are 
+// reused oldest first, so an index only comes back after every other free one was used, and its 
+// generation would have to go through all 2^32 values before an old handle could match again
+typedef uint64_t BoidId;
+const BoidId INVALID_BOID_ID = ~0ull;
+const int BOID_ID_INDEX_BITS = 32;
+
 struct SimulationState {
     SimulationConfig sim_config; 
 
-    std::vector<Boid> boids;
+    std::vector<Boid> boids;                // boid slots (killed boids stay as dead slots until the next compact())
+    std::vector<BoidLod> lod;               // only used when LOD_ENABLED (resized by the simulation as needed)
+
+    // ================= BOID POOL =================
+    /* 
+    spawn() / kill() are O(1): killed boids only get their slot marked dead (tombstone) and pushed on a 
+    free list that the next spawn() reuses, so nothing is moved and the vectors only grow when every slot 
+    is taken. compact() (called by the simulation once enough slots are dead) packs the live boids 
+    together again in parallel and fixes up the id table so ids stay valid.
+    boids that were pushed straight into boids (e.g. by the batch runner) are adopted as live boids the 
+    first time the pool is used */
+    std::vector<unsigned char> alive;       // per slot, 1 = live boid (same indices as boids)
+    std::vector<BoidId> slot_ids;           // per slot, id of the boid in it (INVALID_BOID_ID for dead slots)
+    std::vector<int> id_slots;              // per id index, slot of the boid (-1 = not in use)
+    std::vector<uint32_t> id_generations;
+    std::vector<int> free_slots;            // dead slots, reused by spawn()
+    std::deque<int> free_ids;               // unused id indices, reused by spawn() (FIFO, oldest first)
+    int live_count = 0;
+
+    BoidId spawn(const Boid& boid);
+    bool kill(BoidId id);
+    void kill_slot(int slot);
+    void clear_boids();
+    bool is_alive(BoidId id) const;
+    int slot_of(BoidId id) const;           // -1 if the boid is dead
+    int num_live() const;
+    bool has_dead_slots() const;            // false when every slot holds a live boid (no masking needed)
+    bool needs_compaction() const;
+    void compact(bool parallel);
+
+private:
+    void adopt_boids();                     // make the pool bookkeeping match boids
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include "perf_counters.hpp"
 
 struct SimulationStats {
     float frame_time_ms = 0.0f;
@@ -19,6 +20,32 @@ struct SimulationStats {
     float avg_checked_neighbors = 0.0f;
 
     float fps = 0.0f;
+
+    int num_threads = 1;                // number of threads used for the last update
+
+    // spatial index snapshot (only filled in when the simulation has a SpatialIndex)
+    float snapshot_publish_time_ms = 0.0f;
+    int snapshots_retired = 0;          // old snapshots still held by readers
+
+    // camera view (see renderer.hpp)
+    float camera_zoom = 1.0f;           // pixels per world unit
+    int rendered_boids = 0;             // boids drawn last frame (only the ones in view unless the window shows the whole world 1:1)
+    int splat_cells = 0;                // cells drawn as a density splat instead of boids (zoomed far out)
+
+    // fixed timestep (only filled in when FIXED_TIMESTEP_ENABLED, see time_stepper.hpp)
+    int substeps = 0;                   // physics steps run this frame
+    float step_size = 0.0f;             // simulation time per step
+    int candidate_rebuilds = 0;         // steps this frame that gathered new neighbor candidates (the rest reused them)
+
+    // temporal level of detail (only filled in when LOD_ENABLED)
+    int lod_skipped_updates = 0;        // boids that only had their position integrated this frame
+    float lod_skipped_fraction = 0.0f;  // lod_skipped_updates / number of boids
+
+    // hardware counters per phase (only filled in when PERF_COUNTERS_ENABLED, summed over all threads)
+    bool perf_counters_available = false;
+    PerfSample build_perf;              // NeighborSearch::build
+    PerfSample update_perf;             // neighbor search + steering for every boid
+    PerfSample render_perf;             // Renderer::render
 };
 
 // Declare a single global instance (so other files can see it exists when they import this header file)
@@ -0,0 +1,352 @@
+#include "spatial_index.hpp"
+#include "flock_kernels.hpp"
+
+#include <stdexcept>
+using namespace std;
+
+
+// cells [first, last] covering [low, high] along one axis. periodic: the range may run past the edges
+// (the caller wraps it) and never holds the same cell twice
+static void cell_range(float low, float high, float inv_cell_size, int cells, bool periodic, int& first, int& last) {
+    if (periodic && (high - low) * inv_cell_size + 1.0f >= cells) {
+        first = 0;
+        last = cells - 1;
+        return;
+    }
+    float low_cell = std::floor(low * inv_cell_size);
+    float high_cell = std::floor(high * inv_cell_size);
+    if (!periodic) {
+        low_cell = std::max(0.0f, std::min(low_cell, static_cast<float>(cells)));
+        high_cell = std::max(-1.0f, std::min(high_cell, static_cast<float>(cells - 1)));
+    }
+    first = static_cast<int>(low_cell);
+    last = static_cast<int>(high_cell);
+}
+
+// moves a position into [0, extent)
+static float wrap_position(float position, float extent) {
+    return position - extent * std::floor(position / extent);
+}
+
+
+// ================= SNAPSHOT =================
+
+void SpatialSnapshot::build(const SimulationState& state, const SimulationParams& params, unsigned long long snapshot_version) {
+    version = snapshot_version;
+    periodic = params.periodic_boundaries;
+    world_width = std::max(1.0f, params.world_width);
+    world_height = std::max(1.0f, params.world_height);
+
+    // same cells as the grid search: GRID_CELL_SIZE, stretched to a whole number of cells when periodic
+    float cell_size = std::max(1.0f, params.grid_cell_size);
+    if (periodic) {
+        columns = std::max(1, static_cast<int>(world_width / cell_size));
+        rows = std::max(1, static_cast<int>(world_height / cell_size));
+        inv_cell_width = columns / world_width;
+        inv_cell_height = rows / world_height;
+    } else {
+        columns = std::max(1, static_cast<int>(std::ceil(world_width / cell_size)));
+        rows = std::max(1, static_cast<int>(std::ceil(world_height / cell_size)));
+        inv_cell_width = inv_cell_height = 1.0f / cell_size;
+    }
+    min_cell_size = std::min(1.0f / inv_cell_width, 1.0f / inv_cell_height);
+
+    // counting sort of the live boids: count per cell, prefix sum, scatter
+    const std::vector<Boid>& source = state.boids;
+    const int n = static_cast<int>(source.size());
+    const int num_cells = columns * rows;
+    const unsigned char* alive = state.has_dead_slots() ? state.alive.data() : nullptr;
+    const bool has_ids = state.slot_ids.size() == source.size();
+
+    boid_cells.resize(n);
+    cell_start.assign(num_cells + 1, 0);
+    for (int i = 0; i < n; i++) {
+        if (alive && !alive[i]) {
+            boid_cells[i] = -1;
+            continue;
+        }
+        int cell = cell_row(source[i].y) * columns + cell_column(source[i].x);
+        boid_cells[i] = cell;
+        cell_start[cell + 1]++;
+    }
+    for (int c = 0; c < num_cells; c++) cell_start[c + 1] += cell_start[c];
+
+    const int live = cell_start[num_cells];
+    boids.resize(live);
+    slots.resize(live);
+    ids.resize(live);
+    // cell_start[c] is used as the fill position of cell c, which leaves it at the start of cell c + 1
+    for (int i = 0; i < n; i++) {
+        int cell = boid_cells[i];
+        if (cell < 0) continue;
+        int entry = cell_start[cell]++;
+        boids[entry] = source[i];
+        slots[entry] = i;
+        ids[entry] = has_ids ? state.slot_ids[i] : INVALID_BOID_ID;
+    }
+    for (int c = num_cells - 1; c > 0; c--) cell_start[c] = cell_start[c - 1];
+    cell_start[0] = 0;
+}
+
+
+float SpatialSnapshot::distance_sq_to(int entry, float x, float y) const {
+    float dx = boids[entry].x - x;
+    float dy = boids[entry].y - y;
+    if (periodic) {
+        dx = minimum_image_length(dx, world_width);
+        dy = minimum_image_length(dy, world_height);
+    }
+    return dx * dx + dy * dy;
+}
+
+
+void SpatialSnapshot::query_radius(float x, float y, float radius, std::vector<SpatialHit>& out) const {
+    out.clear();
+    if (boids.empty() || !(radius >= 0.0f)) return;
+    if (periodic) {
+        x = wrap_position(x, world_width);
+        y = wrap_position(y, world_height);
+    }
+
+    int first_column, last_column, first_row, last_row;
+    cell_range(x - radius, x + radius, inv_cell_width, columns, periodic, first_column, last_column);
+    cell_range(y - radius, y + radius, inv_cell_height, rows, periodic, first_row, last_row);
+
+    const float radius_sq = radius * radius;
+    for (int gy = first_row; gy <= last_row; gy++) {
+        int row = periodic ? wrap_row(gy) : gy;
+        for (int gx = first_column; gx <= last_column; gx++) {
+            int cell = row * columns + (periodic ? wrap_column(gx) : gx);
+            for (int entry = cell_start[cell]; entry < cell_start[cell + 1]; entry++) {
+                float distance_sq = distance_sq_to(entry, x, y);
+                if (distance_sq <= radius_sq) out.push_back(hit(entry, distance_sq));
+            }
+        }
+    }
+}
+
+
+void SpatialSnapshot::query_nearest(float x, float y, int k, std::vector<SpatialHit>& out, float max_radius) const {
+    out.clear();
+    if (boids.empty() || k <= 0 || !(max_radius >= 0.0f)) return;
+    if (periodic) {
+        x = wrap_position(x, world_width);
+        y = wrap_position(y, world_height);
+    }
+
+    // out is a max heap on distance while searching: the front is the worst of the k best so far
+    auto farther = [](const SpatialHit& a, const SpatialHit& b) { return a.distance_sq < b.distance_sq; };
+    const float max_radius_sq = max_radius * max_radius;
+    auto consider = [&](int entry) {
+        float distance_sq = distance_sq_to(entry, x, y);
+        if (distance_sq > max_radius_sq) return;
+        if (static_cast<int>(out.size()) < k) {
+            out.push_back(hit(entry, distance_sq));
+            std::push_heap(out.begin(), out.end(), farther);
+        } else if (distance_sq < out.front().distance_sq) {
+            std::pop_heap(out.begin(), out.end(), farther);
+            out.back() = hit(entry, distance_sq);
+            std::push_heap(out.begin(), out.end(), farther);
+        }
+    };
+
+    // rings of cells around the query cell, until nothing outside the visited square can be closer
+    const int home_column = cell_column(x);
+    const int home_row = cell_row(y);
+    for (int ring = 0; ; ring++) {
+        if (periodic && (2 * ring + 1 > columns || 2 * ring + 1 > rows)) {
+            // the ring would wrap onto cells that were already visited, start over and check every boid instead
+            out.clear();
+            for (int entry = 0; entry < static_cast<int>(boids.size()); entry++) consider(entry);
+            break;
+        }
+
+        for (int dy = -ring; dy <= ring; dy++) {
+            int gy = home_row + dy;
+            if (!periodic && (gy < 0 || gy >= rows)) continue;
+            int row = periodic ? wrap_row(gy) : gy;
+            // inner rows of the ring only have their two end cells
+            int step = (dy == -ring || dy == ring) ? 1 : std::max(1, 2 * ring);
+            for (int dx = -ring; dx <= ring; dx += step) {
+                int gx = home_column + dx;
+                if (!periodic && (gx < 0 || gx >= columns)) continue;
+                int cell = row * columns + (periodic ? wrap_column(gx) : gx);
+                for (int entry = cell_start[cell]; entry < cell_start[cell + 1]; entry++) consider(entry);
+            }
+        }
+
+        // every cell visited
+        if (periodic && 2 * ring + 1 >= columns && 2 * ring + 1 >= rows) break;
+        if (!periodic && home_column - ring <= 0 && home_row - ring <= 0 &&
+            home_column + ring >= columns - 1 && home_row + ring >= rows - 1) break;
+        // every boid that hasn't been looked at is at least this far away
+        float unvisited_distance = ring * min_cell_size;
+        if (unvisited_distance > max_radius) break;
+        if (static_cast<int>(out.size()) == k && out.front().distance_sq <= unvisited_distance * unvisited_distance) break;
+    }
+
+    std::sort_heap(out.begin(), out.end(), farther);
+}
+
+
+void SpatialSnapshot::query_box(float min_x, float min_y, float max_x, float max_y, std::vector<SpatialHit>& out) const {
+    out.clear();
+    if (boids.empty() || !(max_x >= min_x) || !(max_y >= min_y)) return;
+    const float box_width = max_x - min_x;
+    const float box_height = max_y - min_y;
+    if (periodic) {
+        // (only the box corner is moved, the box keeps its size and may reach past the edge)
+        min_x = wrap_position(min_x, world_width);
+        min_y = wrap_position(min_y, world_height);
+    }
+
+    int first_column, last_column, first_row, last_row;
+    cell_range(min_x, min_x + box_width, inv_cell_width, columns, periodic, first_column, last_column);
+    cell_range(min_y, min_y + box_height, inv_cell_height, rows, periodic, first_row, last_row);
+
+    for (int gy = first_row; gy <= last_row; gy++) {
+        int row = periodic ? wrap_row(gy) : gy;
+        for (int gx = first_column; gx <= last_column; gx++) {
+            int cell = row * columns + (periodic ? wrap_column(gx) : gx);
+            for (int entry = cell_start[cell]; entry < cell_start[cell + 1]; entry++) {
+                float dx = boids[entry].x - min_x;
+                float dy = boids[entry].y - min_y;
+                if (periodic) {
+                    dx = wrap_position(dx, world_width);
+                    dy = wrap_position(dy, world_height);
+                }
+                if (dx >= 0.0f && dx <= box_width && dy >= 0.0f && dy <= box_height) out.push_back(hit(entry, 0.0f));
+            }
+        }
+    }
+}
+
+
+void SpatialSnapshot::query_cells(float min_x, float min_y, float max_x, float max_y, std::vector<SpatialCell>& out) const {
+    out.clear();
+    if (boids.empty() || !(max_x >= min_x) || !(max_y >= min_y)) return;
+    const float box_width = max_x - min_x;
+    const float box_height = max_y - min_y;
+    // (the cells are reported where the box is, so they move by however far the corner is wrapped)
+    float offset_x = 0.0f, offset_y = 0.0f;
+    if (periodic) {
+        offset_x = min_x - wrap_position(min_x, world_width);
+        offset_y = min_y - wrap_position(min_y, world_height);
+        min_x -= offset_x;
+        min_y -= offset_y;
+    }
+    const float cell_width = 1.0f / inv_cell_width;
+    const float cell_height = 1.0f / inv_cell_height;
+
+    int first_column, last_column, first_row, last_row;
+    cell_range(min_x, min_x + box_width, inv_cell_width, columns, periodic, first_column, last_column);
+    cell_range(min_y, min_y + box_height, inv_cell_height, rows, periodic, first_row, last_row);
+
+    for (int gy = first_row; gy <= last_row; gy++) {
+        int row = periodic ? wrap_row(gy) : gy;
+        for (int gx = first_column; gx <= last_column; gx++) {
+            int cell = row * columns + (periodic ? wrap_column(gx) : gx);
+            int count = cell_start[cell + 1] - cell_start[cell];
+            if (count == 0) continue;
+            SpatialCell result;
+            result.min_x = gx * cell_width + offset_x;
+            result.min_y = gy * cell_height + offset_y;
+            result.max_x = result.min_x + cell_width;
+            result.max_y = result.min_y + cell_height;
+            result.count = count;
+            out.push_back(result);
+        }
+    }
+}
+
+
+// ================= PUBLISHING / RECLAMATION =================
+/*
+epochs: global_epoch only grows. acquire() copies it into the reader's slot and then loads the current
+snapshot, publish() swaps the snapshot and then retires the old one at global_epoch (which it bumps). a
+reader that could have loaded the old pointer did its load before the swap, so its slot holds an epoch
+<= the retire epoch; any reader that pinned a later epoch only ever sees the new pointer. so a retired
+snapshot is free once every pinned slot holds a later epoch than its retire epoch. (all of this relies
+on the default sequentially consistent atomics) */
+
+SpatialIndex::SpatialIndex() {
+    for (int reader = 0; reader < MAX_READERS; reader++) reader_epochs[reader].store(SpatialReader::FREE_SLOT);
+}
+
+
+SpatialIndex::~SpatialIndex() {
+    delete current.load();
+    for (SpatialSnapshot* snapshot : retired) delete snapshot;
+    for (SpatialSnapshot* snapshot : free_snapshots) delete snapshot;
+}
+
+
+void SpatialIndex::publish(const SimulationState& state, const SimulationParams& params) {
+    SpatialSnapshot* snapshot;
+    if (!free_snapshots.empty()) {
+        snapshot = free_snapshots.back();
+        free_snapshots.pop_back();
+    } else {
+        snapshot = new SpatialSnapshot();
+    }
+    snapshot->build(state, params, ++published_version);
+
+    SpatialSnapshot* old = current.exchange(snapshot);
+    if (old) {
+        old->retired_epoch = global_epoch.fetch_add(1);
+        retired.push_back(old);
+    }
+    reclaim();
+}
+
+
+void SpatialIndex::reclaim() {
+    // oldest epoch a reader still has pinned (idle slots are 0, free slots are FREE_SLOT)
+    unsigned long long oldest = SpatialReader::FREE_SLOT;
+    for (int reader = 0; reader < MAX_READERS; reader++) {
+        unsigned long long epoch = reader_epochs[reader].load();
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    size_t kept = 0;
+    for (SpatialSnapshot* snapshot : retired) {
+        if (snapshot->retired_epoch >= oldest) {
+            retired[kept++] = snapshot;
+        } else if (static_cast<int>(free_snapshots.size()) < MAX_FREE_SNAPSHOTS) {
+            free_snapshots.push_back(snapshot);
+        } else {
+            delete snapshot;
+        }
+    }
+    retired.resize(kept);
+}
+
+
+// ================= READERS =================
+
+SpatialReader::SpatialReader(SpatialIndex& index) : index(index) {
+    for (int reader = 0; reader < SpatialIndex::MAX_READERS; reader++) {
+        unsigned long long expected = FREE_SLOT;
+        if (index.reader_epochs[reader].compare_exchange_strong(expected, 0)) {
+            slot = reader;
+            return;
+        }
+    }
+    throw std::runtime_error("SpatialReader: all reader slots are in use");
+}
+
+
+SpatialReader::~SpatialReader() {
+    index.reader_epochs[slot].store(FREE_SLOT);
+}
+
+
+const SpatialSnapshot* SpatialReader::acquire() {
+    index.reader_epochs[slot].store(index.global_epoch.load());
+    return index.current.load();
+}
+
+
+void SpatialReader::release() {
+    index.reader_epochs[slot].store(0);
+}
@@ -0,0 +1,169 @@
+/*
+read-only spatial index of the flock for code outside the simulation (mouse picking, predator AI,
+analytics overlays, ...)
+- Simulation::publish_snapshot() (the app calls it once per frame while something reads them) publishes
+  a SpatialSnapshot: a copy of the live boids sorted into a flat uniform grid (counting sort, like
+  DenseGrid) with a version number. a published snapshot is never written again, so any number of
+  threads can run radius / k nearest / box queries on it at once
+- snapshots are swapped with epoch based reclamation. a SpatialReader pins the current epoch while it
+  holds a snapshot, publish() swaps the new snapshot in and retires the old one, and a retired snapshot
+  is only reused once every pinned reader started after it was retired. so publish() never waits for a
+  reader (a slow reader only keeps old snapshots alive for longer) and a reader never waits for the
+  simulation (acquire() is an atomic load, a store and another load)
+- reclaimed snapshots are recycled by the next publish(), so a steady state step allocates nothing
+- publish() must only be called from one thread at a time (the simulation's), readers can be on any thread
+*/
+
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "boid.hpp"
+#include "simulation_params.hpp"
+#include "simulation_state.hpp"
+using namespace std;
+
+
+struct SpatialHit {
+    int slot = 0;                           // index into state.boids at the step the snapshot was taken
+    BoidId id = INVALID_BOID_ID;            // pool handle (stays valid across steps), INVALID_BOID_ID if the pool isn't used
+    Boid boid;
+    float distance_sq = 0.0f;               // from the query point (minimum image when periodic), 0 for box queries
+};
+
+
+// one non-empty grid cell of a snapshot (query_cells)
+struct SpatialCell {
+    float min_x = 0.0f, min_y = 0.0f;       // world rectangle of the cell (periodic: not wrapped, follows the box)
+    float max_x = 0.0f, max_y = 0.0f;
+    int count = 0;                          // live boids in the cell
+};
+
+
+class SpatialSnapshot {
+    public:
+        // step the snapshot was taken at (counts publishes, starts at 1)
+        unsigned long long get_version() const { return version; }
+        int size() const { return static_cast<int>(boids.size()); }
+        float get_world_width() const { return world_width; }
+        float get_world_height() const { return world_height; }
+        // smaller of the cell width / height
+        float get_cell_size() const { return min_cell_size; }
+
+        // every query clears `out` first, reuse the same vector between queries to avoid allocating
+        // boids within radius of (x, y)
+        void query_radius(float x, float y, float radius, std::vector<SpatialHit>& out) const;
+        // the k boids closest to (x, y), closest first (fewer if there aren't k boids within max_radius)
+        void query_nearest(float x, float y, int k, std::vector<SpatialHit>& out,
+                           float max_radius = std::numeric_limits<float>::infinity()) const;
+        // boids inside the box (on a periodic world the parts of the box past the edge wrap around)
+        void query_box(float min_x, float min_y, float max_x, float max_y, std::vector<SpatialHit>& out) const;
+        // non-empty cells touching the box with their boid counts (no boid is looked at, so this only costs
+        // as much as the box has cells, e.g. for density maps of a big world)
+        void query_cells(float min_x, float min_y, float max_x, float max_y, std::vector<SpatialCell>& out) const;
+
+    private:
+        friend class SpatialIndex;
+
+        unsigned long long version = 0;
+        unsigned long long retired_epoch = 0;   // epoch it was retired at (SpatialIndex only)
+
+        bool periodic = false;
+        float world_width = 0.0f, world_height = 0.0f;
+        int columns = 1, rows = 1;
+        float inv_cell_width = 1.0f, inv_cell_height = 1.0f;
+        float min_cell_size = 1.0f;             // smaller of the cell width / height
+
+        std::vector<int> cell_start;            // boids of cell c are [cell_start[c] .. cell_start[c + 1])
+        std::vector<Boid> boids;                // live boids in cell order
+        std::vector<int> slots;
+        std::vector<BoidId> ids;
+        std::vector<int> boid_cells;            // build scratch (cell of every slot, -1 = dead)
+
+        void build(const SimulationState& state, const SimulationParams& params, unsigned long long snapshot_version);
+
+        int cell_column(float x) const {
+            int gx = static_cast<int>(std::floor(x * inv_cell_width));
+            return std::max(0, std::min(gx, columns - 1));
+        }
+        int cell_row(float y) const {
+            int gy = static_cast<int>(std::floor(y * inv_cell_height));
+            return std::max(0, std::min(gy, rows - 1));
+        }
+        int wrap_column(int gx) const { return ((gx % columns) + columns) % columns; }
+        int wrap_row(int gy) const { return ((gy % rows) + rows) % rows; }
+
+        float distance_sq_to(int entry, float x, float y) const;
+        SpatialHit hit(int entry, float distance_sq) const {
+            SpatialHit result;
+            result.slot = slots[entry];
+            result.id = ids[entry];
+            result.boid = boids[entry];
+            result.distance_sq = distance_sq;
+            return result;
+        }
+};
+
+
+class SpatialIndex {
+    public:
+        static const int MAX_READERS = 64;      // SpatialReaders that can exist at the same time
+        static const int MAX_FREE_SNAPSHOTS = 4;
+
+        SpatialIndex();
+        // no SpatialReader may outlive the index
+        ~SpatialIndex();
+        SpatialIndex(const SpatialIndex&) = delete;
+        SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+        // builds a snapshot of the live boids and makes it the current one
+        void publish(const SimulationState& state, const SimulationParams& params);
+
+        unsigned long long get_version() const { return published_version; }
+        // snapshots retired but still pinned by a reader (grows while a reader holds on to one)
+        int get_retired_count() const { return static_cast<int>(retired.size()); }
+
+    private:
+        friend class SpatialReader;
+
+        std::atomic<SpatialSnapshot*> current{nullptr};
+        std::atomic<unsigned long long> global_epoch{1};
+        // epoch each reader pinned at, 0 = slot is idle, -1 (max) = slot is free
+        std::atomic<unsigned long long> reader_epochs[MAX_READERS];
+
+        // only touched by publish()
+        unsigned long long published_version = 0;
+        std::vector<SpatialSnapshot*> retired;
+        std::vector<SpatialSnapshot*> free_snapshots;
+
+        void reclaim();
+};
+
+
+// one per reader thread. holds at most one snapshot at a time:
+//     SpatialReader reader(index);
+//     if (const SpatialSnapshot* snapshot = reader.acquire()) { ... queries ... }
+//     reader.release();
+// the snapshot stays valid until release(), the next acquire() or the reader is destroyed. release as
+// soon as the queries are done: every snapshot published while one is held stays in memory
+class SpatialReader {
+    public:
+        static const unsigned long long FREE_SLOT = ~0ull;
+
+        // throws std::runtime_error if all MAX_READERS slots are taken
+        explicit SpatialReader(SpatialIndex& index);
+        ~SpatialReader();
+        SpatialReader(const SpatialReader&) = delete;
+        SpatialReader& operator=(const SpatialReader&) = delete;
+
+        // latest published snapshot (nullptr before the first publish)
+        const SpatialSnapshot* acquire();
+        void release();
+
+    private:
+        SpatialIndex& index;
+        int slot = -1;
+};
@@ -0,0 +1,407 @@
+#include "stats_reporter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+// (without NOMINMAX windows.h defines min / max macros that break std::min / std::max below)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+using namespace std;
+
+
+StatsReporter stats_reporter;
+
+
+// ================= CONSOLE VIEW =================
+// (runs on the reporter thread, only ever sees snapshots)
+static void print_simulation_controls_and_state(const SimulationConfig& config, const SimulationStats& stats, const FrameSummary& summary) {
+    // // clear console (works on Windows)
+    system("cls");
+    // std::cout << "\033[H\033[J";   // Move cursor home + clear screen (fast, no flicker)
+
+    std::cout << "============================================================= \n";
+    std::cout << "                    Boid Simulation Controls                  \n";
+    std::cout << "============================================================= \n";
+    std::cout << " Play/Pause                                                   \n";
+    std::cout << "     [ P ]                                                    \n";
+    std::cout << " Show/Hide UI                                                 \n";
+    std::cout << "     [ Q ]                                                    \n";
+    std::cout << " Grid Toggle                                                  \n";
+    std::cout << "     [ W ]                                                    \n";
+    std::cout << " Toggle Neighbor Search Type (Naiive/Grid)                    \n";
+    std::cout << "     [ E ]                                                    \n";
+    std::cout << " Adaptive Search Selection (Naiive/Grid)                      \n";
+    std::cout << "     [ I ]                                                    \n";
+    std::cout << " Far-Field Cell Approximation (Grid only)                     \n";
+    std::cout << "     [ N ]                                                    \n";
+    std::cout << " Symmetric Pair Traversal (Grid only)                         \n";
+    std::cout << "     [ R ]                                                    \n";
+    std::cout << " Topological Neighbors (k nearest)  [Increase / Decrease k]    \n";
+    std::cout << "     [ T ]                               [ Y / U ]            \n";
+    std::cout << " Temporal Level of Detail                                     \n";
+    std::cout << "     [ L ]                                                    \n";
+    std::cout << " Obstacles / Attractors (click to add/remove: L rock, R attractor)\n";
+    std::cout << "     [ H ]                                                    \n";
+    std::cout << " Periodic Boundaries (neighbors across the window edges)      \n";
+    std::cout << "     [ TAB ]                                                  \n";
+    std::cout << " Hardware Counters (Linux only)                               \n";
+    std::cout << "     [ K ]                                                    \n";
+    std::cout << " Task Graph Executor (parallel steps, off = OpenMP regions)   \n";
+    std::cout << "     [ F2 ]                                                   \n";
+    std::cout << " Highlight Boids Around The Cursor (spatial index query)      \n";
+    std::cout << "     [ F3 ]                                                   \n";
+    std::cout << " Fixed Timestep (sub-steps + render interpolation)            \n";
+    std::cout << "     [ F4 ]                                                   \n";
+    std::cout << " Camera Pan / Zoom / Whole World (mouse wheel zooms at cursor)\n";
+    std::cout << "     [ ARROWS ]   [ PGUP / PGDN ]   [ HOME ]                  \n";
+    std::cout << " Reset Simulation                                             \n";
+    std::cout << "     [ SPACE ]                                                \n";
+    std::cout<< " Quit Simulation                                               \n";
+    std::cout << "     [ ESC ]                                                  \n";
+    std::cout << "=============== Modify Configuration Values===================\n";
+    std::cout << "                 [Increase / Decrease]                        \n";
+    std::cout << " Grid Cell Size                                               \n";
+    std::cout << "     [ J / M ]                                                \n";
+    std::cout << " Boids Speed                                                  \n";
+    std::cout << "     [ + / - ]                                                \n";
+    std::cout << " Boids Count                                                  \n";
+    std::cout << "     [ G / B ]                                                \n";
+    std::cout << " Perception Radius                                            \n";
+    std::cout << "     [ A / Z ]                                                \n";
+    // std::cout << "Behavior Weights:                                            \n";
+    std::cout << " Alignment   Cohesion   Separation                            \n";
+    std::cout << " [ S / X ]   [ D / C ]   [ F / V ]                            \n";
+    std::cout << "============================================================= \n";
+
+    if (config.TOPOLOGICAL_ENABLED){
+        std::cout << "   NEIGHBOR SEARCH TYPE: [TOPOLOGICAL k=" << config.TOPOLOGICAL_K << "]";
+    } else if (config.SIMULATION_TYPE_GRID){
+        std::cout << ("   NEIGHBOR SEARCH TYPE: [GRID]  ");
+    } else {
+        std::cout << ("   NEIGHBOR SEARCH TYPE: [NAIIVE]");
+    }
+
+    if (config.ADAPTIVE_SEARCH_ENABLED && !config.TOPOLOGICAL_ENABLED){
+        std::cout << "   [AUTO]";
+    }
+
+    if (config.FAR_FIELD_ENABLED && config.SIMULATION_TYPE_GRID && !config.TOPOLOGICAL_ENABLED){
+        std::cout << "   [FAR-FIELD, exact rings=" << config.FAR_FIELD_NEAR_CELLS << "]";
+    }
+
+    if (config.SYMMETRIC_PAIRS_ENABLED && config.SIMULATION_TYPE_GRID && !config.TOPOLOGICAL_ENABLED){
+        std::cout << "   [SYMMETRIC PAIRS]";
+    }
+
+    if (config.OBSTACLES_ENABLED){
+        std::cout << "   [OBSTACLES]";
+    }
+
+    if (config.PERIODIC_BOUNDARIES){
+        std::cout << "   [PERIODIC]";
+    }
+
+    if (config.PARALLELISM_ENABLED){
+        std::cout << (config.TASK_GRAPH_ENABLED ? "   PARALLELISM: [ENABLED] [TASK GRAPH]\n\n" : "   PARALLELISM: [ENABLED] [OPENMP]\n\n");
+    } else {
+        std::cout << ("   PARALLELISM: [DISABLED]\n\n");
+    }
+
+    if (config.PAUSED){
+        std::cout << ("   STATE: [PAUSED] ");
+    } else {
+        std::cout << ("   STATE: [RUNNING]");
+    }
+    
+    if (config.SHOW_STATS){
+        std::cout << ("   STATS: [VISIBLE]");
+    } else {
+        std::cout << ("   STATS: [HIDDEN] ");
+    }
+    if (config.SHOW_GRID){
+        std::cout << ("   GRID: [VISIBLE]\n");
+    } else {
+        std::cout << ("   GRID: [HIDDEN] \n");
+    }
+
+    std::cout << "=============================================================                  \n";
+    std::cout << "                    SIMULATION STATE                                           \n";
+    std::cout << "=============================================================                  \n";
+    // if (config.PARALLELISM_ENABLED){
+    std::cout << "Number of Threads........" << stats.num_threads << "   \n";
+    // }
+    std::cout << "Number of Boids........." << config.NUM_BOIDS << "                  \n";
+    std::cout << "Boid Speed.............." << config.SPEED << "x                     \n";
+    std::cout << "Perception Radius......." << config.PERCEPTION_RADIUS << "          \n\n";
+
+    std::cout << "Alignment Weight........" << config.ALIGNMENT_WEIGHT << "           \n";
+    std::cout << "Cohesion Weight........." << config.COHESION_WEIGHT << "            \n";
+    std::cout << "Separation Weight......." << config.SEPARATION_WEIGHT << "          \n\n";
+
+    std::cout << "Grid Cell Size.........." << config.GRID_CELL_SIZE << "             \n";
+    std::cout << "=============================================================                  \n";
+
+    std::cout << "                         STATS                                            \n";
+    std::cout << "=============================================================                  \n";
+    std::cout << "FPS....................." << stats.fps << "                    \n\n";
+
+    std::cout << "Last Frame Time........." << stats.frame_time_ms << " ms       \n";
+    std::cout << "Update Time............." << stats.update_time_ms << " ms   (" << stats.percent_update_time << "%)      \n";
+    std::cout << "Render Time............." << stats.render_time_ms << " ms   (" << stats.percent_render_time << "%)      \n\n";
+
+    std::cout << "Grid Map Build Time....." << stats.grid_map_hash_time_ms << " ms    \n";               // time taken to build the grid map (aka which boids are in which grid cell)
+    std::cout << "Get Neighbors Time......" << stats.get_neighbors_calc_time_ms << " ms    \n";
+    std::cout << "Snapshot Publish Time..." << stats.snapshot_publish_time_ms << " ms   (" << stats.snapshots_retired << " held by readers)     \n\n";          // time taken to get neighbors for all boids (whether checking ALL other boids or only those hashed into surrounding grid cells)
+    
+    // std::cout << "Total Neighbor Checks..." << stats.total_neighbor_checks << "  \n";                    // total number of neighbor checks this frame ??
+    std::cout << "Avg Checked Neighbors..." << stats.avg_checked_neighbors << "   \n";                   // average number of boids checked to find neighbors
+    std::cout << "Avg Neighbors/Boid......" << stats.avg_neighbors << "          \n";                    // average number of neighbors per boid (those within perception radius)
+    if (config.LOD_ENABLED) {
+        std::cout << "LOD Skipped Updates....." << stats.lod_skipped_fraction * 100.0f << "%  (every " 
+                  << config.LOD_INTERVAL << " frames)     \n";                                         // boids that only had their position integrated
+    }
+    if (config.get_world_width() != config.WINDOW_WIDTH || config.get_world_height() != config.WINDOW_HEIGHT || stats.camera_zoom != 1.0f) {
+        std::cout << "View Zoom / Drawn......." << stats.camera_zoom << "x / " << stats.rendered_boids << " boids   (" 
+                  << stats.splat_cells << " splat cells)      \n";                                      // only what is in view gets drawn
+    }
+    if (config.FIXED_TIMESTEP_ENABLED) {
+        std::cout << "Sub-steps / Step Size..." << stats.substeps << " x " << stats.step_size << "   (" 
+                  << stats.candidate_rebuilds << " candidate rebuilds)      \n";                        // physics steps this frame, and how many of them gathered new candidates
+    }
+    std::cout << "=============================================================             \n";
+
+    std::cout << "                 ROLLING (last " << summary.frames << " frames)                          \n";
+    std::cout << "=============================================================             \n";
+    std::cout << "Avg FPS................." << summary.mean_fps << "                    \n";
+    std::cout << "Avg Frame Time.........." << summary.mean_frame_ms << " ms       \n";
+    std::cout << "Avg Update / Render....." << summary.mean_update_ms << " ms / " << summary.mean_render_ms << " ms      \n";
+    std::cout << "Frame Time p50/p95/p99.." << summary.p50_frame_ms << " / " << summary.p95_frame_ms << " / " 
+              << summary.p99_frame_ms << " ms      \n";
+    std::cout << "Worst Frame Time........" << summary.max_frame_ms << " ms       \n";
+    std::cout << "=============================================================             \n";
+
+    if (config.PERF_COUNTERS_ENABLED) {
+        std::cout << "                    HARDWARE COUNTERS                                     \n";
+        std::cout << "=============================================================             \n";
+        if (!stats.perf_counters_available) {
+            std::cout << "   [UNAVAILABLE] (needs Linux + perf_event access)                      \n";
+        } else {
+            // per phase: instructions per cycle and misses per boid
+            float num_boids = std::max(1.0f, static_cast<float>(config.NUM_BOIDS));
+            const PerfSample* phases[3] = {&stats.build_perf, &stats.update_perf, &stats.render_perf};
+            const char* phase_names[3] = {"Build.........", "Search/Steer..", "Render........"};
+            std::cout << "                IPC    LLC/boid   L1D/boid   BrMiss/boid       \n";
+            for (int p = 0; p < 3; p++) {
+                std::cout << phase_names[p] << "  " << phases[p]->ipc()
+                          << "   " << phases[p]->llc_misses / num_boids
+                          << "   " << phases[p]->l1d_misses / num_boids
+                          << "   " << phases[p]->branch_misses / num_boids << "          \n";
+            }
+        }
+        std::cout << "=============================================================             \n";
+    }
+}
+
+
+
+// ================= LIFETIME =================
+StatsReporter::~StatsReporter() {
+    stop();
+}
+
+void StatsReporter::start(const std::string& path) {
+    if (running.load()) return;
+    metrics_path = path;
+    running.store(true);
+    worker = std::thread(&StatsReporter::run, this);
+}
+
+void StatsReporter::stop() {
+    running.store(false);
+    if (worker.joinable()) worker.join();
+}
+
+
+// ================= RENDER LOOP SIDE =================
+void StatsReporter::publish(const SimulationStats& stats, const SimulationConfig& config) {
+    buffers[write_index].stats = stats;
+    buffers[write_index].config = config;
+    // hand the filled buffer over and take whatever was in the middle slot as the next one to write
+    int previous = middle.exchange(write_index | FRESH, std::memory_order_acq_rel);
+    write_index = previous & ~FRESH;
+}
+
+void StatsReporter::push_frame(const FrameSample& sample) {
+    unsigned head = ring_head.load(std::memory_order_relaxed);
+    unsigned tail = ring_tail.load(std::memory_order_acquire);
+    if (head - tail >= static_cast<unsigned>(RING_SIZE)) {
+        // reporter is behind, losing a sample is better than stalling the frame
+        dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring[head & (RING_SIZE - 1)] = sample;
+    ring_head.store(head + 1, std::memory_order_release);
+}
+
+void StatsReporter::request_refresh() {
+    refresh_requested.store(true, std::memory_order_relaxed);
+}
+
+
+// ================= REPORTER SIDE =================
+bool StatsReporter::take_snapshot(Snapshot& out) {
+    if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+    int previous = middle.exchange(read_index, std::memory_order_acq_rel);
+    read_index = previous & ~FRESH;
+    out = buffers[read_index];
+    return true;
+}
+
+void StatsReporter::drain_frames(std::vector<FrameSample>& window, int& window_next) {
+    unsigned tail = ring_tail.load(std::memory_order_relaxed);
+    unsigned head = ring_head.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+        const FrameSample& sample = ring[tail & (RING_SIZE - 1)];
+        // window is a circular buffer once it is full
+        if (static_cast<int>(window.size()) < REPORT_WINDOW) {
+            window.push_back(sample);
+        } else {
+            window[window_next] = sample;
+            window_next = (window_next + 1) % REPORT_WINDOW;
+        }
+    }
+    ring_tail.store(tail, std::memory_order_release);
+}
+
+FrameSummary StatsReporter::summarize(const std::vector<FrameSample>& window) const {
+    FrameSummary summary;
+    summary.frames = static_cast<int>(window.size());
+    summary.dropped_frames = dropped_frames.load(std::memory_order_relaxed);
+    if (window.empty()) return summary;
+
+    std::vector<float> frame_times;
+    frame_times.reserve(window.size());
+    double frame_sum = 0.0, update_sum = 0.0, render_sum = 0.0;
+    for (const FrameSample& sample : window) {
+        frame_sum += sample.frame_ms;
+        update_sum += sample.update_ms;
+        render_sum += sample.render_ms;
+        frame_times.push_back(sample.frame_ms);
+    }
+    summary.mean_frame_ms = static_cast<float>(frame_sum / window.size());
+    summary.mean_update_ms = static_cast<float>(update_sum / window.size());
+    summary.mean_render_ms = static_cast<float>(render_sum / window.size());
+    summary.mean_fps = summary.mean_frame_ms > 0.0f ? 1000.0f / summary.mean_frame_ms : 0.0f;
+
+    // nearest rank percentiles
+    std::sort(frame_times.begin(), frame_times.end());
+    auto percentile = [&](float p) {
+        size_t rank = static_cast<size_t>(p * (frame_times.size() - 1) + 0.5f);
+        return frame_times[std::min(rank, frame_times.size() - 1)];
+    };
+    summary.p50_frame_ms = percentile(0.50f);
+    summary.p95_frame_ms = percentile(0.95f);
+    summary.p99_frame_ms = percentile(0.99f);
+    summary.max_frame_ms = frame_times.back();
+    return summary;
+}
+
+void StatsReporter::write_metrics(const Snapshot& snapshot, const FrameSummary& summary) const {
+    const SimulationConfig& config = snapshot.config;
+    const SimulationStats& stats = snapshot.stats;
+    std::string temp_path = metrics_path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "w");
+    if (!file) return;
+
+    const char* search = config.TOPOLOGICAL_ENABLED ? "topological" : (config.SIMULATION_TYPE_GRID ? "grid" : "naiive");
+    std::fprintf(file, "# HELP boids_frame_time_ms Frame time over the last %d frames.\n", REPORT_WINDOW);
+    std::fprintf(file, "# TYPE boids_frame_time_ms summary\n");
+    std::fprintf(file, "boids_frame_time_ms{quantile=\"0.5\"} %.4f\n", summary.p50_frame_ms);
+    std::fprintf(file, "boids_frame_time_ms{quantile=\"0.95\"} %.4f\n", summary.p95_frame_ms);
+    std::fprintf(file, "boids_frame_time_ms{quantile=\"0.99\"} %.4f\n", summary.p99_frame_ms);
+    std::fprintf(file, "boids_frame_time_ms_sum %.4f\n", summary.mean_frame_ms * summary.frames);
+    std::fprintf(file, "boids_frame_time_ms_count %d\n", summary.frames);
+
+    std::fprintf(file, "# TYPE boids_frame_time_ms_max gauge\nboids_frame_time_ms_max %.4f\n", summary.max_frame_ms);
+    std::fprintf(file, "# TYPE boids_update_time_ms_avg gauge\nboids_update_time_ms_avg %.4f\n", summary.mean_update_ms);
+    std::fprintf(file, "# TYPE boids_render_time_ms_avg gauge\nboids_render_time_ms_avg %.4f\n", summary.mean_render_ms);
+    std::fprintf(file, "# TYPE boids_fps_avg gauge\nboids_fps_avg %.2f\n", summary.mean_fps);
+    std::fprintf(file, "# TYPE boids_dropped_samples_total counter\nboids_dropped_samples_total %lld\n", summary.dropped_frames);
+
+    // last published frame
+    std::fprintf(file, "# TYPE boids_grid_build_time_ms gauge\nboids_grid_build_time_ms %.4f\n", stats.grid_map_hash_time_ms);
+    std::fprintf(file, "# TYPE boids_get_neighbors_time_ms gauge\nboids_get_neighbors_time_ms %.4f\n", stats.get_neighbors_calc_time_ms);
+    std::fprintf(file, "# TYPE boids_snapshot_publish_time_ms gauge\nboids_snapshot_publish_time_ms %.4f\n", stats.snapshot_publish_time_ms);
+    std::fprintf(file, "# TYPE boids_snapshots_retired gauge\nboids_snapshots_retired %d\n", stats.snapshots_retired);
+    std::fprintf(file, "# TYPE boids_avg_neighbors gauge\nboids_avg_neighbors %.3f\n", stats.avg_neighbors);
+    std::fprintf(file, "# TYPE boids_avg_checked_neighbors gauge\nboids_avg_checked_neighbors %.3f\n", stats.avg_checked_neighbors);
+    std::fprintf(file, "# TYPE boids_lod_skipped_fraction gauge\nboids_lod_skipped_fraction %.4f\n", stats.lod_skipped_fraction);
+    std::fprintf(file, "# TYPE boids_threads gauge\nboids_threads %d\n", stats.num_threads);
+    std::fprintf(file, "# TYPE boids_rendered gauge\nboids_rendered %d\n", stats.rendered_boids);
+    std::fprintf(file, "# TYPE boids_splat_cells gauge\nboids_splat_cells %d\n", stats.splat_cells);
+
+    // config
+    std::fprintf(file, "# TYPE boids_count gauge\nboids_count %d\n", config.NUM_BOIDS);
+    std::fprintf(file, "# TYPE boids_perception_radius gauge\nboids_perception_radius %.3f\n", config.PERCEPTION_RADIUS);
+    std::fprintf(file, "# TYPE boids_grid_cell_size gauge\nboids_grid_cell_size %.3f\n", config.GRID_CELL_SIZE);
+    std::fprintf(file, "# TYPE boids_info gauge\nboids_info{search=\"%s\",parallel=\"%d\",paused=\"%d\"} 1\n",
+                 search, config.PARALLELISM_ENABLED ? 1 : 0, config.PAUSED ? 1 : 0);
+    std::fclose(file);
+
+    // swap the finished file in
+#ifdef _WIN32
+    MoveFileExA(temp_path.c_str(), metrics_path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    std::rename(temp_path.c_str(), metrics_path.c_str());
+#endif
+}
+
+
+void StatsReporter::run() {
+    using clock = std::chrono::steady_clock;
+    const auto poll_interval = std::chrono::milliseconds(50);
+    const auto print_interval = std::chrono::seconds(2);
+    const auto metrics_interval = std::chrono::seconds(1);
+
+    std::vector<FrameSample> window;
+    window.reserve(REPORT_WINDOW);
+    int window_next = 0;
+
+    Snapshot latest;
+    bool have_snapshot = false;
+    SimulationConfig last_printed_config;
+    auto last_print = clock::now();
+    auto last_metrics = clock::now();
+
+    while (running.load()) {
+        drain_frames(window, window_next);
+        have_snapshot |= take_snapshot(latest);
+
+        if (have_snapshot) {
+            auto now = clock::now();
+            bool refresh = refresh_requested.exchange(false, std::memory_order_relaxed);
+            bool metrics_due = !metrics_path.empty() && (now - last_metrics >= metrics_interval);
+            bool print_due = refresh || !(latest.config == last_printed_config) || (now - last_print >= print_interval);
+
+            if (print_due || metrics_due) {
+                FrameSummary summary = summarize(window);
+                if (print_due) {
+                    print_simulation_controls_and_state(latest.config, latest.stats, summary);
+                    last_printed_config = latest.config;
+                    last_print = now;
+                }
+                if (metrics_due) {
+                    write_metrics(latest, summary);
+                    last_metrics = now;
+                }
+            }
+        }
+        std::this_thread::sleep_for(poll_interval);
+    }
+}
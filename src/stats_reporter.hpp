@@ -0,0 +1,97 @@
+/*
+stats reporter running on its own thread
+- the render loop only hands over snapshots: publish() copies SimulationStats + SimulationConfig into a
+  triple buffer (one atomic exchange, never blocks), push_frame() appends the frame/update/render times
+  to a lock-free single producer / single consumer ring (frames are dropped if the ring is full)
+- the reporter thread drains the ring into a rolling window, reprints the console view (on a config
+  change, every 2 seconds, or when asked to) and rewrites the metrics file about once a second
+- the metrics file uses the Prometheus text format and is replaced atomically (written to <path>.tmp
+  first, then renamed over the old file) so readers never see half a file
+- publish(), push_frame() and request_refresh() must only be called from one thread (the render loop)
+*/
+
+
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation_config.hpp"
+#include "simulation_stats.hpp"
+
+
+struct FrameSample {
+    float frame_ms = 0.0f;
+    float update_ms = 0.0f;
+    float render_ms = 0.0f;
+};
+
+// rolling values over the last REPORT_WINDOW frames
+struct FrameSummary {
+    int frames = 0;                     // frames in the window
+    long long dropped_frames = 0;       // samples lost because the ring was full (since start)
+    float mean_frame_ms = 0.0f;
+    float mean_update_ms = 0.0f;
+    float mean_render_ms = 0.0f;
+    float mean_fps = 0.0f;
+    float p50_frame_ms = 0.0f;
+    float p95_frame_ms = 0.0f;
+    float p99_frame_ms = 0.0f;
+    float max_frame_ms = 0.0f;
+};
+
+
+class StatsReporter {
+public:
+    static const int RING_SIZE = 4096;          // power of two
+    static const int REPORT_WINDOW = 600;       // frames in the rolling window (~10 s at 60 fps)
+
+    ~StatsReporter();
+
+    // starts the reporter thread, an empty metrics_path disables the metrics file
+    void start(const std::string& metrics_path);
+    // stops and joins the reporter thread (safe to call more than once)
+    void stop();
+
+    // ================= RENDER LOOP SIDE =================
+    void publish(const SimulationStats& stats, const SimulationConfig& config);
+    void push_frame(const FrameSample& sample);
+    // reprint the console view on the next poll even if nothing changed (e.g. after a reset)
+    void request_refresh();
+
+private:
+    struct Snapshot {
+        SimulationStats stats;
+        SimulationConfig config;
+    };
+
+    // ================= TRIPLE BUFFER =================
+    // the producer writes into buffers[write_index] and swaps it with the middle slot, the consumer swaps
+    // the middle slot with buffers[read_index] when FRESH is set, so neither side ever waits for the other
+    static const int FRESH = 4;
+    Snapshot buffers[3];
+    int write_index = 0;                        // only touched by the producer
+    int read_index = 1;                         // only touched by the consumer
+    std::atomic<int> middle{2};                 // index of the middle buffer | FRESH
+
+    // ================= FRAME RING =================
+    FrameSample ring[RING_SIZE];
+    std::atomic<unsigned> ring_head{0};         // next slot to write (producer)
+    std::atomic<unsigned> ring_tail{0};         // next slot to read (consumer)
+    std::atomic<long long> dropped_frames{0};
+
+    std::atomic<bool> refresh_requested{true};  // the first snapshot is always printed
+    std::atomic<bool> running{false};
+    std::thread worker;
+    std::string metrics_path;
+
+    void run();
+    bool take_snapshot(Snapshot& out);
+    void drain_frames(std::vector<FrameSample>& window, int& window_next);
+    FrameSummary summarize(const std::vector<FrameSample>& window) const;
+    void write_metrics(const Snapshot& snapshot, const FrameSummary& summary) const;
+};
+
+
+// one reporter for the whole program
+extern StatsReporter stats_reporter;
@@ -0,0 +1,144 @@
+#include "task_graph.hpp"
+
+#include <algorithm>
+using namespace std;
+
+
+// ================= GRAPH =================
+
+int TaskGraph::add_task(TaskFunction function) {
+    Task task;
+    task.function = std::move(function);
+    tasks.push_back(std::move(task));
+    return static_cast<int>(tasks.size()) - 1;
+}
+
+
+void TaskGraph::add_dependency(int task, int dependency) {
+    tasks[dependency].successors.push_back(task);
+    tasks[task].dependencies++;
+}
+
+
+void TaskGraph::clear() {
+    tasks.clear();
+}
+
+
+// ================= EXECUTOR =================
+
+TaskExecutor::TaskExecutor(int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int worker = 1; worker < threads; worker++) {
+        workers.emplace_back(&TaskExecutor::worker_loop, this, worker);
+    }
+}
+
+
+TaskExecutor::~TaskExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+
+void TaskExecutor::run(TaskGraph& graph_to_run) {
+    int n = graph_to_run.size();
+    if (n == 0) return;
+    if (graph_to_run.pending_size < n) {
+        graph_to_run.pending.reset(new std::atomic<int>[n]);
+        graph_to_run.pending_size = n;
+    }
+
+    bool wake_workers = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        graph = &graph_to_run;
+        remaining.store(n);
+        for (int task = 0; task < n; task++) {
+            graph_to_run.pending[task].store(graph_to_run.tasks[task].dependencies, std::memory_order_relaxed);
+            if (graph_to_run.tasks[task].dependencies == 0) ready.push_back(task);
+        }
+        ready_count.store(static_cast<int>(ready.size()));
+        wake_workers = sleeping > 0;
+    }
+    if (wake_workers) wake.notify_all();
+
+    // help out until everything is done
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        int task;
+        if (try_pop(task)) {
+            execute(task, 0);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return remaining.load() == 0 || !ready.empty(); });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    graph = nullptr;
+}
+
+
+void TaskExecutor::worker_loop(int worker) {
+    while (true) {
+        // spin a little first, the next task (or the next frame's graph) is usually close
+        int task;
+        bool found = false;
+        for (int round = 0; round < SPIN_ROUNDS && !found; round++) {
+            if (ready_count.load(std::memory_order_relaxed) > 0) found = try_pop(task);
+        }
+
+        if (!found) {
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping++;
+            wake.wait(lock, [&] { return stopping || !ready.empty(); });
+            sleeping--;
+            if (stopping) return;
+            task = ready.back();
+            ready.pop_back();
+            ready_count.store(static_cast<int>(ready.size()), std::memory_order_relaxed);
+        }
+        execute(task, worker);
+    }
+}
+
+
+bool TaskExecutor::try_pop(int& task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ready.empty()) return false;
+    task = ready.back();
+    ready.pop_back();
+    ready_count.store(static_cast<int>(ready.size()), std::memory_order_relaxed);
+    return true;
+}
+
+
+void TaskExecutor::execute(int task, int worker) {
+    TaskGraph& current = *graph;
+    current.tasks[task].function(worker);
+
+    // release the tasks that were only waiting on this one
+    int released = 0;
+    for (int successor : current.tasks[task].successors) {
+        if (current.pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(successor);
+            ready_count.store(static_cast<int>(ready.size()), std::memory_order_relaxed);
+            released++;
+        }
+    }
+
+    bool finished = remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    if (released > 0 || finished) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (released > 0 && sleeping > 0) {
+            if (released == 1) wake.notify_one();
+            else wake.notify_all();
+        }
+        done.notify_one();
+    }
+}
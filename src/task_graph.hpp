@@ -0,0 +1,82 @@
+/*
+persistent worker pool running a fixed graph of tasks
+- TaskGraph: tasks plus "runs after" edges. it is built once and reused every frame (only the
+  per-task counters are reset), so a frame doesn't allocate anything or build anything new
+- TaskExecutor: threads - 1 workers created once (the thread calling run() is the last one). run()
+  starts every task without dependencies, and each finished task releases the ones waiting on it, so
+  a task starts as soon as its own inputs are done instead of waiting for a whole phase
+- between graphs the workers spin for a short while and then sleep, so back to back runs don't pay
+  for a wake up at all and an idle pool doesn't burn a core
+- a task must not call run() itself, and tasks that run at the same time must not write the same data
+  (the graph is what orders them)
+*/
+
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+
+class TaskGraph {
+    public:
+        // worker = 0 .. threads - 1 (0 is the thread that called run()), for per-thread scratch data
+        typedef std::function<void(int worker)> TaskFunction;
+
+        int add_task(TaskFunction function);
+        // `task` only starts once `dependency` finished
+        void add_dependency(int task, int dependency);
+        void clear();
+
+        int size() const { return static_cast<int>(tasks.size()); }
+
+    private:
+        friend class TaskExecutor;
+
+        struct Task {
+            TaskFunction function;
+            std::vector<int> successors;
+            int dependencies = 0;
+        };
+        std::vector<Task> tasks;
+        std::unique_ptr<std::atomic<int>[]> pending;    // dependencies left in the current run
+        int pending_size = 0;
+};
+
+
+class TaskExecutor {
+    public:
+        static const int SPIN_ROUNDS = 20000;       // empty polls before an idle worker goes to sleep
+
+        // threads <= 0 = one per core
+        explicit TaskExecutor(int threads = 0);
+        ~TaskExecutor();
+
+        // runs every task of the graph once and returns when all of them are done
+        // (the calling thread works on the graph too)
+        void run(TaskGraph& graph);
+
+        int get_num_threads() const { return static_cast<int>(workers.size()) + 1; }
+
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake;               // workers: tasks became ready (or shutting down)
+        std::condition_variable done;               // run(): tasks became ready or the graph finished
+        std::vector<int> ready;                     // tasks whose dependencies are all done (guarded by mutex)
+        std::atomic<int> ready_count{0};            // ready.size(), for spinning without the lock
+        std::atomic<int> remaining{0};              // tasks of the current graph that haven't finished
+        TaskGraph* graph = nullptr;
+        int sleeping = 0;                           // workers blocked on wake (guarded by mutex)
+        bool stopping = false;
+
+        void worker_loop(int worker);
+        bool try_pop(int& task);
+        void execute(int task, int worker);
+};
@@ -0,0 +1,119 @@
+#include <omp.h>
+#include "time_stepper.hpp"
+#include "flock_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+
+float TimeStepper::max_live_speed(const SimulationState& state, bool parallel) const {
+    const std::vector<Boid>& boids = state.boids;
+    const unsigned char* alive = state.has_dead_slots() ? state.alive.data() : nullptr;
+    const int n = static_cast<int>(boids.size());
+    float max_speed_sq = 0.0f;
+    #pragma omp parallel for reduction(max:max_speed_sq) if(parallel)
+    for (int i = 0; i < n; i++) {
+        if (alive && !alive[i]) continue;
+        max_speed_sq = std::max(max_speed_sq, boids[i].vx * boids[i].vx + boids[i].vy * boids[i].vy);
+    }
+    return std::sqrt(max_speed_sq);
+}
+
+
+int TimeStepper::advance(Simulation& sim, SimulationState& state, float frame_dt, const SimulationParams& params, SimulationStats& stats) {
+    stats.substeps = 0;
+    stats.candidate_rebuilds = 0;
+    if (params.fixed_step <= 0.0f) {
+        // (SPEED 0, nothing moves)
+        accumulator = 0.0f;
+        alpha = 0.0f;
+        return 0;
+    }
+
+    // ================= STEP SIZE =================
+    // fixed, unless the fastest boid would cover more than the distance limit in one step
+    step_size = params.fixed_step;
+    float speed = max_live_speed(state, params.parallelism_enabled);
+    if (speed > 0.0f && params.step_distance_limit > 0.0f) {
+        step_size = std::min(step_size, params.step_distance_limit / speed);
+    }
+    stats.step_size = step_size;
+
+    accumulator += std::max(0.0f, frame_dt);
+    int steps = static_cast<int>(accumulator / step_size);
+    if (steps > params.max_substeps) {
+        steps = params.max_substeps;
+        accumulator = steps * step_size;
+    }
+
+    SimulationParams step_params = params;
+    step_params.steer_scale = step_size / params.fixed_step;
+
+    // ================= CANDIDATE CACHE =================
+    // (the simulation's own search is put back after the steps, input handling can swap it any time)
+    NeighborSearch* search = sim.get_neighbor_search();
+    bool use_cache = params.candidate_cache_enabled && search && search->is_radius_search() &&
+                     !params.far_field_enabled && !params.symmetric_pairs_enabled;
+    if (use_cache) {
+        candidate_cache.set_source(search);
+        sim.change_neighbor_search_type(&candidate_cache);
+    }
+
+    for (int step = 0; step < steps; step++) {
+        // compact here instead of inside update, so the slots of previous_boids / the cache still match
+        if (state.needs_compaction()) {
+            state.compact(params.parallelism_enabled);
+            candidate_cache.invalidate();
+        }
+        if (step == steps - 1) previous_boids = state.boids;
+        sim.update(state, step_size, step_params, stats);
+        if (use_cache && !candidate_cache.last_build_reused()) stats.candidate_rebuilds++;
+        accumulator -= step_size;
+    }
+
+    if (use_cache) sim.change_neighbor_search_type(search);
+    accumulator = std::max(0.0f, accumulator);
+    alpha = std::min(1.0f, accumulator / step_size);
+    stats.substeps = steps;
+    return steps;
+}
+
+
+const std::vector<Boid>& TimeStepper::interpolated(const SimulationState& state, const SimulationParams& params) {
+    const std::vector<Boid>& boids = state.boids;
+    if (previous_boids.size() != boids.size()) return boids;
+
+    // a slot that moved further than a step can go was reused by a new boid, it is drawn where it is now
+    const float max_jump = params.max_speed * step_size * 2.0f;
+    const float max_jump_sq = max_jump * max_jump;
+    const int n = static_cast<int>(boids.size());
+    render_boids.resize(n);
+    #pragma omp parallel for if(params.parallelism_enabled)
+    for (int i = 0; i < n; i++) {
+        const Boid& from = previous_boids[i];
+        const Boid& to = boids[i];
+        // (across the wrap the short way round, boids always wrap around the edges)
+        float dx = minimum_image(to.x - from.x, params.world_width);
+        float dy = minimum_image(to.y - from.y, params.world_height);
+        if (dx*dx + dy*dy > max_jump_sq) {
+            render_boids[i] = to;
+            continue;
+        }
+        Boid& boid = render_boids[i];
+        boid.x = from.x + dx * alpha;
+        boid.y = from.y + dy * alpha;
+        boid.vx = from.vx + (to.vx - from.vx) * alpha;
+        boid.vy = from.vy + (to.vy - from.vy) * alpha;
+        wrap_position<2>(boid, params);
+    }
+    return render_boids;
+}
+
+
+void TimeStepper::reset() {
+    accumulator = 0.0f;
+    alpha = 0.0f;
+    previous_boids.clear();
+    candidate_cache.invalidate();
+}
@@ -0,0 +1,52 @@
+/*
+fixed timestep driver (sub-stepping)
+- the frame's dt goes into an accumulator and the simulation runs whole physics steps out of it, so a
+  slow frame means more steps instead of one long step where boids jump past each other
+- the step size is params.fixed_step, shortened while the fastest boid would move more than
+  params.step_distance_limit in one step. steering is scaled by the same factor (steer_scale), so a
+  shortened step changes velocities by proportionally less and the flock behaves the same per unit of
+  simulation time
+- at most params.max_substeps steps per frame, time beyond that is dropped (the simulation runs slower
+  than real time instead of falling further and further behind)
+- rendering uses interpolated(): positions between the last two steps, by how far the leftover time
+  has got into the next step
+- with params.candidate_cache_enabled (and a radius based search, no far-field / symmetric pass) the
+  steps run on a CachedNeighborSearch around the simulation's search, so consecutive steps reuse the
+  neighbor candidates instead of rebuilding and querying every step
+*/
+
+
+#pragma once
+#include <vector>
+#include "boid.hpp"
+#include "cached_neighbor_search.hpp"
+#include "simulation.hpp"
+#include "simulation_params.hpp"
+#include "simulation_state.hpp"
+#include "simulation_stats.hpp"
+using namespace std;
+
+
+class TimeStepper {
+    public:
+        // runs the steps frame_dt (simulation time, seconds * SPEED) covers, returns how many ran.
+        // stats holds the last step's numbers plus substeps / step_size / candidate_rebuilds for the frame
+        int advance(Simulation& sim, SimulationState& state, float frame_dt, const SimulationParams& params, SimulationStats& stats);
+        // boids between the last two steps (same slots as state.boids)
+        const std::vector<Boid>& interpolated(const SimulationState& state, const SimulationParams& params);
+        // forget the leftover time and the previous step (after a reset)
+        void reset();
+
+        float get_step_size() const { return step_size; }
+        float get_alpha() const { return alpha; }
+
+    private:
+        CachedNeighborSearch candidate_cache;
+        float accumulator = 0.0f;
+        float step_size = 0.0f;
+        float alpha = 0.0f;                         // leftover time / step size
+        std::vector<Boid> previous_boids;           // state before the last step
+        std::vector<Boid> render_boids;
+
+        float max_live_speed(const SimulationState& state, bool parallel) const;
+};
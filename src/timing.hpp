@@ -0,0 +1,16 @@
+/*
+wall-clock timing for the simulation core
+- a steady clock instead of SDL's performance counter, so the core library, the C API and the headless
+  tools don't need SDL just to time their phases
+*/
+
+
+#pragma once
+#include <chrono>
+
+
+// steady clock time in milliseconds (only the difference of two calls means anything)
+inline double steady_now_ms() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,101 @@
+#include "topological_neighbor_search.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+    struct HeapEntry {
+        float distance_sq;
+        int index;
+    };
+
+    // max-heap on distance, the root is the furthest of the current k nearest
+    bool heap_less(const HeapEntry& a, const HeapEntry& b) {
+        return a.distance_sq < b.distance_sq;
+    }
+}
+
+
+std::tuple<std::vector<int>, long long> TopologicalNeighborSearch::get_neighbors(const std::vector<Boid>& boids, int index, SimulationParams params) {
+    const Boid& boid = boids[index];
+    const int k = std::max(1, std::min(params.topological_k, MAX_K));
+
+    int target_grid_cell_xpos = cell_column(boid.x);
+    int target_grid_cell_ypos = cell_row(boid.y);
+
+    // k nearest so far (fixed size, lives on the stack)
+    HeapEntry heap[MAX_K];
+    int heap_size = 0;
+    long long checked_candidates = 0;
+
+    // rings needed to cover the max range (ring r = cells with chebyshev distance r from the boid's cell)
+    int max_ring = static_cast<int>(std::ceil(params.topological_max_range * std::max(inv_cell_width, inv_cell_height)));
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+        // ================= VISIT ONE RING OF CELLS =================
+        for (int other_grid_cell_Xoffset = -ring; other_grid_cell_Xoffset <= ring; other_grid_cell_Xoffset++) {
+            // inner columns only need the top and bottom cell, the outer columns need all of them
+            bool full_column = (other_grid_cell_Xoffset == -ring || other_grid_cell_Xoffset == ring);
+            int y_step = full_column ? 1 : std::max(1, 2 * ring);
+
+            for (int other_grid_cell_Yoffset = -ring; other_grid_cell_Yoffset <= ring; other_grid_cell_Yoffset += y_step) {
+                // (wrapped to the other side, plus the offset to its ghost image, when periodic)
+                CellImage image = image_of_cell(target_grid_cell_xpos + other_grid_cell_Xoffset,
+                                                target_grid_cell_ypos + other_grid_cell_Yoffset);
+                const std::vector<int>* cell = find_cell(image.hash);
+                if (!cell) {
+                    continue; // no boids in this cell
+                }
+                const float query_x = boid.x - image.shift_x;
+                const float query_y = boid.y - image.shift_y;
+
+                for (int boid_index_in_cell : *cell) {
+                    if (boid_index_in_cell == index) continue; // skip self
+                    checked_candidates++;
+
+                    const Boid& other_boid = boids[boid_index_in_cell];
+                    float dx = other_boid.x - query_x;
+                    float dy = other_boid.y - query_y;
+                    float distance_sq = dx*dx + dy*dy;
+                    if (distance_sq > params.topological_max_range_sq) continue;
+
+                    if (heap_size < k) {
+                        heap[heap_size++] = {distance_sq, boid_index_in_cell};
+                        std::push_heap(heap, heap + heap_size, heap_less);
+                    } else if (distance_sq < heap[0].distance_sq) {
+                        // replace the furthest of the current k nearest
+                        std::pop_heap(heap, heap + heap_size, heap_less);
+                        heap[heap_size - 1] = {distance_sq, boid_index_in_cell};
+                        std::push_heap(heap, heap + heap_size, heap_less);
+                    }
+                }
+            }
+        }
+
+        // ================= CAN WE STOP? =================
+        // everything not visited yet is at least this far away (distance to the edge of the visited block)
+        if (heap_size == k) {
+            float left = boid.x - (target_grid_cell_xpos - ring) * cell_width;
+            float right = (target_grid_cell_xpos + ring + 1) * cell_width - boid.x;
+            float top = boid.y - (target_grid_cell_ypos - ring) * cell_height;
+            float bottom = (target_grid_cell_ypos + ring + 1) * cell_height - boid.y;
+            float unvisited_distance = std::min(std::min(left, right), std::min(top, bottom));
+            if (heap[0].distance_sq <= unvisited_distance * unvisited_distance) {
+                break;
+            }
+        }
+    }
+
+    std::vector<int> neighbors;
+    neighbors.reserve(heap_size);
+    for (int i = 0; i < heap_size; i++) {
+        neighbors.push_back(heap[i].index);
+    }
+    return {neighbors, checked_candidates};
+}
+
+
+int TopologicalNeighborSearch::block_reach(SimulationParams params) const {
+    int max_ring = static_cast<int>(std::ceil(params.topological_max_range * std::max(inv_cell_width, inv_cell_height)));
+    return (std::max(1, max_ring) + rows_per_band - 1) / rows_per_band;
+}
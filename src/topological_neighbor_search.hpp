@@ -0,0 +1,40 @@
+/*
+Topological Neighbor Search 
+- every boid reacts to (at most) its k nearest neighbors instead of to everyone inside the perception 
+  radius (like the starling models, k is usually 6-7)
+- uses the same grid as GridNeighborSearch, candidates are gathered ring by ring around the boid's 
+  cell until the k-th nearest distance is closer than anything an unvisited ring could contain
+- the k nearest are kept in a fixed-size max-heap on the stack (no allocation while searching)
+- per boid cost no longer grows with the number of neighbors inside the perception radius
+*/
+
+
+#pragma once
+#include "grid_neighbor_search.hpp"
+using namespace std;
+
+
+class TopologicalNeighborSearch : public GridNeighborSearch {
+    public:
+        // upper bound for k (size of the on-stack heap)
+        static const int MAX_K = 16;
+
+        // build() is inherited from GridNeighborSearch
+        std::tuple<std::vector<int>, long long> get_neighbors(const std::vector<Boid>& boids, int index, SimulationParams params) override;
+
+        // the far-field approximation is a metric (radius) model, so it doesn't apply here
+        bool accumulate_neighbor_sums(const std::vector<Boid>& boids, int index, SimulationParams params, NeighborSums& sums) override {
+            return false;
+        }
+        // k nearest, the perception radius doesn't decide who is a neighbor
+        bool is_radius_search() const override {
+            return false;
+        }
+        // the rings reach out to the max range, not just the 3x3 stencil
+        int block_reach(SimulationParams params) const override;
+
+        // k nearest isn't symmetric (j can be one of i's k nearest without i being one of j's)
+        bool accumulate_all_neighbor_sums(const std::vector<Boid>& boids, SimulationParams params, std::vector<NeighborSums>& sums) override {
+            return false;
+        }
+};